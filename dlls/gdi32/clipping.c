@@ -96,8 +96,9 @@ BOOL clip_visrect( DC *dc, RECT *dst, const RECT *src )
 void update_dc_clipping( DC * dc )
 {
     PHYSDEV physdev = GET_DC_PHYSDEV( dc, pSetDeviceClipping );
-    HRGN regions[3];
-    int count = 0;
+    HRGN regions[3] = { 0 };
+    DWORD serials[3] = { 0 };
+    int i, count = 0;
 
     if (dc->hVisRgn)  regions[count++] = dc->hVisRgn;
     if (dc->hClipRgn) regions[count++] = dc->hClipRgn;
@@ -105,15 +106,28 @@ void update_dc_clipping( DC * dc )
 
     if (count > 1)
     {
+        for (i = 0; i < count; i++) serials[i] = get_region_serial( regions[i] );
+
+        /* nothing to do if none of the regions changed since the last time */
+        if (dc->region && dc->region_serial[3] == get_region_serial( dc->region ) &&
+            !memcmp( dc->region_src, regions, sizeof(regions) ) &&
+            !memcmp( dc->region_serial, serials, sizeof(serials) ))
+            goto done;
+
         if (!dc->region) dc->region = CreateRectRgn( 0, 0, 0, 0 );
         CombineRgn( dc->region, regions[0], regions[1], RGN_AND );
         if (count > 2) CombineRgn( dc->region, dc->region, regions[2], RGN_AND );
+
+        memcpy( dc->region_src, regions, sizeof(regions) );
+        memcpy( dc->region_serial, serials, sizeof(serials) );
+        dc->region_serial[3] = get_region_serial( dc->region );
     }
     else  /* only one region, we don't need the total region */
     {
         if (dc->region) DeleteObject( dc->region );
         dc->region = 0;
     }
+done:
     physdev->funcs->pSetDeviceClipping( physdev, get_dc_region( dc ));
 }
 
@@ -552,19 +552,158 @@ static void copy_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src,
     }
 }
 
+/* Large operations are split into horizontal bands that are rendered in parallel.
+ * Each band writes a disjoint set of destination rows, and computes them exactly
+ * as the single-threaded code would, so the result doesn't depend on scheduling. */
+
+#define BAND_MIN_PIXELS  (256 * 1024)  /* don't bother with threads below this size */
+#define BAND_MIN_ROWS    16
+#define MAX_BANDS        16
+
+struct band_job;
+
+struct band
+{
+    struct band_job *job;
+    int              start;
+    int              end;
+    LONG             claimed;
+};
+
+struct band_job
+{
+    void      (*func)( void *ctx, int start, int end );
+    void       *ctx;
+    LONG        refs;     /* the caller and each queued work item */
+    LONG        running;  /* the caller and each work item that may be rendering */
+    HANDLE      done;
+    struct band bands[MAX_BANDS];
+};
+
+static int get_band_count( int rows, int width )
+{
+    static int cpu_count;
+    LONGLONG count;
+
+    if (!cpu_count)
+    {
+        SYSTEM_INFO info;
+        GetSystemInfo( &info );
+        cpu_count = min( info.dwNumberOfProcessors, MAX_BANDS );
+    }
+    count = (LONGLONG)rows * width / BAND_MIN_PIXELS;
+    count = min( count, min( cpu_count, rows / BAND_MIN_ROWS ));
+    return max( 1, count );
+}
+
+static void release_band_job( struct band_job *job )
+{
+    if (InterlockedDecrement( &job->refs )) return;
+    CloseHandle( job->done );
+    HeapFree( GetProcessHeap(), 0, job );
+}
+
+/* a work item only renders its band if the caller hasn't taken it back in the meantime */
+static DWORD WINAPI band_thread( void *arg )
+{
+    struct band *band = arg;
+    struct band_job *job = band->job;
+
+    InterlockedIncrement( &job->running );
+    if (!InterlockedExchange( &band->claimed, TRUE )) job->func( job->ctx, band->start, band->end );
+    if (!InterlockedDecrement( &job->running )) SetEvent( job->done );
+    release_band_job( job );
+    return 0;
+}
+
+/* call func on count bands splitting [0,total) at the given offsets (or evenly if NULL)
+ *
+ * The caller renders every band that no work item has started once it's done with the
+ * first one, and then only waits for the bands that are actually being rendered. This
+ * way it never depends on the thread pool making progress, which it can't do when we
+ * are called with the loader lock held or when no thread can be created. */
+static void run_bands( void (*func)( void *ctx, int start, int end ), void *ctx,
+                       int total, int count, const int *offsets )
+{
+    struct band_job *job = NULL;
+    int i;
+
+    if (count > 1 && (job = HeapAlloc( GetProcessHeap(), 0, sizeof(*job) )) &&
+        !(job->done = CreateEventW( NULL, TRUE, FALSE, NULL )))
+    {
+        HeapFree( GetProcessHeap(), 0, job );
+        job = NULL;
+    }
+    if (!job)
+    {
+        func( ctx, 0, total );
+        return;
+    }
+
+    job->func = func;
+    job->ctx = ctx;
+    job->refs = 1;
+    job->running = 1;
+    for (i = 0; i < count; i++)
+    {
+        job->bands[i].job = job;
+        job->bands[i].start = offsets ? offsets[i] : MulDiv( total, i, count );
+        job->bands[i].end = offsets ? (i + 1 < count ? offsets[i + 1] : total) : MulDiv( total, i + 1, count );
+        job->bands[i].claimed = !i;
+    }
+    for (i = 1; i < count; i++)
+    {
+        InterlockedIncrement( &job->refs );
+        if (!QueueUserWorkItem( band_thread, &job->bands[i], WT_EXECUTEDEFAULT ))
+            InterlockedDecrement( &job->refs );
+    }
+    func( ctx, job->bands[0].start, job->bands[0].end );
+    for (i = count - 1; i > 0; i--)
+        if (!InterlockedExchange( &job->bands[i].claimed, TRUE ))
+            func( ctx, job->bands[i].start, job->bands[i].end );
+    if (InterlockedDecrement( &job->running )) WaitForSingleObject( job->done, INFINITE );
+    release_band_job( job );
+}
+
+struct blend_band_ctx
+{
+    dib_info      *dst;
+    const RECT    *rect;
+    const dib_info *src;
+    POINT          origin;
+    BLENDFUNCTION  blend;
+};
+
+static void blend_band( void *arg, int start, int end )
+{
+    struct blend_band_ctx *ctx = arg;
+    RECT rect = *ctx->rect;
+    POINT origin = ctx->origin;
+
+    rect.top = ctx->rect->top + start;
+    rect.bottom = ctx->rect->top + end;
+    origin.y += start;
+    ctx->dst->funcs->blend_rect( ctx->dst, &rect, ctx->src, &origin, ctx->blend );
+}
+
 static DWORD blend_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src, const RECT *src_rect,
                          HRGN clip, BLENDFUNCTION blend )
 {
-    POINT origin;
+    struct blend_band_ctx ctx;
     struct clipped_rects clipped_rects;
-    int i;
+    int i, height;
 
     if (!get_clipped_rects( dst, dst_rect, clip, &clipped_rects )) return ERROR_SUCCESS;
+    ctx.dst = dst;
+    ctx.src = src;
+    ctx.blend = blend;
     for (i = 0; i < clipped_rects.count; i++)
     {
-        origin.x = src_rect->left + clipped_rects.rects[i].left - dst_rect->left;
-        origin.y = src_rect->top  + clipped_rects.rects[i].top  - dst_rect->top;
-        dst->funcs->blend_rect( dst, &clipped_rects.rects[i], src, &origin, blend );
+        ctx.rect = &clipped_rects.rects[i];
+        ctx.origin.x = src_rect->left + clipped_rects.rects[i].left - dst_rect->left;
+        ctx.origin.y = src_rect->top  + clipped_rects.rects[i].top  - dst_rect->top;
+        height = ctx.rect->bottom - ctx.rect->top;
+        run_bands( blend_band, &ctx, height, get_band_count( height, ctx.rect->right - ctx.rect->left ), NULL );
     }
     free_clipped_rects( &clipped_rects );
     return ERROR_SUCCESS;
@@ -649,19 +788,45 @@ static void get_gradient_triangle_vertices( const GRADIENT_TRIANGLE *tri, const
     bounds->bottom = v[2].y;
 }
 
+struct gradient_band_ctx
+{
+    dib_info      *dib;
+    const RECT    *rect;
+    TRIVERTEX     *v;
+    int            mode;
+    BOOL           ret;
+};
+
+static void gradient_band( void *arg, int start, int end )
+{
+    struct gradient_band_ctx *ctx = arg;
+    RECT rect = *ctx->rect;
+
+    rect.top = ctx->rect->top + start;
+    rect.bottom = ctx->rect->top + end;
+    if (!ctx->dib->funcs->gradient_rect( ctx->dib, &rect, ctx->v, ctx->mode )) ctx->ret = FALSE;
+}
+
 static BOOL gradient_rect( dib_info *dib, TRIVERTEX *v, int mode, HRGN clip, const RECT *bounds )
 {
-    int i;
+    int i, height;
     struct clipped_rects clipped_rects;
-    BOOL ret = TRUE;
+    struct gradient_band_ctx ctx;
 
     if (!get_clipped_rects( dib, bounds, clip, &clipped_rects )) return TRUE;
+    ctx.dib = dib;
+    ctx.v = v;
+    ctx.mode = mode;
+    ctx.ret = TRUE;
     for (i = 0; i < clipped_rects.count; i++)
     {
-        if (!(ret = dib->funcs->gradient_rect( dib, &clipped_rects.rects[i], v, mode ))) break;
+        ctx.rect = &clipped_rects.rects[i];
+        height = ctx.rect->bottom - ctx.rect->top;
+        run_bands( gradient_band, &ctx, height, get_band_count( height, ctx.rect->right - ctx.rect->left ), NULL );
+        if (!ctx.ret) break;
     }
     free_clipped_rects( &clipped_rects );
-    return ret;
+    return ctx.ret;
 }
 
 static DWORD copy_src_bits( dib_info *src, RECT *src_rect )
@@ -1142,6 +1307,332 @@ static DWORD calc_1d_stretch_params( INT dst_start, INT dst_length, INT dst_vis_
 }
 
 
+struct stretch_band_ctx
+{
+    dib_info                    *dst_dib;
+    const dib_info              *src_dib;
+    const struct stretch_params *h_params;
+    const struct stretch_params *v_params;
+    void (*row_fn)( const dib_info *dst_dib, const POINT *dst_start,
+                    const dib_info *src_dib, const POINT *src_start,
+                    const struct stretch_params *params, int mode, BOOL keep_dst );
+    int                          mode;
+    BOOL                         vstretch;
+    int                          width;
+    int                          count;
+    int                          offsets[MAX_BANDS];
+    POINT                        dst_start[MAX_BANDS];
+    POINT                        src_start[MAX_BANDS];
+    int                          err[MAX_BANDS];
+};
+
+/* walk the vertical steps to record the starting state of each band; a band may only
+ * start on a step that begins a new destination row when shrinking */
+static void get_stretch_bands( struct stretch_band_ctx *ctx, POINT dst_start, POINT src_start,
+                               int err, int count )
+{
+    const struct stretch_params *v_params = ctx->v_params;
+    BOOL new_row = TRUE;
+    int i, next = 0;
+
+    ctx->count = 0;
+    for (i = 0; i < v_params->length && ctx->count < count; i++)
+    {
+        if (i >= next && new_row)
+        {
+            ctx->offsets[ctx->count] = i;
+            ctx->dst_start[ctx->count] = dst_start;
+            ctx->src_start[ctx->count] = src_start;
+            ctx->err[ctx->count] = err;
+            next = MulDiv( v_params->length, ++ctx->count, count );
+        }
+        if (ctx->vstretch)
+        {
+            if (err > 0)
+            {
+                src_start.y += v_params->src_inc;
+                err += v_params->err_add_1;
+            }
+            else err += v_params->err_add_2;
+            dst_start.y += v_params->dst_inc;
+        }
+        else
+        {
+            new_row = (err > 0);
+            if (new_row)
+            {
+                dst_start.y += v_params->dst_inc;
+                err += v_params->err_add_1;
+            }
+            else err += v_params->err_add_2;
+            src_start.y += v_params->src_inc;
+        }
+    }
+}
+
+static void stretch_band( void *arg, int start, int end )
+{
+    struct stretch_band_ctx *ctx = arg;
+    const struct stretch_params *v_params = ctx->v_params;
+    POINT dst_start, src_start;
+    int err, length = end - start, band = 0;
+
+    if (!length) return;
+    while (band + 1 < ctx->count && ctx->offsets[band + 1] <= start) band++;
+    dst_start = ctx->dst_start[band];
+    src_start = ctx->src_start[band];
+    err = ctx->err[band];
+
+    if (ctx->vstretch)
+    {
+        /* the first row of a band is always rendered, which is equivalent to copying it */
+        BOOL need_row = TRUE;
+        RECT last_row, this_row;
+        last_row.left = 0;
+        last_row.right = ctx->width;
+
+        while (length--)
+        {
+            if (need_row)
+            {
+                ctx->row_fn( ctx->dst_dib, &dst_start, ctx->src_dib, &src_start, ctx->h_params, ctx->mode, FALSE );
+                need_row = FALSE;
+            }
+            else
+            {
+                last_row.top = dst_start.y - v_params->dst_inc;
+                last_row.bottom = last_row.top + 1;
+                this_row = last_row;
+                offset_rect( &this_row, 0, v_params->dst_inc );
+                copy_rect( ctx->dst_dib, &this_row, ctx->dst_dib, &last_row, NULL, R2_COPYPEN );
+            }
+
+            if (err > 0)
+            {
+                src_start.y += v_params->src_inc;
+                need_row = TRUE;
+                err += v_params->err_add_1;
+            }
+            else err += v_params->err_add_2;
+            dst_start.y += v_params->dst_inc;
+        }
+    }
+    else
+    {
+        int merged_rows = 0;
+
+        while (length--)
+        {
+            if (ctx->mode != STRETCH_DELETESCANS || !merged_rows)
+                ctx->row_fn( ctx->dst_dib, &dst_start, ctx->src_dib, &src_start, ctx->h_params,
+                             ctx->mode, merged_rows != 0 );
+            merged_rows++;
+
+            if (err > 0)
+            {
+                dst_start.y += v_params->dst_inc;
+                merged_rows = 0;
+                err += v_params->err_add_1;
+            }
+            else err += v_params->err_add_2;
+            src_start.y += v_params->src_inc;
+        }
+    }
+}
+
+/* HALFTONE stretching: a box filter when shrinking and a bilinear filter when enlarging,
+ * applied separately on each axis to every byte channel of 24 and 32-bpp pixels */
+
+#define FILTER_SHIFT 14
+#define FILTER_ONE   (1 << FILTER_SHIFT)
+
+struct filter_axis
+{
+    int *first;    /* first source pixel for each destination pixel */
+    int *count;    /* number of source pixels */
+    int *weights;  /* weights, max_taps per destination pixel, summing to FILTER_ONE */
+    int  max_taps;
+};
+
+static BOOL can_halftone( const dib_info *dib )
+{
+    if (dib->bit_count == 24) return TRUE;
+    if (dib->bit_count != 32) return FALSE;
+    if (dib->compression == BI_RGB) return TRUE;
+    return (dib->red_len == 8 && dib->green_len == 8 && dib->blue_len == 8 &&
+            !(dib->red_shift % 8) && !(dib->green_shift % 8) && !(dib->blue_shift % 8));
+}
+
+static inline BYTE *get_halftone_ptr( const dib_info *dib, int x, int y )
+{
+    return (BYTE *)dib->bits.ptr + (dib->rect.top + y) * dib->stride + (dib->rect.left + x) * dib->bit_count / 8;
+}
+
+static void add_filter_tap( struct filter_axis *axis, int i, int src, int weight, int src_min, int src_max )
+{
+    int *weights = axis->weights + i * axis->max_taps;
+
+    /* taps are added in ascending order, clamping keeps it that way */
+    src = max( src_min, min( src_max - 1, src ));
+    if (!axis->count[i]) axis->first[i] = src;
+    if (src - axis->first[i] >= axis->count[i]) axis->count[i] = src - axis->first[i] + 1;
+    weights[src - axis->first[i]] += weight;
+}
+
+/* compute the filter taps for destination pixels [dst_min,dst_max), with source
+ * pixel positions in units of 1/|dst_len| to keep the arithmetic exact */
+static BOOL init_filter_axis( struct filter_axis *axis, int dst_pos, int dst_len, int dst_min, int dst_max,
+                              int src_pos, int src_len, int src_min, int src_max )
+{
+    LONGLONG unit = abs( dst_len ), scale = abs( src_len );
+    int i, j, n = dst_max - dst_min;
+
+    axis->max_taps = scale / unit + 3;
+    axis->first = HeapAlloc( GetProcessHeap(), 0, n * 2 * sizeof(int) );
+    axis->weights = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, n * axis->max_taps * sizeof(int) );
+    if (!axis->first || !axis->weights) return FALSE;
+    axis->count = axis->first + n;
+
+    for (i = 0; i < n; i++)
+    {
+        LONGLONG start = src_pos * unit + (LONGLONG)(dst_min + i - dst_pos) * src_len * (dst_len < 0 ? -1 : 1);
+        LONGLONG end = start + ((src_len < 0) != (dst_len < 0) ? -scale : scale);
+        int *weights = axis->weights + i * axis->max_taps, total = 0, best = 0;
+
+        axis->count[i] = 0;
+        if (end < start)
+        {
+            LONGLONG tmp = start;
+            start = end;
+            end = tmp;
+        }
+
+        if (scale > unit)  /* box filter over the covered source pixels */
+        {
+            LONGLONG pos = start;
+
+            for (j = (int)(start >= 0 ? start / unit : -((-start + unit - 1) / unit)); pos < end; j++)
+            {
+                LONGLONG next = min( end, (LONGLONG)(j + 1) * unit );
+                add_filter_tap( axis, i, j, (next - pos) * FILTER_ONE / scale, src_min, src_max );
+                pos = next;
+            }
+        }
+        else  /* bilinear between the two nearest source pixel centers */
+        {
+            LONGLONG center = start + end - unit;  /* in units of 1 / (2 * |dst_len|) */
+            LONGLONG frac;
+
+            j = (int)(center >= 0 ? center / (2 * unit) : -((-center + 2 * unit - 1) / (2 * unit)));
+            frac = (center - (LONGLONG)j * 2 * unit) * FILTER_ONE / (2 * unit);
+            add_filter_tap( axis, i, j, FILTER_ONE - frac, src_min, src_max );
+            if (frac) add_filter_tap( axis, i, j + 1, frac, src_min, src_max );
+        }
+
+        /* give the rounding error to the largest tap */
+        for (j = 0; j < axis->count[i]; j++)
+        {
+            total += weights[j];
+            if (weights[j] > weights[best]) best = j;
+        }
+        weights[best] += FILTER_ONE - total;
+    }
+    return TRUE;
+}
+
+static void free_filter_axis( struct filter_axis *axis )
+{
+    HeapFree( GetProcessHeap(), 0, axis->first );
+    HeapFree( GetProcessHeap(), 0, axis->weights );
+}
+
+struct halftone_band_ctx
+{
+    const dib_info     *dst_dib;
+    const dib_info     *src_dib;
+    struct filter_axis  h;
+    struct filter_axis  v;
+    int                 width;
+    int                 src_left;
+    int                 src_width;
+    DWORD               ret;
+};
+
+static void halftone_band( void *arg, int start, int end )
+{
+    struct halftone_band_ctx *ctx = arg;
+    const struct filter_axis *h = &ctx->h, *v = &ctx->v;
+    int bpp = ctx->dst_dib->bit_count / 8, row_len = ctx->src_width * bpp;
+    int x, y, i, c, *row;
+
+    if (!(row = HeapAlloc( GetProcessHeap(), 0, row_len * sizeof(int) )))
+    {
+        ctx->ret = ERROR_OUTOFMEMORY;
+        return;
+    }
+
+    for (y = start; y < end; y++)
+    {
+        const int *v_weights = v->weights + y * v->max_taps;
+        BYTE *dst_ptr = get_halftone_ptr( ctx->dst_dib, 0, y );
+
+        /* vertical pass into a row with 8 bits of fraction */
+        memset( row, 0, row_len * sizeof(int) );
+        for (i = 0; i < v->count[y]; i++)
+        {
+            const BYTE *src_ptr = get_halftone_ptr( ctx->src_dib, ctx->src_left, v->first[y] + i );
+            int weight = v_weights[i];
+
+            if (!weight) continue;
+            for (x = 0; x < row_len; x++) row[x] += src_ptr[x] * weight;
+        }
+        for (x = 0; x < row_len; x++)
+            row[x] = (row[x] + (1 << (FILTER_SHIFT - 9))) >> (FILTER_SHIFT - 8);
+
+        /* horizontal pass into the destination */
+        for (x = 0; x < ctx->width; x++, dst_ptr += bpp)
+        {
+            const int *h_weights = h->weights + x * h->max_taps;
+            const int *src_row = row + (h->first[x] - ctx->src_left) * bpp;
+
+            for (c = 0; c < bpp; c++)
+            {
+                int val = 0;
+                for (i = 0; i < h->count[x]; i++) val += src_row[i * bpp + c] * h_weights[i];
+                dst_ptr[c] = (val + (1 << (FILTER_SHIFT + 7))) >> (FILTER_SHIFT + 8);
+            }
+        }
+    }
+    HeapFree( GetProcessHeap(), 0, row );
+}
+
+static DWORD stretch_halftone( const dib_info *dst_dib, const struct bitblt_coords *dst,
+                               const dib_info *src_dib, const struct bitblt_coords *src )
+{
+    struct halftone_band_ctx ctx;
+    int height = dst->visrect.bottom - dst->visrect.top;
+
+    memset( &ctx, 0, sizeof(ctx) );
+    ctx.dst_dib = dst_dib;
+    ctx.src_dib = src_dib;
+    ctx.width = dst->visrect.right - dst->visrect.left;
+    ctx.src_left = src->visrect.left;
+    ctx.src_width = src->visrect.right - src->visrect.left;
+    ctx.ret = ERROR_SUCCESS;
+
+    if (!init_filter_axis( &ctx.h, dst->x, dst->width, dst->visrect.left, dst->visrect.right,
+                           src->x, src->width, src->visrect.left, src->visrect.right ) ||
+        !init_filter_axis( &ctx.v, dst->y, dst->height, dst->visrect.top, dst->visrect.bottom,
+                           src->y, src->height, src->visrect.top, src->visrect.bottom ))
+        ctx.ret = ERROR_OUTOFMEMORY;
+    else
+        run_bands( halftone_band, &ctx, height, get_band_count( height, ctx.src_width ), NULL );
+
+    free_filter_axis( &ctx.h );
+    free_filter_axis( &ctx.v );
+    return ctx.ret;
+}
+
 DWORD stretch_bitmapinfo( const BITMAPINFO *src_info, void *src_bits, struct bitblt_coords *src,
                           const BITMAPINFO *dst_info, void *dst_bits, struct bitblt_coords *dst,
                           INT mode )
@@ -1151,11 +1642,8 @@ DWORD stretch_bitmapinfo( const BITMAPINFO *src_info, void *src_bits, struct bit
     RECT rect;
     BOOL hstretch, vstretch;
     struct stretch_params v_params, h_params;
-    int err;
+    struct stretch_band_ctx ctx;
     DWORD ret;
-    void (* row_fn)(const dib_info *dst_dib, const POINT *dst_start,
-                    const dib_info *src_dib, const POINT *src_start,
-                    const struct stretch_params *params, int mode, BOOL keep_dst);
 
     TRACE("dst %d, %d - %d x %d visrect %s src %d, %d - %d x %d visrect %s\n",
           dst->x, dst->y, dst->width, dst->height, wine_dbgstr_rect(&dst->visrect),
@@ -1164,6 +1652,12 @@ DWORD stretch_bitmapinfo( const BITMAPINFO *src_info, void *src_bits, struct bit
     init_dib_info_from_bitmapinfo( &src_dib, src_info, src_bits );
     init_dib_info_from_bitmapinfo( &dst_dib, dst_info, dst_bits );
 
+    if (mode == HALFTONE && can_halftone( &dst_dib ))
+    {
+        if ((ret = stretch_halftone( &dst_dib, dst, &src_dib, src ))) return ret;
+        goto done;
+    }
+
     /* v */
     ret = calc_1d_stretch_params( dst->y, dst->height, dst->visrect.top, dst->visrect.bottom,
                                   src->y, src->height, src->visrect.top, src->visrect.bottom,
@@ -1189,65 +1683,19 @@ DWORD stretch_bitmapinfo( const BITMAPINFO *src_info, void *src_bits, struct bit
     dst_start.x -= dst->visrect.left;
     dst_start.y -= dst->visrect.top;
 
-    err = v_params.err_start;
-
-    row_fn = hstretch ? dst_dib.funcs->stretch_row : dst_dib.funcs->shrink_row;
-
-    if (vstretch)
-    {
-        BOOL need_row = TRUE;
-        RECT last_row, this_row;
-        if (hstretch) mode = STRETCH_DELETESCANS;
-        last_row.left = 0;
-        last_row.right = dst->visrect.right - dst->visrect.left;
-
-        while (v_params.length--)
-        {
-            if (need_row)
-            {
-                row_fn( &dst_dib, &dst_start, &src_dib, &src_start, &h_params, mode, FALSE );
-                need_row = FALSE;
-            }
-            else
-            {
-                last_row.top = dst_start.y - v_params.dst_inc;
-                last_row.bottom = last_row.top + 1;
-                this_row = last_row;
-                offset_rect( &this_row, 0, v_params.dst_inc );
-                copy_rect( &dst_dib, &this_row, &dst_dib, &last_row, NULL, R2_COPYPEN );
-            }
-
-            if (err > 0)
-            {
-                src_start.y += v_params.src_inc;
-                need_row = TRUE;
-                err += v_params.err_add_1;
-            }
-            else err += v_params.err_add_2;
-            dst_start.y += v_params.dst_inc;
-        }
-    }
-    else
-    {
-        int merged_rows = 0;
-
-        while (v_params.length--)
-        {
-            if (mode != STRETCH_DELETESCANS || !merged_rows)
-                row_fn( &dst_dib, &dst_start, &src_dib, &src_start, &h_params, mode, merged_rows != 0 );
-            merged_rows++;
-
-            if (err > 0)
-            {
-                dst_start.y += v_params.dst_inc;
-                merged_rows = 0;
-                err += v_params.err_add_1;
-            }
-            else err += v_params.err_add_2;
-            src_start.y += v_params.src_inc;
-        }
-    }
-
+    ctx.dst_dib = &dst_dib;
+    ctx.src_dib = &src_dib;
+    ctx.h_params = &h_params;
+    ctx.v_params = &v_params;
+    ctx.row_fn = hstretch ? dst_dib.funcs->stretch_row : dst_dib.funcs->shrink_row;
+    ctx.mode = (vstretch && hstretch) ? STRETCH_DELETESCANS : mode;
+    ctx.vstretch = vstretch;
+    ctx.width = dst->visrect.right - dst->visrect.left;
+    get_stretch_bands( &ctx, dst_start, src_start, v_params.err_start,
+                       get_band_count( v_params.length, h_params.length ));
+    run_bands( stretch_band, &ctx, v_params.length, ctx.count, ctx.offsets );
+
+done:
     /* update coordinates, the destination rectangle is always stored at 0,0 */
     *src = *dst;
     src->x -= src->visrect.left;
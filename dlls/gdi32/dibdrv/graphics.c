@@ -30,6 +30,8 @@ WINE_DEFAULT_DEBUG_CHANNEL(dib);
 struct cached_glyph
 {
     GLYPHMETRICS metrics;
+    DWORD        size;      /* allocation size */
+    LONG         used;      /* font clock value at the last use, for eviction */
     BYTE         bits[1];
 };
 
@@ -43,6 +45,9 @@ enum glyph_type
 #define GLYPH_CACHE_PAGE_SIZE  0x100
 #define GLYPH_CACHE_PAGES      (0x10000 / GLYPH_CACHE_PAGE_SIZE)
 
+#define GLYPH_CACHE_MAX_FONT_SIZE  (4 * 1024 * 1024)   /* glyph bytes cached for a single font before eviction */
+#define GLYPH_CACHE_MAX_SIZE       (16 * 1024 * 1024)  /* total glyph bytes before unused fonts are released */
+
 struct cached_font
 {
     struct list           entry;
@@ -51,10 +56,17 @@ struct cached_font
     LOGFONTW              lf;
     XFORM                 xform;
     UINT                  aa_flags;
+    SRWLOCK               lock;     /* held shared while drawing, exclusive to add or evict glyphs */
+    LONG                  clock;    /* incremented for each string drawn */
+    LONG                  size;     /* bytes of cached glyphs */
+    UINT                  count;    /* number of cached glyphs */
+    LONG                  hits;     /* statistics, only used for tracing */
+    LONG                  misses;
     struct cached_glyph **glyphs[GLYPH_NBTYPES][GLYPH_CACHE_PAGES];
 };
 
 static struct list font_cache = LIST_INIT( font_cache );
+static LONG glyph_cache_size;
 
 static CRITICAL_SECTION font_cache_cs;
 static CRITICAL_SECTION_DEBUG critsect_debug =
@@ -482,10 +494,28 @@ static int font_cache_cmp( const struct cached_font *p1, const struct cached_fon
     return ret;
 }
 
+static void free_cached_glyphs( struct cached_font *font )
+{
+    UINT i, j, k;
+
+    TRACE( "%p: %u hits %u misses %u glyphs %u bytes\n", font, font->hits, font->misses, font->count, font->size );
+    for (i = 0; i < GLYPH_NBTYPES; i++)
+    {
+        for (j = 0; j < GLYPH_CACHE_PAGES; j++)
+        {
+            if (!font->glyphs[i][j]) continue;
+            for (k = 0; k < GLYPH_CACHE_PAGE_SIZE; k++)
+                HeapFree( GetProcessHeap(), 0, font->glyphs[i][j][k] );
+            HeapFree( GetProcessHeap(), 0, font->glyphs[i][j] );
+        }
+    }
+    InterlockedExchangeAdd( &glyph_cache_size, -font->size );
+}
+
 static struct cached_font *add_cached_font( HDC hdc, HFONT hfont, UINT aa_flags )
 {
-    struct cached_font font, *ptr, *last_unused = NULL;
-    UINT i = 0, j, k;
+    struct cached_font font, *ptr, *next, *last_unused = NULL;
+    UINT i = 0;
 
     GetObjectW( hfont, sizeof(font.lf), &font.lf );
     GetTransform( hdc, 0x204, &font.xform );
@@ -519,16 +549,7 @@ static struct cached_font *add_cached_font( HDC hdc, HFONT hfont, UINT aa_flags
     if (i > 5)  /* keep at least 5 of the most-recently used fonts around */
     {
         ptr = last_unused;
-        for (i = 0; i < GLYPH_NBTYPES; i++)
-        {
-            for (j = 0; j < GLYPH_CACHE_PAGES; j++)
-            {
-                if (!ptr->glyphs[i][j]) continue;
-                for (k = 0; k < GLYPH_CACHE_PAGE_SIZE; k++)
-                    HeapFree( GetProcessHeap(), 0, ptr->glyphs[i][j][k] );
-                HeapFree( GetProcessHeap(), 0, ptr->glyphs[i][j] );
-            }
-        }
+        free_cached_glyphs( ptr );
         list_remove( &ptr->entry );
     }
     else if (!(ptr = HeapAlloc( GetProcessHeap(), 0, sizeof(*ptr) )))
@@ -539,9 +560,24 @@ static struct cached_font *add_cached_font( HDC hdc, HFONT hfont, UINT aa_flags
 
     *ptr = font;
     ptr->ref = 1;
+    InitializeSRWLock( &ptr->lock );
+    ptr->clock = 0;
+    ptr->size = 0;
+    ptr->count = 0;
+    ptr->hits = ptr->misses = 0;
     memset( ptr->glyphs, 0, sizeof(ptr->glyphs) );
 done:
     list_add_head( &font_cache, &ptr->entry );
+
+    /* then release the least recently used fonts until the glyphs fit in the budget */
+    LIST_FOR_EACH_ENTRY_SAFE_REV( last_unused, next, &font_cache, struct cached_font, entry )
+    {
+        if (glyph_cache_size <= GLYPH_CACHE_MAX_SIZE) break;
+        if (last_unused->ref) continue;
+        free_cached_glyphs( last_unused );
+        list_remove( &last_unused->entry );
+        HeapFree( GetProcessHeap(), 0, last_unused );
+    }
     LeaveCriticalSection( &font_cache_cs );
     TRACE( "%d %s -> %p\n", ptr->lf.lfHeight, debugstr_w(ptr->lf.lfFaceName), ptr );
     return ptr;
@@ -552,31 +588,77 @@ void release_cached_font( struct cached_font *font )
     if (font) InterlockedDecrement( &font->ref );
 }
 
+static int glyph_slot_cmp( const void *p1, const void *p2 )
+{
+    const struct cached_glyph *g1 = **(struct cached_glyph * const * const *)p1;
+    const struct cached_glyph *g2 = **(struct cached_glyph * const * const *)p2;
+
+    return g1->used - g2->used;
+}
+
+/***********************************************************************
+ *         evict_cached_glyphs
+ *
+ * Free the least recently used glyphs of a font, so that the cache goes down
+ * to three quarters of its budget once a glyph of the given size is added.
+ * The font lock must be held exclusively.
+ */
+static void evict_cached_glyphs( struct cached_font *font, DWORD size )
+{
+    struct cached_glyph ***slots;
+    LONG target = GLYPH_CACHE_MAX_FONT_SIZE / 4 * 3 - size;
+    UINT i, j, k, count = 0, old_count = font->count;
+    LONG old_size = font->size;
+
+    if (!(slots = HeapAlloc( GetProcessHeap(), 0, font->count * sizeof(*slots) ))) return;
+
+    for (i = 0; i < GLYPH_NBTYPES; i++)
+        for (j = 0; j < GLYPH_CACHE_PAGES; j++)
+        {
+            if (!font->glyphs[i][j]) continue;
+            for (k = 0; k < GLYPH_CACHE_PAGE_SIZE; k++)
+                if (font->glyphs[i][j][k]) slots[count++] = &font->glyphs[i][j][k];
+        }
+
+    qsort( slots, count, sizeof(*slots), glyph_slot_cmp );
+    for (i = 0; i < count && font->size > target; i++)
+    {
+        font->size -= (*slots[i])->size;
+        font->count--;
+        HeapFree( GetProcessHeap(), 0, *slots[i] );
+        *slots[i] = NULL;
+    }
+    InterlockedExchangeAdd( &glyph_cache_size, font->size - old_size );
+    HeapFree( GetProcessHeap(), 0, slots );
+    TRACE( "%p: evicted %u glyphs, %u bytes, %u hits %u misses so far\n", font, old_count - font->count,
+           old_size - font->size, font->hits, font->misses );
+}
+
+/* add a glyph to the cache, the font lock must be held exclusively */
 static struct cached_glyph *add_cached_glyph( struct cached_font *font, UINT index, UINT flags,
                                               struct cached_glyph *glyph )
 {
-    struct cached_glyph *ret;
     enum glyph_type type = (flags & ETO_GLYPH_INDEX) ? GLYPH_INDEX : GLYPH_WCHAR;
     UINT page = index / GLYPH_CACHE_PAGE_SIZE;
     UINT entry = index % GLYPH_CACHE_PAGE_SIZE;
 
     if (!font->glyphs[type][page])
     {
-        struct cached_glyph **ptr;
-
-        ptr = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, GLYPH_CACHE_PAGE_SIZE * sizeof(*ptr) );
-        if (!ptr)
+        font->glyphs[type][page] = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY,
+                                              GLYPH_CACHE_PAGE_SIZE * sizeof(*font->glyphs[type][page]) );
+        if (!font->glyphs[type][page])
         {
             HeapFree( GetProcessHeap(), 0, glyph );
             return NULL;
         }
-        if (InterlockedCompareExchangePointer( (void **)&font->glyphs[type][page], ptr, NULL ))
-            HeapFree( GetProcessHeap(), 0, ptr );
     }
-    ret = InterlockedCompareExchangePointer( (void **)&font->glyphs[type][page][entry], glyph, NULL );
-    if (!ret) ret = glyph;
-    else HeapFree( GetProcessHeap(), 0, glyph );
-    return ret;
+    if (font->size + glyph->size > GLYPH_CACHE_MAX_FONT_SIZE) evict_cached_glyphs( font, glyph->size );
+
+    font->glyphs[type][page][entry] = glyph;
+    font->size += glyph->size;
+    font->count++;
+    InterlockedExchangeAdd( &glyph_cache_size, glyph->size );
+    return glyph;
 }
 
 static struct cached_glyph *get_cached_glyph( struct cached_font *font, UINT index, UINT flags )
@@ -672,6 +754,8 @@ static const int padding[4] = {0, 3, 2, 1};
  *
  * For non-antialiased bitmaps convert them to the 17-level format
  * using only values 0 or 16.
+ *
+ * The font lock must be held exclusively.
  */
 static struct cached_glyph *cache_glyph_bitmap( HDC hdc, struct cached_font *font, UINT index, UINT flags )
 {
@@ -732,6 +816,8 @@ static struct cached_glyph *cache_glyph_bitmap( HDC hdc, struct cached_font *fon
 
 done:
     glyph->metrics = metrics;
+    glyph->size = FIELD_OFFSET( struct cached_glyph, bits[size] );
+    glyph->used = font->clock;
     return add_cached_glyph( font, index, flags, glyph );
 }
 
@@ -744,6 +830,7 @@ static void render_string( HDC hdc, dib_info *dib, struct cached_font *font, INT
     dib_info glyph_dib;
     DWORD text_color;
     struct intensity_range ranges[17];
+    LONG clock;
 
     glyph_dib.bit_count    = get_glyph_depth( font->aa_flags );
     glyph_dib.rect.left    = 0;
@@ -756,10 +843,35 @@ static void render_string( HDC hdc, dib_info *dib, struct cached_font *font, INT
     if (glyph_dib.bit_count == 8)
         get_aa_ranges( dib->funcs->pixel_to_colorref( dib, text_color ), ranges );
 
+    /* glyphs can only be evicted while no other thread is drawing with the font */
+    AcquireSRWLockShared( &font->lock );
+    clock = InterlockedIncrement( &font->clock );
+
     for (i = 0; i < count; i++)
     {
-        if (!(glyph = get_cached_glyph( font, str[i], flags )) &&
-            !(glyph = cache_glyph_bitmap( hdc, font, str[i], flags ))) continue;
+        BOOL exclusive = FALSE;
+
+        if ((glyph = get_cached_glyph( font, str[i], flags ))) InterlockedIncrement( &font->hits );
+        else
+        {
+            InterlockedIncrement( &font->misses );
+            /* keep the lock exclusive until the glyph is drawn, so that it can't be evicted */
+            ReleaseSRWLockShared( &font->lock );
+            AcquireSRWLockExclusive( &font->lock );
+            exclusive = TRUE;
+            if (!(glyph = get_cached_glyph( font, str[i], flags )))
+                glyph = cache_glyph_bitmap( hdc, font, str[i], flags );
+        }
+        if (!glyph)
+        {
+            if (exclusive)
+            {
+                ReleaseSRWLockExclusive( &font->lock );
+                AcquireSRWLockShared( &font->lock );
+            }
+            continue;
+        }
+        glyph->used = clock;
 
         glyph_dib.width       = glyph->metrics.gmBlackBoxX;
         glyph_dib.height      = glyph->metrics.gmBlackBoxY;
@@ -785,7 +897,14 @@ static void render_string( HDC hdc, dib_info *dib, struct cached_font *font, INT
             x += glyph->metrics.gmCellIncX;
             y += glyph->metrics.gmCellIncY;
         }
+
+        if (exclusive)
+        {
+            ReleaseSRWLockExclusive( &font->lock );
+            AcquireSRWLockShared( &font->lock );
+        }
     }
+    ReleaseSRWLockShared( &font->lock );
 }
 
 BOOL render_aa_text_bitmapinfo( HDC hdc, BITMAPINFO *info, struct gdi_image_bits *bits,
@@ -19,6 +19,9 @@
  */
 
 #include <assert.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "gdi_private.h"
 #include "dibdrv.h"
@@ -280,10 +283,26 @@ static inline void memset_16( WORD *start, WORD val, DWORD size )
 #endif
 }
 
+static inline void do_rop_row_32( DWORD *ptr, DWORD and, DWORD xor, int len )
+{
+    int x = 0;
+
+#ifdef __SSE2__
+    __m128i and_mask = _mm_set1_epi32( and ), xor_mask = _mm_set1_epi32( xor );
+
+    for (; x + 4 <= len; x += 4)
+    {
+        __m128i val = _mm_loadu_si128( (const __m128i *)(ptr + x) );
+        _mm_storeu_si128( (__m128i *)(ptr + x), _mm_xor_si128( _mm_and_si128( val, and_mask ), xor_mask ));
+    }
+#endif
+    for (; x < len; x++) do_rop_32( ptr + x, and, xor );
+}
+
 static void solid_rects_32(const dib_info *dib, int num, const RECT *rc, DWORD and, DWORD xor)
 {
-    DWORD *ptr, *start;
-    int x, y, i;
+    DWORD *start;
+    int y, i;
 
     for(i = 0; i < num; i++, rc++)
     {
@@ -292,8 +311,7 @@ static void solid_rects_32(const dib_info *dib, int num, const RECT *rc, DWORD a
         start = get_pixel_ptr_32(dib, rc->left, rc->top);
         if (and)
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 4)
-                for(x = rc->left, ptr = start; x < rc->right; x++)
-                    do_rop_32(ptr++, and, xor);
+                do_rop_row_32( start, and, xor, rc->right - rc->left );
         else
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 4)
                 memset_32( start, xor, rc->right - rc->left );
@@ -4182,32 +4200,146 @@ static inline DWORD blend_rgb( BYTE dst_r, BYTE dst_g, BYTE dst_b, DWORD src, BL
             blend_color( dst_r, src >> 16, blend.SourceConstantAlpha ) << 16);
 }
 
+#ifdef __SSE2__
+
+/* exact (val + 127) / 255 in each 16-bit lane, for val <= 255 * 255 */
+static inline __m128i div255_epi16( __m128i val )
+{
+    val = _mm_add_epi16( val, _mm_set1_epi16( 128 ) );
+    return _mm_srli_epi16( _mm_add_epi16( val, _mm_srli_epi16( val, 8 )), 8 );
+}
+
+/* broadcast the alpha lane of each of the two pixels in a register */
+static inline __m128i alpha_epi16( __m128i val )
+{
+    return _mm_shufflehi_epi16( _mm_shufflelo_epi16( val, 0xff ), 0xff );
+}
+
+/* src + dst * (255 - alpha) on two unpacked premultiplied pixels */
+static inline __m128i blend_argb_epi16( __m128i dst, __m128i src )
+{
+    __m128i inv_alpha = _mm_sub_epi16( _mm_set1_epi16( 255 ), alpha_epi16( src ));
+    return _mm_add_epi16( src, div255_epi16( _mm_mullo_epi16( dst, inv_alpha )));
+}
+
+/* blend four pixels with per-pixel alpha; returns FALSE if a channel overflows,
+ * in which case the scalar code has to be used to get the same result */
+static inline BOOL blend_argb_sse2( DWORD *dst, const DWORD *src, DWORD alpha )
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i s = _mm_loadu_si128( (const __m128i *)src );
+    __m128i d = _mm_loadu_si128( (const __m128i *)dst );
+    __m128i s_lo = _mm_unpacklo_epi8( s, zero ), s_hi = _mm_unpackhi_epi8( s, zero );
+    __m128i res_lo, res_hi, max = _mm_set1_epi16( 255 );
+
+    if (alpha != 255)
+    {
+        __m128i const_alpha = _mm_set1_epi16( alpha );
+        s_lo = div255_epi16( _mm_mullo_epi16( s_lo, const_alpha ));
+        s_hi = div255_epi16( _mm_mullo_epi16( s_hi, const_alpha ));
+    }
+    res_lo = blend_argb_epi16( _mm_unpacklo_epi8( d, zero ), s_lo );
+    res_hi = blend_argb_epi16( _mm_unpackhi_epi8( d, zero ), s_hi );
+    if (_mm_movemask_epi8( _mm_or_si128( _mm_cmpgt_epi16( res_lo, max ), _mm_cmpgt_epi16( res_hi, max ))))
+        return FALSE;
+    _mm_storeu_si128( (__m128i *)dst, _mm_packus_epi16( res_lo, res_hi ));
+    return TRUE;
+}
+
+/* blend four pixels with a constant alpha */
+static inline void blend_constant_alpha_sse2( DWORD *dst, const DWORD *src, DWORD alpha, DWORD src_mask )
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i s = _mm_or_si128( _mm_loadu_si128( (const __m128i *)src ), _mm_set1_epi32( src_mask ));
+    __m128i d = _mm_loadu_si128( (const __m128i *)dst );
+    __m128i src_alpha = _mm_set1_epi16( alpha ), dst_alpha = _mm_set1_epi16( 255 - alpha );
+    __m128i res_lo, res_hi;
+
+    res_lo = _mm_add_epi16( _mm_mullo_epi16( _mm_unpacklo_epi8( s, zero ), src_alpha ),
+                            _mm_mullo_epi16( _mm_unpacklo_epi8( d, zero ), dst_alpha ));
+    res_hi = _mm_add_epi16( _mm_mullo_epi16( _mm_unpackhi_epi8( s, zero ), src_alpha ),
+                            _mm_mullo_epi16( _mm_unpackhi_epi8( d, zero ), dst_alpha ));
+    _mm_storeu_si128( (__m128i *)dst, _mm_packus_epi16( div255_epi16( res_lo ), div255_epi16( res_hi )));
+}
+
+#endif  /* __SSE2__ */
+
+static void blend_row_argb( DWORD *dst, const DWORD *src, int len )
+{
+    int x = 0;
+
+#ifdef __SSE2__
+    for (; x + 4 <= len; x += 4)
+    {
+        if (blend_argb_sse2( dst + x, src + x, 255 )) continue;
+        dst[x]     = blend_argb( dst[x],     src[x] );
+        dst[x + 1] = blend_argb( dst[x + 1], src[x + 1] );
+        dst[x + 2] = blend_argb( dst[x + 2], src[x + 2] );
+        dst[x + 3] = blend_argb( dst[x + 3], src[x + 3] );
+    }
+#endif
+    for (; x < len; x++) dst[x] = blend_argb( dst[x], src[x] );
+}
+
+static void blend_row_argb_alpha( DWORD *dst, const DWORD *src, int len, DWORD alpha )
+{
+    int x = 0;
+
+#ifdef __SSE2__
+    for (; x + 4 <= len; x += 4)
+    {
+        if (blend_argb_sse2( dst + x, src + x, alpha )) continue;
+        dst[x]     = blend_argb_alpha( dst[x],     src[x],     alpha );
+        dst[x + 1] = blend_argb_alpha( dst[x + 1], src[x + 1], alpha );
+        dst[x + 2] = blend_argb_alpha( dst[x + 2], src[x + 2], alpha );
+        dst[x + 3] = blend_argb_alpha( dst[x + 3], src[x + 3], alpha );
+    }
+#endif
+    for (; x < len; x++) dst[x] = blend_argb_alpha( dst[x], src[x], alpha );
+}
+
+static void blend_row_constant_alpha( DWORD *dst, const DWORD *src, int len, DWORD alpha )
+{
+    int x = 0;
+
+#ifdef __SSE2__
+    for (; x + 4 <= len; x += 4) blend_constant_alpha_sse2( dst + x, src + x, alpha, 0 );
+#endif
+    for (; x < len; x++) dst[x] = blend_argb_constant_alpha( dst[x], src[x], alpha );
+}
+
+static void blend_row_no_src_alpha( DWORD *dst, const DWORD *src, int len, DWORD alpha )
+{
+    int x = 0;
+
+#ifdef __SSE2__
+    for (; x + 4 <= len; x += 4) blend_constant_alpha_sse2( dst + x, src + x, alpha, 0xff000000 );
+#endif
+    for (; x < len; x++) dst[x] = blend_argb_no_src_alpha( dst[x], src[x], alpha );
+}
+
 static void blend_rect_8888(const dib_info *dst, const RECT *rc,
                             const dib_info *src, const POINT *origin, BLENDFUNCTION blend)
 {
     DWORD *src_ptr = get_pixel_ptr_32( src, origin->x, origin->y );
     DWORD *dst_ptr = get_pixel_ptr_32( dst, rc->left, rc->top );
-    int x, y;
+    int y, len = rc->right - rc->left;
 
     if (blend.AlphaFormat & AC_SRC_ALPHA)
     {
-	if (blend.SourceConstantAlpha == 255)
-	    for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-		for (x = 0; x < rc->right - rc->left; x++)
-		    dst_ptr[x] = blend_argb( dst_ptr[x], src_ptr[x] );
+        if (blend.SourceConstantAlpha == 255)
+            for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
+                blend_row_argb( dst_ptr, src_ptr, len );
         else
-	    for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-		for (x = 0; x < rc->right - rc->left; x++)
-		    dst_ptr[x] = blend_argb_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
+            for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
+                blend_row_argb_alpha( dst_ptr, src_ptr, len, blend.SourceConstantAlpha );
     }
     else if (src->compression == BI_RGB)
-	for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-	    for (x = 0; x < rc->right - rc->left; x++)
-		dst_ptr[x] = blend_argb_constant_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
+        for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
+            blend_row_constant_alpha( dst_ptr, src_ptr, len, blend.SourceConstantAlpha );
     else
-	for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-	    for (x = 0; x < rc->right - rc->left; x++)
-		dst_ptr[x] = blend_argb_no_src_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
+        for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
+            blend_row_no_src_alpha( dst_ptr, src_ptr, len, blend.SourceConstantAlpha );
 }
 
 static void blend_rect_32(const dib_info *dst, const RECT *rc,
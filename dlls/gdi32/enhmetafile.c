@@ -48,10 +48,34 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(enhmetafile);
 
+/* how a record can be skipped when it falls outside of the clip box */
+enum emf_cull_type
+{
+    EMF_CULL_NONE,          /* never */
+    EMF_CULL_RECT,          /* the output is within the bounds */
+    EMF_CULL_CLIPPED_TEXT,  /* same as EMF_CULL_RECT, but may update the current position */
+    EMF_CULL_TEXT           /* the bounds need to be extended by the font height */
+};
+
+/* pre-decoded record, see EMF_GetRecordTable */
+struct emf_record
+{
+    DWORD offset;   /* offset of the record in the metafile */
+    DWORD cull;     /* enum emf_cull_type */
+    RECTL bounds;   /* output bounds in logical coordinates */
+};
+
+struct emf_record_table
+{
+    UINT count;
+    struct emf_record records[1];
+};
+
 typedef struct
 {
     ENHMETAHEADER  *emh;
     BOOL           on_disk;   /* true if metafile is on disk */
+    struct emf_record_table *records;  /* built on first playback */
 } ENHMETAFILEOBJ;
 
 static const struct emr_name {
@@ -268,6 +292,7 @@ HENHMETAFILE EMF_Create_HENHMETAFILE(ENHMETAHEADER *emh, BOOL on_disk )
 
     metaObj->emh = emh;
     metaObj->on_disk = on_disk;
+    metaObj->records = NULL;
 
     if (!(hmf = alloc_gdi_handle( metaObj, OBJ_ENHMETAFILE, NULL )))
         HeapFree( GetProcessHeap(), 0, metaObj );
@@ -287,6 +312,7 @@ static BOOL EMF_Delete_HENHMETAFILE( HENHMETAFILE hmf )
         UnmapViewOfFile( metaObj->emh );
     else
         HeapFree( GetProcessHeap(), 0, metaObj->emh );
+    HeapFree( GetProcessHeap(), 0, metaObj->records );
     return HeapFree( GetProcessHeap(), 0, metaObj );
 }
 
@@ -308,6 +334,166 @@ static ENHMETAHEADER *EMF_GetEnhMetaHeader( HENHMETAFILE hmf )
     return ret;
 }
 
+/******************************************************************
+ *         EMF_GetRecordBounds
+ *
+ * Compute the logical bounds of the output of records that can be culled.
+ */
+static DWORD EMF_GetRecordBounds( const ENHMETARECORD *emr, RECTL *bounds )
+{
+    switch (emr->iType)
+    {
+    case EMR_BITBLT:
+    case EMR_STRETCHBLT:
+    case EMR_MASKBLT:
+    case EMR_ALPHABLEND:
+    {
+        const EMRBITBLT *blt = (const EMRBITBLT *)emr;
+
+        if (emr->nSize < sizeof(*blt)) return EMF_CULL_NONE;
+        bounds->left   = min( blt->xDest, blt->xDest + blt->cxDest );
+        bounds->right  = max( blt->xDest, blt->xDest + blt->cxDest );
+        bounds->top    = min( blt->yDest, blt->yDest + blt->cyDest );
+        bounds->bottom = max( blt->yDest, blt->yDest + blt->cyDest );
+        return EMF_CULL_RECT;
+    }
+    case EMR_STRETCHDIBITS:
+    {
+        const EMRSTRETCHDIBITS *sdib = (const EMRSTRETCHDIBITS *)emr;
+
+        if (emr->nSize < sizeof(*sdib)) return EMF_CULL_NONE;
+        bounds->left   = min( sdib->xDest, sdib->xDest + sdib->cxDest );
+        bounds->right  = max( sdib->xDest, sdib->xDest + sdib->cxDest );
+        bounds->top    = min( sdib->yDest, sdib->yDest + sdib->cyDest );
+        bounds->bottom = max( sdib->yDest, sdib->yDest + sdib->cyDest );
+        return EMF_CULL_RECT;
+    }
+    case EMR_PLGBLT:
+    {
+        const EMRPLGBLT *plg = (const EMRPLGBLT *)emr;
+        LONG x3, y3;
+
+        if (emr->nSize < sizeof(*plg)) return EMF_CULL_NONE;
+        x3 = plg->aptlDest[1].x + plg->aptlDest[2].x - plg->aptlDest[0].x;
+        y3 = plg->aptlDest[1].y + plg->aptlDest[2].y - plg->aptlDest[0].y;
+        bounds->left   = min( min( plg->aptlDest[0].x, plg->aptlDest[1].x ), min( plg->aptlDest[2].x, x3 ));
+        bounds->right  = max( max( plg->aptlDest[0].x, plg->aptlDest[1].x ), max( plg->aptlDest[2].x, x3 ));
+        bounds->top    = min( min( plg->aptlDest[0].y, plg->aptlDest[1].y ), min( plg->aptlDest[2].y, y3 ));
+        bounds->bottom = max( max( plg->aptlDest[0].y, plg->aptlDest[1].y ), max( plg->aptlDest[2].y, y3 ));
+        return EMF_CULL_RECT;
+    }
+    case EMR_EXTTEXTOUTA:
+    case EMR_EXTTEXTOUTW:
+    {
+        const EMREXTTEXTOUTW *text = (const EMREXTTEXTOUTW *)emr;
+        const INT *dx;
+        LONG width = 0;
+        DWORD i;
+
+        if (emr->nSize < sizeof(*text)) return EMF_CULL_NONE;
+
+        /* clipped text doesn't go outside of its rectangle */
+        if (text->emrtext.fOptions & ETO_CLIPPED)
+        {
+            *bounds = text->emrtext.rcl;
+            return EMF_CULL_CLIPPED_TEXT;
+        }
+
+        /* otherwise the advances give the width of the string, and its height
+         * depends on the current font */
+        if (text->emrtext.fOptions & (ETO_OPAQUE | ETO_PDY)) return EMF_CULL_NONE;
+        if (!text->emrtext.nChars || !text->emrtext.offDx) return EMF_CULL_NONE;
+        if (text->emrtext.offDx > emr->nSize ||
+            text->emrtext.nChars > (emr->nSize - text->emrtext.offDx) / sizeof(*dx))
+            return EMF_CULL_NONE;
+
+        dx = (const INT *)((const BYTE *)emr + text->emrtext.offDx);
+        for (i = 0; i < text->emrtext.nChars; i++)
+        {
+            if (dx[i] < -0x100000 || dx[i] > 0x100000) return EMF_CULL_NONE;
+            width += abs( dx[i] );
+            if (width > 0x1000000) return EMF_CULL_NONE;
+        }
+
+        /* the alignment isn't known here, so allow the string on both sides */
+        bounds->left   = text->emrtext.ptlReference.x - width;
+        bounds->right  = text->emrtext.ptlReference.x + width;
+        bounds->top    = text->emrtext.ptlReference.y;
+        bounds->bottom = text->emrtext.ptlReference.y;
+        return EMF_CULL_TEXT;
+    }
+    default:
+        return EMF_CULL_NONE;
+    }
+}
+
+/******************************************************************
+ *         EMF_GetRecordTable
+ *
+ * Returns the pre-decoded records of the metafile, building them on first use.
+ * The record sizes are validated once, and playback stops at the first
+ * invalid record.
+ */
+static const struct emf_record_table *EMF_GetRecordTable( HENHMETAFILE hmf )
+{
+    ENHMETAFILEOBJ *metaObj = GDI_GetObjPtr( hmf, OBJ_ENHMETAFILE );
+    struct emf_record_table *table;
+    const ENHMETAHEADER *emh;
+    const ENHMETARECORD *emr;
+    DWORD offset;
+    UINT count;
+
+    if (!metaObj) return NULL;
+    table = metaObj->records;
+    emh = metaObj->emh;
+    GDI_ReleaseObj( hmf );
+    if (table) return table;
+
+    for (count = 0, offset = 0; offset < emh->nBytes; count++, offset += emr->nSize)
+    {
+        emr = (const ENHMETARECORD *)((const char *)emh + offset);
+        if (emh->nBytes - offset < sizeof(EMR))
+        {
+            WARN( "truncated record at offset %u\n", offset );
+            break;
+        }
+        if (emr->nSize < sizeof(EMR) || (emr->nSize & 3) || emr->nSize > emh->nBytes - offset)
+        {
+            WARN( "invalid record %s size %u at offset %u\n",
+                  get_emr_name( emr->iType ), emr->nSize, offset );
+            break;
+        }
+    }
+
+    table = HeapAlloc( GetProcessHeap(), 0, FIELD_OFFSET( struct emf_record_table, records[count] ));
+    if (!table) return NULL;
+    table->count = count;
+
+    for (count = 0, offset = 0; count < table->count; count++, offset += emr->nSize)
+    {
+        emr = (const ENHMETARECORD *)((const char *)emh + offset);
+        table->records[count].offset = offset;
+        table->records[count].cull = EMF_GetRecordBounds( emr, &table->records[count].bounds );
+    }
+
+    if ((metaObj = GDI_GetObjPtr( hmf, OBJ_ENHMETAFILE )))
+    {
+        if (!metaObj->records) metaObj->records = table;
+        else
+        {
+            HeapFree( GetProcessHeap(), 0, table );
+            table = metaObj->records;
+        }
+        GDI_ReleaseObj( hmf );
+    }
+    else
+    {
+        HeapFree( GetProcessHeap(), 0, table );
+        table = NULL;
+    }
+    return table;
+}
+
 /*****************************************************************************
  *         EMF_GetEnhMetaFile
  *
@@ -517,8 +703,22 @@ typedef struct enum_emh_data
     EMF_dc_state state;
     INT save_level;
     EMF_dc_state *saved_state;
+    XFORM xform;        /* transform last set on the DC */
+    BOOL xform_valid;   /* whether the DC still uses it */
 } enum_emh_data;
 
+/* state needed to skip the records that are outside of the clip box */
+struct emf_cull_state
+{
+    RECT  clip;          /* clip box in device coordinates */
+    BOOL  in_path;       /* output goes to a path */
+    BOOL  update_cp;     /* text may update the current position */
+    INT   font_height;   /* height of the selected font, 0 if unknown */
+    INT  *font_heights;  /* fonts of the handle table, 0 if not a font, -1 if unknown;
+                          * NULL if records aren't culled */
+    UINT  handles;
+};
+
 #define ENUM_GET_PRIVATE_DATA(ht) \
     ((enum_emh_data*)(((unsigned char*)(ht))-sizeof (enum_emh_data)))
 
@@ -527,7 +727,7 @@ typedef struct enum_emh_data
 
 #define IS_WIN9X() (GetVersion()&0x80000000)
 
-static void EMF_Update_MF_Xform(HDC hdc, const enum_emh_data *info)
+static void EMF_Update_MF_Xform(HDC hdc, enum_emh_data *info)
 {
     XFORM mapping_mode_trans, final_trans;
     double scaleX, scaleY;
@@ -543,11 +743,167 @@ static void EMF_Update_MF_Xform(HDC hdc, const enum_emh_data *info)
 
     CombineTransform(&final_trans, &info->state.world_transform, &mapping_mode_trans);
     CombineTransform(&final_trans, &final_trans, &info->init_transform);
- 
+
+    /* most records don't change the transform */
+    if (info->xform_valid && !memcmp(&final_trans, &info->xform, sizeof(final_trans)))
+        return;
+
     if (!SetWorldTransform(hdc, &final_trans))
     {
         ERR("World transform failed!\n");
+        info->xform_valid = FALSE;
+        return;
     }
+    info->xform = final_trans;
+    info->xform_valid = TRUE;
+}
+
+/******************************************************************
+ *         EMF_GetDeviceClipBox
+ *
+ * Get the bounding box of the clip region of the DC in device coordinates.
+ */
+static BOOL EMF_GetDeviceClipBox( HDC hdc, RECT *clip )
+{
+    POINT pts[4];
+
+    if (GetClipBox( hdc, clip ) == ERROR) return FALSE;
+
+    pts[0].x = pts[2].x = clip->left;
+    pts[1].x = pts[3].x = clip->right;
+    pts[0].y = pts[1].y = clip->top;
+    pts[2].y = pts[3].y = clip->bottom;
+    LPtoDP( hdc, pts, 4 );
+    clip->left = min( min( pts[0].x, pts[1].x ), min( pts[2].x, pts[3].x ));
+    clip->right = max( max( pts[0].x, pts[1].x ), max( pts[2].x, pts[3].x ));
+    clip->top = min( min( pts[0].y, pts[1].y ), min( pts[2].y, pts[3].y ));
+    clip->bottom = max( max( pts[0].y, pts[1].y ), max( pts[2].y, pts[3].y ));
+    return TRUE;
+}
+
+/******************************************************************
+ *         EMF_UpdateCullState
+ *
+ * Track the state that the culling of records depends on, after the
+ * record has been played on hdc.
+ * Returns FALSE if records can't be culled anymore.
+ */
+static BOOL EMF_UpdateCullState( HDC hdc, struct emf_cull_state *cull, const ENHMETARECORD *emr )
+{
+    DWORD index;
+
+    switch (emr->iType)
+    {
+    case EMR_BEGINPATH:
+        cull->in_path = TRUE;
+        break;
+    case EMR_ENDPATH:
+    case EMR_ABORTPATH:
+        cull->in_path = FALSE;
+        break;
+    case EMR_SETTEXTALIGN:
+        if (((const EMRSETTEXTALIGN *)emr)->iMode & TA_UPDATECP) cull->update_cp = TRUE;
+        break;
+    case EMR_SETLAYOUT:
+        if (((const EMRSETLAYOUT *)emr)->iMode & LAYOUT_RTL) return FALSE;
+        break;
+    case EMR_RESTOREDC:
+        cull->font_height = 0;
+        /* fall through */
+    case EMR_EXTSELECTCLIPRGN:
+    case EMR_SELECTCLIPPATH:
+    case EMR_SETMETARGN:
+    case EMR_OFFSETCLIPRGN:
+        /* these may enlarge or move the clip region */
+        return EMF_GetDeviceClipBox( hdc, &cull->clip );
+    case EMR_EXTCREATEFONTINDIRECTW:
+    {
+        const EMREXTCREATEFONTINDIRECTW *font = (const EMREXTCREATEFONTINDIRECTW *)emr;
+
+        if (emr->nSize < FIELD_OFFSET(EMREXTCREATEFONTINDIRECTW, elfw.elfFullName) ||
+            font->ihFont >= cull->handles) break;
+        if (!font->elfw.elfLogFont.lfHeight || font->elfw.elfLogFont.lfEscapement ||
+            font->elfw.elfLogFont.lfOrientation)
+            cull->font_heights[font->ihFont] = -1;
+        else
+            cull->font_heights[font->ihFont] = abs( font->elfw.elfLogFont.lfHeight );
+        break;
+    }
+    case EMR_CREATEPEN:
+    case EMR_EXTCREATEPEN:
+    case EMR_CREATEBRUSHINDIRECT:
+    case EMR_CREATEMONOBRUSH:
+    case EMR_CREATEDIBPATTERNBRUSHPT:
+    case EMR_CREATEPALETTE:
+    case EMR_DELETEOBJECT:
+        /* the handle index follows the record header for all of these */
+        index = emr->dParm[0];
+        if (index < cull->handles) cull->font_heights[index] = 0;
+        break;
+    case EMR_SELECTOBJECT:
+        index = ((const EMRSELECTOBJECT *)emr)->ihObject;
+        if (index & 0x80000000)
+        {
+            index &= 0x7fffffff;
+            if ((index >= OEM_FIXED_FONT && index <= SYSTEM_FIXED_FONT) || index == DEFAULT_GUI_FONT)
+                cull->font_height = 0;
+        }
+        else if (index < cull->handles && cull->font_heights[index])
+            cull->font_height = max( cull->font_heights[index], 0 );
+        break;
+    }
+    return TRUE;
+}
+
+/******************************************************************
+ *         EMF_RecordVisible
+ *
+ * Check if the output of a record may intersect the clip box.
+ */
+static BOOL EMF_RecordVisible( const enum_emh_data *info, const struct emf_cull_state *cull,
+                               const struct emf_record *record )
+{
+    double left = record->bounds.left, top = record->bounds.top;
+    double right = record->bounds.right, bottom = record->bounds.bottom;
+    double x[4], y[4], min_x, max_x, min_y, max_y;
+    int i;
+
+    if (cull->in_path || !info->xform_valid) return TRUE;
+
+    /* text drawn at the current position moves it, even when it's not visible */
+    if ((record->cull == EMF_CULL_TEXT || record->cull == EMF_CULL_CLIPPED_TEXT) && cull->update_cp)
+        return TRUE;
+
+    if (record->cull == EMF_CULL_TEXT)
+    {
+        /* allow for any alignment and for overhanging glyphs */
+        if (!cull->font_height) return TRUE;
+        left -= cull->font_height;
+        right += cull->font_height;
+        top -= 2 * cull->font_height;
+        bottom += 2 * cull->font_height;
+    }
+
+    x[0] = x[2] = left;
+    x[1] = x[3] = right;
+    y[0] = y[1] = top;
+    y[2] = y[3] = bottom;
+    min_x = max_x = info->xform.eM11 * x[0] + info->xform.eM21 * y[0] + info->xform.eDx;
+    min_y = max_y = info->xform.eM12 * x[0] + info->xform.eM22 * y[0] + info->xform.eDy;
+    for (i = 1; i < 4; i++)
+    {
+        double dev_x = info->xform.eM11 * x[i] + info->xform.eM21 * y[i] + info->xform.eDx;
+        double dev_y = info->xform.eM12 * x[i] + info->xform.eM22 * y[i] + info->xform.eDy;
+
+        min_x = min( min_x, dev_x );
+        max_x = max( max_x, dev_x );
+        min_y = min( min_y, dev_y );
+        max_y = max( max_y, dev_y );
+    }
+
+    /* leave a pixel for rounding */
+    return max_x + 1 >= cull->clip.left && min_x - 1 < cull->clip.right &&
+           max_y + 1 >= cull->clip.top && min_y - 1 < cull->clip.bottom;
 }
 
 static void EMF_RestoreDC( enum_emh_data *info, INT level )
@@ -2210,51 +2566,20 @@ BOOL WINAPI PlayEnhMetaFileRecord(
 
 
 /*****************************************************************************
+ *        enum_enh_metafile
  *
- *        EnumEnhMetaFile  (GDI32.@)
- *
- *  Walk an enhanced metafile, calling a user-specified function _EnhMetaFunc_
- *  for each
- *  record. Returns when either every record has been used or
- *  when _EnhMetaFunc_ returns FALSE.
- *
- *
- * RETURNS
- *  TRUE if every record is used, FALSE if any invocation of _EnhMetaFunc_
- *  returns FALSE.
- *
- * BUGS
- *   Ignores rect.
- *
- * NOTES
- *   This function behaves differently in Win9x and WinNT.
- *
- *   In WinNT, the DC's world transform is updated as the EMF changes
- *    the Window/Viewport Extent and Origin or it's world transform.
- *    The actual Window/Viewport Extent and Origin are left untouched.
- *
- *   In Win9x, the DC is left untouched, and PlayEnhMetaFileRecord
- *    updates the scaling itself but only just before a record that
- *    writes anything to the DC.
- *
- *   I'm not sure where the data (enum_emh_data) is stored in either
- *    version. For this implementation, it is stored before the handle
- *    table, but it could be stored in the DC, in the EMF handle or in
- *    TLS.
- *             MJM  5 Oct 2002
+ * Implementation of EnumEnhMetaFile. When cull_records is set, the records
+ * whose output is known to be outside of the clip box are skipped; this is
+ * only done when playing the metafile ourselves.
  */
-BOOL WINAPI EnumEnhMetaFile(
-     HDC hdc,                /* [in] device context to pass to _EnhMetaFunc_ */
-     HENHMETAFILE hmf,       /* [in] EMF to walk */
-     ENHMFENUMPROC callback, /* [in] callback function */
-     LPVOID data,            /* [in] optional data for callback function */
-     const RECT *lpRect      /* [in] bounding rectangle for rendered metafile */
-    )
+static BOOL enum_enh_metafile( HDC hdc, HENHMETAFILE hmf, ENHMFENUMPROC callback,
+                               LPVOID data, const RECT *lpRect, BOOL cull_records )
 {
     BOOL ret;
     ENHMETAHEADER *emh;
     ENHMETARECORD *emr;
-    DWORD offset;
+    const struct emf_record_table *table;
+    struct emf_cull_state cull;
     UINT i;
     HANDLETABLE *ht;
     INT savedMode = 0;
@@ -2281,6 +2606,12 @@ BOOL WINAPI EnumEnhMetaFile(
         return FALSE;
     }
 
+    if (!(table = EMF_GetRecordTable(hmf)))
+    {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return FALSE;
+    }
+
     info = HeapAlloc( GetProcessHeap(), 0,
 		    sizeof (enum_emh_data) + sizeof(HANDLETABLE) * emh->nHandles );
     if(!info)
@@ -2288,6 +2619,8 @@ BOOL WINAPI EnumEnhMetaFile(
 	SetLastError(ERROR_NOT_ENOUGH_MEMORY);
 	return FALSE;
     }
+    info->xform_valid = FALSE;
+    memset( &cull, 0, sizeof(cull) );
     info->state.wndOrgX = 0;
     info->state.wndOrgY = 0;
     info->state.wndExtX = 1;
@@ -2309,6 +2642,14 @@ BOOL WINAPI EnumEnhMetaFile(
     for(i = 1; i < emh->nHandles; i++)
         ht->objectHandle[i] = NULL;
 
+    /* get the clip box in device coordinates before changing the mapping */
+    if (hdc && cull_records && !IS_WIN9X() && !(GetLayout(hdc) & LAYOUT_RTL) &&
+        (GetObjectType(hdc) == OBJ_DC || GetObjectType(hdc) == OBJ_MEMDC) &&
+        EMF_GetDeviceClipBox(hdc, &cull.clip) &&
+        (cull.font_heights = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY,
+                                        emh->nHandles * sizeof(*cull.font_heights) )))
+        cull.handles = emh->nHandles;
+
     if(hdc)
     {
 	savedMode = SetGraphicsMode(hdc, GM_ADVANCED);
@@ -2406,10 +2747,16 @@ BOOL WINAPI EnumEnhMetaFile(
     }
 
     ret = TRUE;
-    offset = 0;
-    while(ret && offset < emh->nBytes)
+    for (i = 0; ret && i < table->count; i++)
     {
-	emr = (ENHMETARECORD *)((char *)emh + offset);
+	emr = (ENHMETARECORD *)((char *)emh + table->records[i].offset);
+
+        if (cull.font_heights && table->records[i].cull != EMF_CULL_NONE &&
+            !EMF_RecordVisible(info, &cull, &table->records[i]))
+        {
+            TRACE("Skipping record %s outside of the clip box\n", get_emr_name(emr->iType));
+            continue;
+        }
 
         /* In Win9x mode we update the xform if the record will produce output */
         if (hdc && IS_WIN9X() && emr_produces_output(emr->iType))
@@ -2417,7 +2764,16 @@ BOOL WINAPI EnumEnhMetaFile(
 
 	TRACE("Calling EnumFunc with record %s, size %d\n", get_emr_name(emr->iType), emr->nSize);
 	ret = (*callback)(hdc, ht, emr, emh->nHandles, (LPARAM)data);
-	offset += emr->nSize;
+
+        /* the callback may have changed anything in the DC */
+        if (!cull_records || emr->iType == EMR_RESTOREDC)
+            info->xform_valid = FALSE;
+
+        if (cull.font_heights && !EMF_UpdateCullState(hdc, &cull, emr))
+        {
+            HeapFree( GetProcessHeap(), 0, cull.font_heights );
+            cull.font_heights = NULL;
+        }
 
         /* WinNT - update the transform (win9x updates when the next graphics
            output record is played). */
@@ -2462,10 +2818,56 @@ BOOL WINAPI EnumEnhMetaFile(
         info->saved_state = info->saved_state->next;
         HeapFree( GetProcessHeap(), 0, state );
     }
+    HeapFree( GetProcessHeap(), 0, cull.font_heights );
     HeapFree( GetProcessHeap(), 0, info );
     return ret;
 }
 
+/*****************************************************************************
+ *
+ *        EnumEnhMetaFile  (GDI32.@)
+ *
+ *  Walk an enhanced metafile, calling a user-specified function _EnhMetaFunc_
+ *  for each
+ *  record. Returns when either every record has been used or
+ *  when _EnhMetaFunc_ returns FALSE.
+ *
+ *
+ * RETURNS
+ *  TRUE if every record is used, FALSE if any invocation of _EnhMetaFunc_
+ *  returns FALSE.
+ *
+ * BUGS
+ *   Ignores rect.
+ *
+ * NOTES
+ *   This function behaves differently in Win9x and WinNT.
+ *
+ *   In WinNT, the DC's world transform is updated as the EMF changes
+ *    the Window/Viewport Extent and Origin or it's world transform.
+ *    The actual Window/Viewport Extent and Origin are left untouched.
+ *
+ *   In Win9x, the DC is left untouched, and PlayEnhMetaFileRecord
+ *    updates the scaling itself but only just before a record that
+ *    writes anything to the DC.
+ *
+ *   I'm not sure where the data (enum_emh_data) is stored in either
+ *    version. For this implementation, it is stored before the handle
+ *    table, but it could be stored in the DC, in the EMF handle or in
+ *    TLS.
+ *             MJM  5 Oct 2002
+ */
+BOOL WINAPI EnumEnhMetaFile(
+     HDC hdc,                /* [in] device context to pass to _EnhMetaFunc_ */
+     HENHMETAFILE hmf,       /* [in] EMF to walk */
+     ENHMFENUMPROC callback, /* [in] callback function */
+     LPVOID data,            /* [in] optional data for callback function */
+     const RECT *lpRect      /* [in] bounding rectangle for rendered metafile */
+    )
+{
+    return enum_enh_metafile( hdc, hmf, callback, data, lpRect, FALSE );
+}
+
 static INT CALLBACK EMF_PlayEnhMetaFileCallback(HDC hdc, HANDLETABLE *ht,
 						const ENHMETARECORD *emr,
 						INT handles, LPARAM data)
@@ -2489,8 +2891,8 @@ BOOL WINAPI PlayEnhMetaFile(
        const RECT *lpRect /* [in] rectangle to place metafile inside */
       )
 {
-    return EnumEnhMetaFile(hdc, hmf, EMF_PlayEnhMetaFileCallback, NULL,
-			   lpRect);
+    return enum_enh_metafile(hdc, hmf, EMF_PlayEnhMetaFileCallback, NULL,
+			     lpRect, TRUE);
 }
 
 /*****************************************************************************
@@ -24,6 +24,7 @@
 #include "config.h"
 #include "wine/port.h"
 
+#include <errno.h>
 #include <stdarg.h>
 #include <stdlib.h>
 #ifdef HAVE_SYS_STAT_H
@@ -191,6 +192,8 @@ static FT_Error (*pFT_Library_SetLcdFilter)(FT_Library, FT_LcdFilter);
 
 #ifdef SONAME_LIBFONTCONFIG
 #include <fontconfig/fontconfig.h>
+MAKE_FUNCPTR(FcConfigGetConfigFiles);
+MAKE_FUNCPTR(FcConfigGetFontDirs);
 MAKE_FUNCPTR(FcConfigSubstitute);
 MAKE_FUNCPTR(FcFontList);
 MAKE_FUNCPTR(FcFontSetDestroy);
@@ -203,6 +206,8 @@ MAKE_FUNCPTR(FcPatternDestroy);
 MAKE_FUNCPTR(FcPatternGetBool);
 MAKE_FUNCPTR(FcPatternGetInteger);
 MAKE_FUNCPTR(FcPatternGetString);
+MAKE_FUNCPTR(FcStrListDone);
+MAKE_FUNCPTR(FcStrListNext);
 #endif
 
 #undef MAKE_FUNCPTR
@@ -259,6 +264,7 @@ struct enum_data
 
 typedef struct tagFace {
     struct list entry;
+    struct list full_name_entry;  /* entry in the full name hash table */
     unsigned int refcount;
     WCHAR *StyleName;
     WCHAR *FullName;
@@ -288,6 +294,7 @@ typedef struct tagFace {
 
 typedef struct tagFamily {
     struct list entry;
+    struct list name_entry;       /* entry in the family name hash table */
     unsigned int refcount;
     WCHAR *FamilyName;
     WCHAR *EnglishName;
@@ -389,6 +396,15 @@ static struct list font_subst_list = LIST_INIT(font_subst_list);
 
 static struct list font_list = LIST_INIT(font_list);
 
+/* hash tables on family, full and substituted names; each bucket is kept in insertion order */
+#define NAME_HASH_SIZE 1024
+static struct list family_name_hash[NAME_HASH_SIZE];
+static struct list face_full_name_hash[NAME_HASH_SIZE];
+static struct list font_subst_hash[NAME_HASH_SIZE];
+
+/* incremented whenever the font list or the substitutes change */
+static DWORD font_list_generation = 1;
+
 struct freetype_physdev
 {
     struct gdi_physdev dev;
@@ -484,6 +500,7 @@ typedef struct {
 
 typedef struct tagFontSubst {
     struct list entry;
+    struct list hash_entry;
     NameCs from;
     NameCs to;
 } FontSubst;
@@ -954,6 +971,17 @@ static const struct list *get_face_list_from_family(const Family *family)
         return family->replacement;
 }
 
+static struct list *get_name_bucket( struct list *table, const WCHAR *name )
+{
+    struct list *bucket;
+    DWORD hash = 0;
+
+    while (*name) hash = hash * 31 + tolowerW( *name++ );
+    bucket = &table[hash % NAME_HASH_SIZE];
+    if (!bucket->next) list_init( bucket );
+    return bucket;
+}
+
 static Face *find_face_from_filename(const WCHAR *file_name, const WCHAR *face_name)
 {
     Family *family;
@@ -989,7 +1017,7 @@ static Family *find_family_from_name(const WCHAR *name)
 {
     Family *family;
 
-    LIST_FOR_EACH_ENTRY(family, &font_list, Family, entry)
+    LIST_FOR_EACH_ENTRY(family, get_name_bucket(family_name_hash, name), Family, name_entry)
     {
         if(!strcmpiW(family->FamilyName, name))
             return family;
@@ -1038,12 +1066,11 @@ static LPWSTR strdupW(LPCWSTR p)
     return ret;
 }
 
-static FontSubst *get_font_subst(const struct list *subst_list, const WCHAR *from_name,
-                                 INT from_charset)
+static FontSubst *get_font_subst(const WCHAR *from_name, INT from_charset)
 {
     FontSubst *element;
 
-    LIST_FOR_EACH_ENTRY(element, subst_list, FontSubst, entry)
+    LIST_FOR_EACH_ENTRY(element, get_name_bucket(font_subst_hash, from_name), FontSubst, hash_entry)
     {
         if(!strcmpiW(element->from.name, from_name) &&
            (element->from.charset == from_charset ||
@@ -1056,15 +1083,16 @@ static FontSubst *get_font_subst(const struct list *subst_list, const WCHAR *fro
 
 #define ADD_FONT_SUBST_FORCE  1
 
-static BOOL add_font_subst(struct list *subst_list, FontSubst *subst, INT flags)
+static BOOL add_font_subst(FontSubst *subst, INT flags)
 {
     FontSubst *from_exist, *to_exist;
 
-    from_exist = get_font_subst(subst_list, subst->from.name, subst->from.charset);
+    from_exist = get_font_subst(subst->from.name, subst->from.charset);
 
     if(from_exist && (flags & ADD_FONT_SUBST_FORCE))
     {
         list_remove(&from_exist->entry);
+        list_remove(&from_exist->hash_entry);
         HeapFree(GetProcessHeap(), 0, from_exist->from.name);
         HeapFree(GetProcessHeap(), 0, from_exist->to.name);
         HeapFree(GetProcessHeap(), 0, from_exist);
@@ -1073,7 +1101,7 @@ static BOOL add_font_subst(struct list *subst_list, FontSubst *subst, INT flags)
 
     if(!from_exist)
     {
-        to_exist = get_font_subst(subst_list, subst->to.name, subst->to.charset);
+        to_exist = get_font_subst(subst->to.name, subst->to.charset);
 
         if(to_exist)
         {
@@ -1081,7 +1109,9 @@ static BOOL add_font_subst(struct list *subst_list, FontSubst *subst, INT flags)
             subst->to.name = strdupW(to_exist->to.name);
         }
             
-        list_add_tail(subst_list, &subst->entry);
+        list_add_tail(&font_subst_list, &subst->entry);
+        list_add_tail(get_name_bucket(font_subst_hash, subst->from.name), &subst->hash_entry);
+        font_list_generation++;
 
         return TRUE;
     }
@@ -1160,7 +1190,7 @@ static void LoadSubstList(void)
 		HeapFree(GetProcessHeap(), 0, psub->from.name);
 		HeapFree(GetProcessHeap(), 0, psub);
 	    } else {
-	        add_font_subst(&font_subst_list, psub, 0);
+	        add_font_subst(psub, 0);
 	    }
 	    /* reset dlen and vlen */
 	    dlen = datalen;
@@ -1418,6 +1448,8 @@ static void release_family( Family *family )
     if (--family->refcount) return;
     assert( list_empty( &family->faces ));
     list_remove( &family->entry );
+    list_remove( &family->name_entry );
+    font_list_generation++;
     HeapFree( GetProcessHeap(), 0, family->FamilyName );
     HeapFree( GetProcessHeap(), 0, family->EnglishName );
     HeapFree( GetProcessHeap(), 0, family );
@@ -1430,6 +1462,8 @@ static void release_face( Face *face )
     {
         if (face->flags & ADDFONT_ADD_TO_CACHE) remove_face_from_cache( face );
         list_remove( &face->entry );
+        if (face->FullName) list_remove( &face->full_name_entry );
+        font_list_generation++;
         release_family( face->family );
     }
     HeapFree( GetProcessHeap(), 0, face->file );
@@ -1460,6 +1494,13 @@ static inline int style_order(const Face *face)
     }
 }
 
+static void add_face_to_hash( Face *face )
+{
+    if (face->FullName)
+        list_add_tail( get_name_bucket( face_full_name_hash, face->FullName ), &face->full_name_entry );
+    font_list_generation++;
+}
+
 static BOOL insert_face_in_family_list( Face *face, Family *family )
 {
     Face *cursor;
@@ -1490,6 +1531,7 @@ static BOOL insert_face_in_family_list( Face *face, Family *family )
                 TRACE("Replacing original %s with %s\n",
                       debugstr_w(cursor->file), debugstr_w(face->file));
                 list_add_before( &cursor->entry, &face->entry );
+                add_face_to_hash( face );
                 face->family = family;
                 family->refcount++;
                 face->refcount++;
@@ -1504,6 +1546,7 @@ static BOOL insert_face_in_family_list( Face *face, Family *family )
     }
 
     list_add_before( &cursor->entry, &face->entry );
+    add_face_to_hash( face );
     face->family = family;
     family->refcount++;
     face->refcount++;
@@ -1523,6 +1566,8 @@ static Family *create_family( WCHAR *name, WCHAR *english_name )
     list_init( &family->faces );
     family->replacement = &family->faces;
     list_add_tail( &font_list, &family->entry );
+    list_add_tail( get_name_bucket( family_name_hash, name ), &family->name_entry );
+    font_list_generation++;
 
     return family;
 }
@@ -1674,16 +1719,26 @@ static void load_font_list_from_cache(HKEY hkey_font_cache)
         if (!RegQueryValueExW(hkey_family, english_name_value, NULL, NULL, (BYTE *)buffer, &size))
             english_family = strdupW( buffer );
 
-        family = create_family(family_name, english_family);
-
-        if(english_family)
+        /* the family may already have been loaded from the font index */
+        if ((family = find_family_from_name(family_name)))
         {
-            FontSubst *subst = HeapAlloc(GetProcessHeap(), 0, sizeof(*subst));
-            subst->from.name = strdupW(english_family);
-            subst->from.charset = -1;
-            subst->to.name = strdupW(family_name);
-            subst->to.charset = -1;
-            add_font_subst(&font_subst_list, subst, 0);
+            family->refcount++;
+            HeapFree(GetProcessHeap(), 0, family_name);
+            HeapFree(GetProcessHeap(), 0, english_family);
+        }
+        else
+        {
+            family = create_family(family_name, english_family);
+
+            if(english_family)
+            {
+                FontSubst *subst = HeapAlloc(GetProcessHeap(), 0, sizeof(*subst));
+                subst->from.name = strdupW(english_family);
+                subst->from.charset = -1;
+                subst->to.name = strdupW(family_name);
+                subst->to.charset = -1;
+                add_font_subst(subst, 0);
+            }
         }
 
         size = sizeof(buffer);
@@ -1782,7 +1837,9 @@ static void remove_face_from_cache( Face *face )
 {
     HKEY hkey_family;
 
-    RegOpenKeyExW( hkey_font_cache, face->family->FamilyName, 0, KEY_ALL_ACCESS, &hkey_family );
+    /* faces loaded from the font index aren't in the registry */
+    if (RegOpenKeyExW( hkey_font_cache, face->family->FamilyName, 0, KEY_ALL_ACCESS, &hkey_family ))
+        return;
 
     if (face->scalable)
     {
@@ -1799,6 +1856,560 @@ static void remove_face_from_cache( Face *face )
     RegCloseKey(hkey_family);
 }
 
+/* The faces found when scanning the font directories are stored in a binary
+ * index in the prefix, which is mapped by the following processes instead of
+ * opening all the font files again. The index records the state of every
+ * scanned directory, every font file and the fontconfig configuration, as
+ * well as the font registry entries, and is rebuilt when any of them changes. */
+
+#define FONT_INDEX_MAGIC    0x58444946  /* 'FIDX' */
+#define FONT_INDEX_VERSION  2
+
+struct font_index_header
+{
+    DWORD magic;
+    DWORD version;
+    DWORD size;          /* size of the whole index */
+    DWORD path_count;
+    DWORD paths;         /* offset of the font_index_path array */
+    DWORD registry_size;
+    DWORD registry;      /* offset of the font registry state */
+    DWORD family_count;
+    DWORD families;      /* offset of the font_index_family array */
+};
+
+struct font_index_path
+{
+    DWORD name;          /* offset of the unix path */
+    DWORD stamp[6];      /* mtime, size and inode, all 0 if the path doesn't exist */
+};
+
+struct font_index_family
+{
+    DWORD name;          /* offsets of the names, 0 if not present */
+    DWORD english_name;
+    DWORD face_count;
+    DWORD faces;         /* offset of the font_index_face array */
+};
+
+struct font_index_face
+{
+    DWORD         style_name;
+    DWORD         full_name;
+    DWORD         file;
+    DWORD         face_index;
+    DWORD         ntm_flags;
+    DWORD         version;
+    DWORD         flags;
+    DWORD         scalable;
+    FONTSIGNATURE fs;
+    INT           height;
+    INT           width;
+    INT           size;
+    INT           x_ppem;
+    INT           y_ppem;
+    INT           internal_leading;
+};
+
+struct index_buffer
+{
+    BYTE *data;
+    DWORD size;
+    DWORD len;
+};
+
+struct scanned_path
+{
+    char *name;
+    DWORD stamp[6];
+};
+
+static BOOL building_font_index;
+static struct scanned_path *scanned_paths;
+static unsigned int scanned_path_count, scanned_path_size;
+static int last_scanned_dir = -1;
+static struct index_buffer font_registry_state;
+
+static char *get_font_index_path( const char *suffix )
+{
+    const char *config_dir = wine_get_config_dir();
+    char *path = HeapAlloc( GetProcessHeap(), 0, strlen(config_dir) + sizeof("/fontindex") + strlen(suffix) );
+
+    if (path)
+    {
+        strcpy( path, config_dir );
+        strcat( path, "/fontindex" );
+        strcat( path, suffix );
+    }
+    return path;
+}
+
+static void delete_font_index(void)
+{
+    char *path = get_font_index_path( "" );
+
+    if (path && unlink( path ) == -1 && errno != ENOENT)
+        WARN( "failed to delete the font index %s\n", debugstr_a(path) );
+    HeapFree( GetProcessHeap(), 0, path );
+}
+
+static void get_path_stamp( const char *name, DWORD stamp[6] )
+{
+    struct stat st;
+
+    memset( stamp, 0, 6 * sizeof(DWORD) );
+    if (stat( name, &st )) return;
+    stamp[0] = (ULONGLONG)st.st_mtime;
+    stamp[1] = (ULONGLONG)st.st_mtime >> 32;
+    stamp[2] = (ULONGLONG)st.st_size;
+    stamp[3] = (ULONGLONG)st.st_size >> 32;
+    stamp[4] = (ULONGLONG)st.st_ino;
+    stamp[5] = (ULONGLONG)st.st_ino >> 32;
+}
+
+/* remember a path whose contents end up in the index, returns its position in the list */
+static int add_scanned_path( const char *name, int len )
+{
+    struct scanned_path *paths;
+    unsigned int i;
+
+    if (!building_font_index) return -1;
+    /* most lookups are for the last file or directory */
+    if (last_scanned_dir != -1 && !strncmp( scanned_paths[last_scanned_dir].name, name, len ) &&
+        !scanned_paths[last_scanned_dir].name[len])
+        return last_scanned_dir;
+    for (i = scanned_path_count; i > 0; i--)
+        if (!strncmp( scanned_paths[i - 1].name, name, len ) && !scanned_paths[i - 1].name[len]) return i - 1;
+
+    if (scanned_path_count == scanned_path_size)
+    {
+        unsigned int size = max( 16, scanned_path_size * 2 );
+        if (scanned_paths) paths = HeapReAlloc( GetProcessHeap(), 0, scanned_paths, size * sizeof(*paths) );
+        else paths = HeapAlloc( GetProcessHeap(), 0, size * sizeof(*paths) );
+        if (!paths) return -1;
+        scanned_paths = paths;
+        scanned_path_size = size;
+    }
+    if (!(scanned_paths[i = scanned_path_count].name = HeapAlloc( GetProcessHeap(), 0, len + 1 ))) return -1;
+    memcpy( scanned_paths[i].name, name, len );
+    scanned_paths[i].name[len] = 0;
+    get_path_stamp( scanned_paths[i].name, scanned_paths[i].stamp );
+    return scanned_path_count++;
+}
+
+static void add_scanned_dir( const char *name, int len )
+{
+    int i = add_scanned_path( name, len );
+
+    if (i != -1) last_scanned_dir = i;
+}
+
+/* files are recorded along with their directory, to notice both changes and additions */
+static void add_scanned_file( const char *file )
+{
+    const char *p = strrchr( file, '/' );
+
+    if (p) add_scanned_dir( file, p - file );
+    add_scanned_path( file, strlen(file) );
+}
+
+static void free_font_index_state(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < scanned_path_count; i++) HeapFree( GetProcessHeap(), 0, scanned_paths[i].name );
+    HeapFree( GetProcessHeap(), 0, scanned_paths );
+    scanned_paths = NULL;
+    scanned_path_count = scanned_path_size = 0;
+    last_scanned_dir = -1;
+    HeapFree( GetProcessHeap(), 0, font_registry_state.data );
+    font_registry_state.data = NULL;
+}
+
+static const void *get_index_data( const BYTE *data, DWORD size, DWORD offset, DWORD count, DWORD len )
+{
+    if (offset % sizeof(DWORD) || offset > size || count > (size - offset) / len) return NULL;
+    return data + offset;
+}
+
+static const WCHAR *get_index_string( const BYTE *data, DWORD size, DWORD offset )
+{
+    const WCHAR *str, *end, *p;
+
+    if (!offset || offset % sizeof(WCHAR) || offset >= size) return NULL;
+    str = (const WCHAR *)(data + offset);
+    end = (const WCHAR *)(data + (size & ~1));
+    for (p = str; p < end; p++) if (!*p) return str;
+    return NULL;
+}
+
+static const char *get_index_stringA( const BYTE *data, DWORD size, DWORD offset )
+{
+    if (!offset || offset >= size || !memchr( data + offset, 0, size - offset )) return NULL;
+    return (const char *)(data + offset);
+}
+
+/* check the whole index before adding anything to the font list */
+static BOOL validate_font_index( const BYTE *data, DWORD size, BOOL check_paths )
+{
+    const struct font_index_header *header = (const struct font_index_header *)data;
+    const struct font_index_path *paths;
+    const struct font_index_family *families;
+    const struct font_index_face *faces;
+    const BYTE *registry;
+    const char *name;
+    DWORD i, j, stamp[6];
+
+    if (size < sizeof(*header) || header->magic != FONT_INDEX_MAGIC ||
+        header->version != FONT_INDEX_VERSION || header->size != size)
+        return FALSE;
+    if (!(paths = get_index_data( data, size, header->paths, header->path_count, sizeof(*paths) )) ||
+        !(registry = get_index_data( data, size, header->registry, header->registry_size, 1 )) ||
+        !(families = get_index_data( data, size, header->families, header->family_count, sizeof(*families) )))
+        return FALSE;
+
+    if (check_paths && (!font_registry_state.data ||
+                        header->registry_size != font_registry_state.len ||
+                        memcmp( registry, font_registry_state.data, header->registry_size )))
+    {
+        TRACE( "font registry entries changed, rebuilding the font index\n" );
+        return FALSE;
+    }
+    for (i = 0; i < header->path_count; i++)
+    {
+        if (!(name = get_index_stringA( data, size, paths[i].name ))) return FALSE;
+        if (!check_paths) continue;
+        get_path_stamp( name, stamp );
+        if (memcmp( stamp, paths[i].stamp, sizeof(stamp) ))
+        {
+            TRACE( "%s changed, rebuilding the font index\n", debugstr_a(name) );
+            return FALSE;
+        }
+    }
+    for (i = 0; i < header->family_count; i++)
+    {
+        if (!get_index_string( data, size, families[i].name )) return FALSE;
+        if (families[i].english_name && !get_index_string( data, size, families[i].english_name ))
+            return FALSE;
+        if (!(faces = get_index_data( data, size, families[i].faces, families[i].face_count, sizeof(*faces) )))
+            return FALSE;
+        for (j = 0; j < families[i].face_count; j++)
+        {
+            if (!get_index_string( data, size, faces[j].style_name ) ||
+                !get_index_string( data, size, faces[j].file ))
+                return FALSE;
+            if (faces[j].full_name && !get_index_string( data, size, faces[j].full_name ))
+                return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static BOOL load_font_index( BOOL check_paths )
+{
+    const struct font_index_header *header;
+    const struct font_index_family *families;
+    const struct font_index_face *faces;
+    const BYTE *data;
+    struct stat st;
+    Family *family;
+    Face *face;
+    char *path;
+    DWORD i, j;
+    int fd;
+
+    if (!(path = get_font_index_path( "" ))) return FALSE;
+    fd = open( path, O_RDONLY );
+    HeapFree( GetProcessHeap(), 0, path );
+    if (fd == -1) return FALSE;
+    if (fstat( fd, &st ) == -1 || !st.st_size || st.st_size > 0x7fffffff)
+    {
+        close( fd );
+        return FALSE;
+    }
+    data = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if (data == MAP_FAILED) return FALSE;
+
+    if (!validate_font_index( data, st.st_size, check_paths ))
+    {
+        munmap( (void *)data, st.st_size );
+        return FALSE;
+    }
+
+    header = (const struct font_index_header *)data;
+    families = (const struct font_index_family *)(data + header->families);
+    for (i = 0; i < header->family_count; i++)
+    {
+        WCHAR *english_name = NULL;
+
+        if (families[i].english_name)
+            english_name = strdupW( (const WCHAR *)(data + families[i].english_name) );
+        family = create_family( strdupW( (const WCHAR *)(data + families[i].name) ), english_name );
+        if (english_name)
+        {
+            FontSubst *subst = HeapAlloc( GetProcessHeap(), 0, sizeof(*subst) );
+            subst->from.name = strdupW( english_name );
+            subst->from.charset = -1;
+            subst->to.name = strdupW( family->FamilyName );
+            subst->to.charset = -1;
+            add_font_subst( subst, 0 );
+        }
+
+        faces = (const struct font_index_face *)(data + families[i].faces);
+        for (j = 0; j < families[i].face_count; j++)
+        {
+            face = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*face) );
+            face->refcount = 1;
+            face->StyleName = strdupW( (const WCHAR *)(data + faces[j].style_name) );
+            face->file = strdupW( (const WCHAR *)(data + faces[j].file) );
+            if (faces[j].full_name) face->FullName = strdupW( (const WCHAR *)(data + faces[j].full_name) );
+            face->face_index = faces[j].face_index;
+            face->ntmFlags = faces[j].ntm_flags;
+            face->font_version = faces[j].version;
+            face->flags = faces[j].flags;
+            face->fs = faces[j].fs;
+            face->scalable = faces[j].scalable;
+            face->size.height = faces[j].height;
+            face->size.width = faces[j].width;
+            face->size.size = faces[j].size;
+            face->size.x_ppem = faces[j].x_ppem;
+            face->size.y_ppem = faces[j].y_ppem;
+            face->size.internal_leading = faces[j].internal_leading;
+
+            if (insert_face_in_family_list( face, family ))
+                TRACE( "Added font %s %s\n", debugstr_w(family->FamilyName), debugstr_w(face->StyleName) );
+            release_face( face );
+        }
+        release_family( family );
+    }
+
+    TRACE( "loaded %u families from the font index\n", header->family_count );
+    munmap( (void *)data, st.st_size );
+    return TRUE;
+}
+
+/* append data to the index, returns its offset or 0 on failure */
+static DWORD index_append( struct index_buffer *buf, const void *data, DWORD len )
+{
+    DWORD offset = buf->len;
+
+    if (!buf->data) return 0;
+    if (offset + len + sizeof(DWORD) > buf->size)
+    {
+        DWORD size = max( buf->size * 2, offset + len + sizeof(DWORD) );
+        BYTE *new_data = HeapReAlloc( GetProcessHeap(), 0, buf->data, size );
+
+        if (!new_data)
+        {
+            HeapFree( GetProcessHeap(), 0, buf->data );
+            buf->data = NULL;
+            return 0;
+        }
+        buf->data = new_data;
+        buf->size = size;
+    }
+    if (data) memcpy( buf->data + offset, data, len );
+    else memset( buf->data + offset, 0, len );
+    buf->len = (offset + len + sizeof(DWORD) - 1) & ~(sizeof(DWORD) - 1);
+    memset( buf->data + offset + len, 0, buf->len - offset - len );
+    return offset;
+}
+
+static DWORD index_append_string( struct index_buffer *buf, const WCHAR *str )
+{
+    if (!str) return 0;
+    return index_append( buf, str, (strlenW(str) + 1) * sizeof(WCHAR) );
+}
+
+/* store the registry entries that decide which fonts are loaded, to notice when they change */
+static void get_font_registry_state(void)
+{
+    static const WCHAR pathW[] = {'P','a','t','h',0};
+    struct index_buffer *buf = &font_registry_state;
+    DWORD i = 0, type, valuelen, datalen, vlen, dlen;
+    WCHAR *valueW;
+    BYTE *data;
+    HKEY hkey;
+
+    buf->size = 0x1000;
+    buf->len = 0;
+    if (!(buf->data = HeapAlloc( GetProcessHeap(), 0, buf->size ))) return;
+
+    if (!RegOpenKeyW( HKEY_LOCAL_MACHINE, is_win9x() ? win9x_font_reg_key : winnt_font_reg_key, &hkey ))
+    {
+        RegQueryInfoKeyW( hkey, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &valuelen, &datalen, NULL, NULL );
+        valuelen++;
+        valueW = HeapAlloc( GetProcessHeap(), 0, valuelen * sizeof(WCHAR) );
+        data = HeapAlloc( GetProcessHeap(), 0, datalen );
+        if (valueW && data)
+        {
+            vlen = valuelen;
+            dlen = datalen;
+            while (!RegEnumValueW( hkey, i++, valueW, &vlen, NULL, &type, data, &dlen ))
+            {
+                index_append( buf, valueW, (vlen + 1) * sizeof(WCHAR) );
+                index_append( buf, &type, sizeof(type) );
+                index_append( buf, &dlen, sizeof(dlen) );
+                index_append( buf, data, dlen );
+                vlen = valuelen;
+                dlen = datalen;
+            }
+        }
+        else
+        {
+            HeapFree( GetProcessHeap(), 0, buf->data );
+            buf->data = NULL;
+        }
+        HeapFree( GetProcessHeap(), 0, data );
+        HeapFree( GetProcessHeap(), 0, valueW );
+        RegCloseKey( hkey );
+    }
+    index_append( buf, NULL, sizeof(DWORD) );  /* separator */
+
+    if (!RegOpenKeyA( HKEY_CURRENT_USER, "Software\\Wine\\Fonts", &hkey ))
+    {
+        if (!RegQueryValueExW( hkey, pathW, NULL, &type, NULL, &dlen ) &&
+            (data = HeapAlloc( GetProcessHeap(), 0, dlen )))
+        {
+            if (!RegQueryValueExW( hkey, pathW, NULL, &type, data, &dlen ))
+            {
+                index_append( buf, &type, sizeof(type) );
+                index_append( buf, data, dlen );
+            }
+            HeapFree( GetProcessHeap(), 0, data );
+        }
+        RegCloseKey( hkey );
+    }
+}
+
+static BOOL build_font_index( struct index_buffer *buf )
+{
+    struct font_index_header *header;
+    struct font_index_family *index_family;
+    struct font_index_face *index_face;
+    DWORD i, families, family_count = 0, faces, face_count, name, english_name;
+    DWORD style_name, full_name, file, registry;
+    Family *family;
+    Face *face;
+
+    if (!font_registry_state.data) return FALSE;
+
+    buf->size = 0x10000;
+    buf->len = 0;
+    if (!(buf->data = HeapAlloc( GetProcessHeap(), 0, buf->size ))) return FALSE;
+
+    index_append( buf, NULL, sizeof(*header) );
+    i = index_append( buf, NULL, scanned_path_count * sizeof(struct font_index_path) );
+    registry = index_append( buf, font_registry_state.data, font_registry_state.len );
+    if (!buf->data) return FALSE;
+    header = (struct font_index_header *)buf->data;
+    header->magic = FONT_INDEX_MAGIC;
+    header->version = FONT_INDEX_VERSION;
+    header->path_count = scanned_path_count;
+    header->paths = i;
+    header->registry_size = font_registry_state.len;
+    header->registry = registry;
+    for (i = 0; i < scanned_path_count; i++)
+    {
+        struct font_index_path *path;
+
+        name = index_append( buf, scanned_paths[i].name, strlen(scanned_paths[i].name) + 1 );
+        if (!buf->data) return FALSE;
+        header = (struct font_index_header *)buf->data;
+        path = (struct font_index_path *)(buf->data + header->paths) + i;
+        path->name = name;
+        memcpy( path->stamp, scanned_paths[i].stamp, sizeof(path->stamp) );
+    }
+
+    LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry ) family_count++;
+    families = index_append( buf, NULL, family_count * sizeof(*index_family) );
+    family_count = 0;
+
+    LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry )
+    {
+        face_count = 0;
+        LIST_FOR_EACH_ENTRY( face, &family->faces, Face, entry )
+            if ((face->flags & ADDFONT_ADD_TO_CACHE) && face->file) face_count++;
+        if (!face_count) continue;
+
+        name = index_append_string( buf, family->FamilyName );
+        english_name = index_append_string( buf, family->EnglishName );
+        faces = index_append( buf, NULL, face_count * sizeof(*index_face) );
+        face_count = 0;
+
+        LIST_FOR_EACH_ENTRY( face, &family->faces, Face, entry )
+        {
+            if (!(face->flags & ADDFONT_ADD_TO_CACHE) || !face->file) continue;
+            style_name = index_append_string( buf, face->StyleName );
+            full_name = index_append_string( buf, face->FullName );
+            file = index_append_string( buf, face->file );
+            if (!buf->data) return FALSE;
+
+            index_face = (struct font_index_face *)(buf->data + faces) + face_count++;
+            index_face->style_name = style_name;
+            index_face->full_name = full_name;
+            index_face->file = file;
+            index_face->face_index = face->face_index;
+            index_face->ntm_flags = face->ntmFlags;
+            index_face->version = face->font_version;
+            index_face->flags = face->flags;
+            index_face->scalable = face->scalable;
+            index_face->fs = face->fs;
+            index_face->height = face->size.height;
+            index_face->width = face->size.width;
+            index_face->size = face->size.size;
+            index_face->x_ppem = face->size.x_ppem;
+            index_face->y_ppem = face->size.y_ppem;
+            index_face->internal_leading = face->size.internal_leading;
+        }
+        if (!buf->data) return FALSE;
+
+        index_family = (struct font_index_family *)(buf->data + families) + family_count++;
+        index_family->name = name;
+        index_family->english_name = english_name;
+        index_family->face_count = face_count;
+        index_family->faces = faces;
+    }
+    if (!buf->data) return FALSE;
+
+    header = (struct font_index_header *)buf->data;
+    header->family_count = family_count;
+    header->families = families;
+    header->size = buf->len;
+    return TRUE;
+}
+
+static BOOL save_font_index(void)
+{
+    struct index_buffer buf;
+    char *path, *tmp_path;
+    BOOL ret = FALSE;
+    DWORD pos = 0;
+    int fd, len;
+
+    if (!build_font_index( &buf )) return FALSE;
+    path = get_font_index_path( "" );
+    tmp_path = get_font_index_path( ".tmp" );
+    if (path && tmp_path && (fd = open( tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0666 )) != -1)
+    {
+        while (pos < buf.len && (len = write( fd, buf.data + pos, buf.len - pos )) > 0) pos += len;
+        close( fd );
+        /* rename is atomic, a concurrent reader sees either the old or the new index */
+        if (pos == buf.len && !rename( tmp_path, path )) ret = TRUE;
+        else unlink( tmp_path );
+    }
+    if (!ret)
+    {
+        WARN( "failed to save the font index to %s\n", debugstr_a(path) );
+        if (path) unlink( path );
+    }
+    HeapFree( GetProcessHeap(), 0, tmp_path );
+    HeapFree( GetProcessHeap(), 0, path );
+    HeapFree( GetProcessHeap(), 0, buf.data );
+    return ret;
+}
+
 static WCHAR *prepend_at(WCHAR *family)
 {
     WCHAR *str;
@@ -1856,7 +2467,7 @@ static Family *get_family( FT_Face ft_face, BOOL vertical )
             subst->from.charset = -1;
             subst->to.name = strdupW( name );
             subst->to.charset = -1;
-            add_font_subst( &font_subst_list, subst, 0 );
+            add_font_subst( subst, 0 );
         }
     }
     else
@@ -2056,7 +2667,10 @@ static void AddFaceToList(FT_Face ft_face, const char *file, void *font_data_ptr
     if (insert_face_in_family_list( face, family ))
     {
         if (flags & ADDFONT_ADD_TO_CACHE)
-            add_face_to_cache( face );
+        {
+            if (building_font_index) add_scanned_file( file );
+            else add_face_to_cache( face );
+        }
 
         TRACE("Added font %s %s\n", debugstr_w(family->FamilyName),
               debugstr_w(face->StyleName));
@@ -2291,6 +2905,8 @@ static void LoadReplaceList(void)
                         list_init(&new_family->faces);
                         new_family->replacement = &family->faces;
                         list_add_tail(&font_list, &new_family->entry);
+                        list_add_tail(get_name_bucket(family_name_hash, value), &new_family->name_entry);
+                        font_list_generation++;
                     }
                 }
                 else
@@ -2379,7 +2995,7 @@ static void populate_system_links(const WCHAR *name, const WCHAR *const *values)
     {
         SYSTEM_LINKS *font_link;
 
-        psub = get_font_subst(&font_subst_list, name, -1);
+        psub = get_font_subst(name, -1);
         /* Don't store fonts that are only substitutes for other fonts */
         if(psub)
         {
@@ -2405,7 +3021,7 @@ static void populate_system_links(const WCHAR *name, const WCHAR *const *values)
             value = values[i];
             if (!strcmpiW(name,value))
                 continue;
-            psub = get_font_subst(&font_subst_list, value, -1);
+            psub = get_font_subst(value, -1);
             if(psub)
                 value = psub->to.name;
             family = find_family_from_name(value);
@@ -2478,7 +3094,7 @@ static BOOL init_system_links(void)
         index = 0;
         while(RegEnumValueW(hkey, index++, value, &val_len, NULL, &type, (LPBYTE)data, &data_len) == ERROR_SUCCESS)
         {
-            psub = get_font_subst(&font_subst_list, value, -1);
+            psub = get_font_subst(value, -1);
             /* Don't store fonts that are only substitutes for other fonts */
             if(psub)
             {
@@ -2505,7 +3121,7 @@ static BOOL init_system_links(void)
                     while(isspaceW(*face_name))
                         face_name++;
 
-                    psub = get_font_subst(&font_subst_list, face_name, -1);
+                    psub = get_font_subst(face_name, -1);
                     if(psub)
                         face_name = psub->to.name;
                 }
@@ -2537,7 +3153,7 @@ static BOOL init_system_links(void)
     }
 
 
-    psub = get_font_subst(&font_subst_list, MS_Shell_Dlg, -1);
+    psub = get_font_subst(MS_Shell_Dlg, -1);
     if (!psub) {
         WARN("could not find FontSubstitute for MS Shell Dlg\n");
         goto skip_internal;
@@ -2546,7 +3162,7 @@ static BOOL init_system_links(void)
     for (i = 0; i < sizeof(font_links_defaults_list)/sizeof(font_links_defaults_list[0]); i++)
     {
         const FontSubst *psub2;
-        psub2 = get_font_subst(&font_subst_list, font_links_defaults_list[i].shelldlg, -1);
+        psub2 = get_font_subst(font_links_defaults_list[i].shelldlg, -1);
 
         if ((!strcmpiW(font_links_defaults_list[i].shelldlg, psub->to.name) || (psub2 && !strcmpiW(psub2->to.name,psub->to.name))))
         {
@@ -2612,6 +3228,7 @@ static BOOL ReadFontDir(const char *dirname, BOOL external_fonts)
 
     TRACE("Loading fonts from %s\n", debugstr_a(dirname));
 
+    add_scanned_dir(dirname, strlen(dirname));
     dir = opendir(dirname);
     if(!dir) {
         WARN("Can't open directory %s\n", debugstr_a(dirname));
@@ -2683,6 +3300,8 @@ static void init_fontconfig(void)
     }
 
 #define LOAD_FUNCPTR(f) if((p##f = wine_dlsym(fc_handle, #f, NULL, 0)) == NULL){WARN("Can't find symbol %s\n", #f); return;}
+    LOAD_FUNCPTR(FcConfigGetConfigFiles);
+    LOAD_FUNCPTR(FcConfigGetFontDirs);
     LOAD_FUNCPTR(FcConfigSubstitute);
     LOAD_FUNCPTR(FcFontList);
     LOAD_FUNCPTR(FcFontSetDestroy);
@@ -2695,6 +3314,8 @@ static void init_fontconfig(void)
     LOAD_FUNCPTR(FcPatternGetBool);
     LOAD_FUNCPTR(FcPatternGetInteger);
     LOAD_FUNCPTR(FcPatternGetString);
+    LOAD_FUNCPTR(FcStrListDone);
+    LOAD_FUNCPTR(FcStrListNext);
 #undef LOAD_FUNCPTR
 
     if (pFcInit())
@@ -2708,6 +3329,20 @@ static void init_fontconfig(void)
     }
 }
 
+/* record the font directories and configuration files, which decide what FcFontList returns */
+static void add_fontconfig_paths( FcStrList *list, BOOL dirs )
+{
+    FcChar8 *str;
+
+    if (!list) return;
+    while ((str = pFcStrListNext( list )))
+    {
+        if (dirs) add_scanned_dir( (const char *)str, strlen( (const char *)str ) );
+        else add_scanned_file( (const char *)str );
+    }
+    pFcStrListDone( list );
+}
+
 static void load_fontconfig_fonts(void)
 {
     FcPattern *pat;
@@ -2759,6 +3394,12 @@ static void load_fontconfig_fonts(void)
     pFcFontSetDestroy(fontset);
     pFcObjectSetDestroy(os);
     pFcPatternDestroy(pat);
+
+    if (building_font_index)
+    {
+        add_fontconfig_paths( pFcConfigGetFontDirs( NULL ), TRUE );
+        add_fontconfig_paths( pFcConfigGetConfigFiles( NULL ), FALSE );
+    }
 }
 
 #elif defined(HAVE_CARBON_CARBON_H)
@@ -3964,6 +4605,16 @@ static void init_font_list(void)
 
     delete_external_font_keys();
 
+    get_font_registry_state();
+    if (load_font_index(TRUE))
+    {
+        free_font_index_state();
+        return;
+    }
+    /* don't let any other process use a stale index, even if it can't be rebuilt */
+    delete_font_index();
+    building_font_index = TRUE;
+
     /* load the system bitmap fonts */
     load_system_fonts();
 
@@ -4090,6 +4741,19 @@ static void init_font_list(void)
         }
         RegCloseKey(hkey);
     }
+
+    building_font_index = FALSE;
+    if (!save_font_index())
+    {
+        /* fall back to the registry cache */
+        Family *family;
+        Face *face;
+
+        LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry )
+            LIST_FOR_EACH_ENTRY( face, &family->faces, Face, entry )
+                if (face->flags & ADDFONT_ADD_TO_CACHE) add_face_to_cache( face );
+    }
+    free_font_index_state();
 }
 
 static BOOL move_to_front(const WCHAR *name)
@@ -4156,7 +4820,12 @@ BOOL WineEngInit(void)
     if(disposition == REG_CREATED_NEW_KEY)
         init_font_list();
     else
+    {
+        /* the first process has already checked the index, the registry
+           holds the fonts added since then */
+        load_font_index(FALSE);
         load_font_list_from_cache(hkey_font_cache);
+    }
 
     reorder_font_list();
 
@@ -4701,7 +5370,7 @@ static BOOL create_child_font_list(GdiFont *font)
     FontSubst *psub;
     WCHAR* font_name;
 
-    psub = get_font_subst(&font_subst_list, font->name, -1);
+    psub = get_font_subst(font->name, -1);
     font_name = psub ? psub->to.name : font->name;
     font_link = find_font_link(font_name);
     if (font_link != NULL)
@@ -5021,6 +5690,131 @@ static const VOID * get_GSUB_vert_feature(const GdiFont *font)
     return feature;
 }
 
+/* same test as the family name search in freetype_SelectFont */
+static BOOL family_has_charset( const Family *family, const CHARSETINFO *csi, BOOL can_use_bitmap )
+{
+    const SYSTEM_LINKS *font_link = find_font_link( family->FamilyName );
+    const struct list *face_list = get_face_list_from_family( family );
+    const Face *face;
+
+    LIST_FOR_EACH_ENTRY( face, face_list, Face, entry )
+    {
+        if (!(face->scalable || can_use_bitmap))
+            continue;
+        if (csi->fs.fsCsb[0] & face->fs.fsCsb[0])
+            return TRUE;
+        if (font_link != NULL && csi->fs.fsCsb[0] & font_link->fs.fsCsb[0])
+            return TRUE;
+        if (!csi->fs.fsCsb[0])
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static BOOL family_precedes( const Family *family, const Family *other )
+{
+    const struct list *ptr;
+
+    for (ptr = list_next( &font_list, &family->entry ); ptr; ptr = list_next( &font_list, ptr ))
+        if (ptr == &other->entry) return TRUE;
+    return FALSE;
+}
+
+static BOOL family_is_scalable( const Family *family )
+{
+    const Face *face;
+
+    LIST_FOR_EACH_ENTRY( face, get_face_list_from_family( family ), Face, entry )
+        if (!face->scalable) return FALSE;
+    return TRUE;
+}
+
+/* Search by full face name. Returns FALSE when the result depends on the
+ * order of the font list, and the whole list has to be searched instead. */
+static BOOL find_face_from_full_name( const WCHAR *name, const CHARSETINFO *csi, BOOL can_use_bitmap,
+                                      Face **ret )
+{
+    const SYSTEM_LINKS *font_link;
+    Face *face, *found = NULL;
+
+    *ret = NULL;
+    LIST_FOR_EACH_ENTRY( face, get_name_bucket( face_full_name_hash, name ), Face, full_name_entry )
+    {
+        if (strcmpiW( face->FullName, name )) continue;
+        if (found) return FALSE;
+        found = face;
+    }
+    if (!found || !(found->scalable || can_use_bitmap)) return TRUE;
+
+    if (csi->fs.fsCsb[0] & found->fs.fsCsb[0] || !csi->fs.fsCsb[0])
+    {
+        *ret = found;
+        return TRUE;
+    }
+    font_link = find_font_link( found->family->FamilyName );
+    if (font_link != NULL && csi->fs.fsCsb[0] & font_link->fs.fsCsb[0])
+    {
+        *ret = found;
+        return TRUE;
+    }
+    return FALSE;  /* it may still match through a replacement family */
+}
+
+/* Faces recently chosen for a logfont, so that fonts differing only in size
+ * don't have to be looked up again. Only families without bitmap faces are
+ * cached since the height is not part of the key. */
+#define FONT_MATCH_CACHE_SIZE 256
+
+struct font_match
+{
+    DWORD        generation;   /* font_list_generation of the results, 0 if not valid */
+    WCHAR        face_name[LF_FACESIZE];
+    BYTE         charset;
+    BYTE         pitch_and_family;
+    BOOL         italic;
+    BOOL         bold;
+    BOOL         can_use_bitmap;
+    Family      *family;
+    Face        *face;
+    FontSubst   *psub;
+    CHARSETINFO  csi;
+    BYTE         result_charset;
+    BOOL         fake_italic;
+    BOOL         fake_bold;
+};
+
+static struct font_match font_match_cache[FONT_MATCH_CACHE_SIZE];
+
+/* return the cache entry for the logfont, its key is reset if it doesn't match */
+static struct font_match *get_font_match( const LOGFONTW *lf, BOOL can_use_bitmap, BOOL *found )
+{
+    struct font_match *match;
+    BOOL italic = lf->lfItalic != 0, bold = lf->lfWeight > 550;
+    DWORD hash = lf->lfCharSet | (lf->lfPitchAndFamily << 8) | (italic << 16) | (bold << 17) | (can_use_bitmap << 18);
+    int i;
+
+    for (i = 0; i < LF_FACESIZE && lf->lfFaceName[i]; i++) hash = hash * 31 + tolowerW( lf->lfFaceName[i] );
+    match = &font_match_cache[hash % FONT_MATCH_CACHE_SIZE];
+
+    *found = (match->generation == font_list_generation &&
+              match->charset == lf->lfCharSet &&
+              match->pitch_and_family == lf->lfPitchAndFamily &&
+              match->italic == italic && match->bold == bold &&
+              match->can_use_bitmap == can_use_bitmap &&
+              !strncmpiW( match->face_name, lf->lfFaceName, LF_FACESIZE ));
+    if (!*found)
+    {
+        match->generation = 0;
+        lstrcpynW( match->face_name, lf->lfFaceName, LF_FACESIZE );
+        match->charset = lf->lfCharSet;
+        match->pitch_and_family = lf->lfPitchAndFamily;
+        match->italic = italic;
+        match->bold = bold;
+        match->can_use_bitmap = can_use_bitmap;
+    }
+    return match;
+}
+
 /*************************************************************
  * freetype_SelectFont
  */
@@ -5029,12 +5823,13 @@ static HFONT freetype_SelectFont( PHYSDEV dev, HFONT hfont, UINT *aa_flags )
     struct freetype_physdev *physdev = get_freetype_dev( dev );
     GdiFont *ret;
     Face *face, *best, *best_bitmap;
-    Family *family, *last_resort_family;
+    Family *family, *subst_family, *last_resort_family;
     const struct list *face_list;
     INT height, width = 0;
     unsigned int score = 0, new_score;
     signed int diff = 0, newdiff;
-    BOOL bd, it, can_use_bitmap, want_vertical;
+    BOOL bd, it, can_use_bitmap, want_vertical, matched;
+    struct font_match *match;
     LOGFONTW lf;
     CHARSETINFO csi;
     FMAT2 dcmat;
@@ -5107,6 +5902,22 @@ static HFONT freetype_SelectFont( PHYSDEV dev, HFONT hfont, UINT *aa_flags )
     ret->font_desc.can_use_bitmap = can_use_bitmap;
     calc_hash(&ret->font_desc);
 
+    match = get_font_match( &lf, can_use_bitmap, &matched );
+    if (matched)
+    {
+        TRACE("using cached match %s %s\n", debugstr_w(match->family->FamilyName),
+              debugstr_w(match->face->StyleName));
+        family = match->family;
+        face = match->face;
+        psub = match->psub;
+        csi = match->csi;
+        lf.lfCharSet = match->result_charset;
+        ret->fake_italic = match->fake_italic;
+        ret->fake_bold = match->fake_bold;
+        match = NULL;
+        goto found_face;
+    }
+
     /* If lfFaceName is "Symbol" then Windows fixes up lfCharSet to
        SYMBOL_CHARSET so that Symbol gets picked irrespective of the
        original value lfCharSet.  Note this is a special case for
@@ -5132,7 +5943,7 @@ static HFONT freetype_SelectFont( PHYSDEV dev, HFONT hfont, UINT *aa_flags )
         CHILD_FONT *font_link_entry;
         LPWSTR FaceName = lf.lfFaceName;
 
-        psub = get_font_subst(&font_subst_list, FaceName, lf.lfCharSet);
+        psub = get_font_subst(FaceName, lf.lfCharSet);
 
 	if(psub) {
 	    TRACE("substituting %s,%d -> %s,%d\n", debugstr_w(FaceName), lf.lfCharSet,
@@ -5147,42 +5958,42 @@ static HFONT freetype_SelectFont( PHYSDEV dev, HFONT hfont, UINT *aa_flags )
 	   where we'll either use the charset of the current ansi codepage
 	   or if that's unavailable the first charset that the font supports.
 	*/
-        LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry ) {
-            if (!strcmpiW(family->FamilyName, FaceName) ||
-                (psub && !strcmpiW(family->FamilyName, psub->to.name)))
-            {
-                font_link = find_font_link(family->FamilyName);
+        family = find_family_from_name(FaceName);
+        if (family && !family_has_charset(family, &csi, can_use_bitmap))
+            family = NULL;
+        /* if both names match, the first family in the list wins */
+        if (psub && (subst_family = find_family_from_name(psub->to.name)) &&
+            subst_family != family && family_has_charset(subst_family, &csi, can_use_bitmap) &&
+            (!family || family_precedes(subst_family, family)))
+            family = subst_family;
+        if (family)
+            goto found;
+
+        /* Search by full face name. The list only needs to be walked when
+           the hash table can't tell which face comes first. */
+        if (!find_face_from_full_name(FaceName, &csi, can_use_bitmap, &face))
+        {
+            LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry ) {
                 face_list = get_face_list_from_family(family);
                 LIST_FOR_EACH_ENTRY( face, face_list, Face, entry ) {
-                    if (!(face->scalable || can_use_bitmap))
-                        continue;
-                    if (csi.fs.fsCsb[0] & face->fs.fsCsb[0])
-                        goto found;
-                    if (font_link != NULL &&
-                        csi.fs.fsCsb[0] & font_link->fs.fsCsb[0])
-                        goto found;
-                    if (!csi.fs.fsCsb[0])
-                        goto found;
-                }
-            }
-	}
-
-        /* Search by full face name. */
-        LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry ) {
-            face_list = get_face_list_from_family(family);
-            LIST_FOR_EACH_ENTRY( face, face_list, Face, entry ) {
-                if(face->FullName && !strcmpiW(face->FullName, FaceName) &&
-                   (face->scalable || can_use_bitmap))
-                {
-                    if (csi.fs.fsCsb[0] & face->fs.fsCsb[0] || !csi.fs.fsCsb[0])
-                        goto found_face;
-                    font_link = find_font_link(family->FamilyName);
-                    if (font_link != NULL &&
-                        csi.fs.fsCsb[0] & font_link->fs.fsCsb[0])
-                        goto found_face;
+                    if(face->FullName && !strcmpiW(face->FullName, FaceName) &&
+                       (face->scalable || can_use_bitmap))
+                    {
+                        if (csi.fs.fsCsb[0] & face->fs.fsCsb[0] || !csi.fs.fsCsb[0])
+                            goto found_face;
+                        font_link = find_font_link(family->FamilyName);
+                        if (font_link != NULL &&
+                            csi.fs.fsCsb[0] & font_link->fs.fsCsb[0])
+                            goto found_face;
+                    }
                 }
             }
         }
+        else if (face)
+        {
+            family = face->family;
+            goto found_face;
+        }
 
         /*
 	 * Try check the SystemLink list first for a replacement font.
@@ -5240,18 +6051,16 @@ static HFONT freetype_SelectFont( PHYSDEV dev, HFONT hfont, UINT *aa_flags )
         strcpyW(lf.lfFaceName, defSans);
     else
         strcpyW(lf.lfFaceName, defSans);
-    LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry ) {
-        if(!strcmpiW(family->FamilyName, lf.lfFaceName)) {
-            font_link = find_font_link(family->FamilyName);
-            face_list = get_face_list_from_family(family);
-            LIST_FOR_EACH_ENTRY( face, face_list, Face, entry ) {
-                if (!(face->scalable || can_use_bitmap))
-                    continue;
-                if (csi.fs.fsCsb[0] & face->fs.fsCsb[0])
-                    goto found;
-                if (font_link != NULL && csi.fs.fsCsb[0] & font_link->fs.fsCsb[0])
-                    goto found;
-            }
+    if ((family = find_family_from_name(lf.lfFaceName))) {
+        font_link = find_font_link(family->FamilyName);
+        face_list = get_face_list_from_family(family);
+        LIST_FOR_EACH_ENTRY( face, face_list, Face, entry ) {
+            if (!(face->scalable || can_use_bitmap))
+                continue;
+            if (csi.fs.fsCsb[0] & face->fs.fsCsb[0])
+                goto found;
+            if (font_link != NULL && csi.fs.fsCsb[0] & font_link->fs.fsCsb[0])
+                goto found;
         }
     }
 
@@ -5351,6 +6160,18 @@ found:
     ret->fake_bold = (bd && !(face->ntmFlags & NTM_BOLD));
 
 found_face:
+    if (match && family_is_scalable(family))
+    {
+        match->family = family;
+        match->face = face;
+        match->psub = psub;
+        match->csi = csi;
+        match->result_charset = lf.lfCharSet;
+        match->fake_italic = ret->fake_italic;
+        match->fake_bold = ret->fake_bold;
+        match->generation = font_list_generation;
+    }
+
     height = lf.lfHeight;
 
     ret->fs = face->fs;
@@ -5792,7 +6613,7 @@ static BOOL freetype_EnumFonts( PHYSDEV dev, LPLOGFONTW plf, FONTENUMPROCW proc,
     EnterCriticalSection( &freetype_cs );
     if(plf->lfFaceName[0]) {
         FontSubst *psub;
-        psub = get_font_subst(&font_subst_list, plf->lfFaceName, plf->lfCharSet);
+        psub = get_font_subst(plf->lfFaceName, plf->lfCharSet);
 
         if(psub) {
             TRACE("substituting %s -> %s\n", debugstr_w(plf->lfFaceName),
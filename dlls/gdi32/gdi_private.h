@@ -95,6 +95,8 @@ typedef struct tagDC
     HRGN          hMetaRgn;      /* Meta region */
     HRGN          hVisRgn;       /* Visible region */
     HRGN          region;        /* Total DC region (intersection of clip and visible) */
+    HRGN          region_src[3]; /* source regions that the total region was computed from */
+    DWORD         region_serial[4]; /* serials of the source regions and of the total region */
     HPEN          hPen;
     HBRUSH        hBrush;
     HFONT         hFont;
@@ -328,6 +330,7 @@ extern HPALETTE PALETTE_Init(void) DECLSPEC_HIDDEN;
 extern BOOL add_rect_to_region( HRGN rgn, const RECT *rect ) DECLSPEC_HIDDEN;
 extern INT mirror_region( HRGN dst, HRGN src, INT width ) DECLSPEC_HIDDEN;
 extern BOOL REGION_FrameRgn( HRGN dest, HRGN src, INT x, INT y ) DECLSPEC_HIDDEN;
+extern DWORD get_region_serial( HRGN rgn ) DECLSPEC_HIDDEN;
 
 typedef struct
 {
@@ -335,6 +338,7 @@ typedef struct
     INT numRects;
     RECT *rects;
     RECT extents;
+    DWORD serial;  /* changes every time the region is modified */
 } WINEREGION;
 
 /* return the region data without making a copy */
@@ -154,6 +154,29 @@ static inline BOOL is_in_rect( const RECT *rect, int x, int y )
     return (rect->right > x && rect->left <= x && rect->bottom > y && rect->top <= y);
 }
 
+/* return the index of the first rectangle whose band ends below y */
+static int find_first_band( const WINEREGION *reg, int y )
+{
+    int min = 0, max = reg->numRects;
+
+    /* bands don't overlap, so the bottoms are sorted */
+    while (min < max)
+    {
+        int pos = (min + max) / 2;
+        if (reg->rects[pos].bottom <= y) min = pos + 1;
+        else max = pos;
+    }
+    return min;
+}
+
+static LONG region_serial;
+
+/* give the region a new serial number, to let cached results know it changed */
+static inline void region_changed( WINEREGION *reg )
+{
+    reg->serial = InterlockedIncrement( &region_serial );
+}
+
 /*
  * number of points to buffer before sending them off
  * to scanlines() :  Must be an even number
@@ -442,6 +465,7 @@ static BOOL init_region( WINEREGION *pReg, INT n )
     if (!(pReg->rects = HeapAlloc(GetProcessHeap(), 0, n * sizeof( RECT )))) return FALSE;
     pReg->size = n;
     empty_region(pReg);
+    region_changed(pReg);
     return TRUE;
 }
 
@@ -535,6 +559,7 @@ INT WINAPI OffsetRgn( HRGN hrgn, INT x, INT y )
         return ERROR;
 
     REGION_OffsetRegion( obj, obj, x, y);
+    region_changed( obj );
 
     ret = get_region_type( obj );
     GDI_ReleaseObj( hrgn );
@@ -679,6 +704,7 @@ BOOL WINAPI SetRectRgn( HRGN hrgn, INT left, INT top,
     else
 	empty_region(obj);
 
+    region_changed( obj );
     GDI_ReleaseObj( hrgn );
     return TRUE;
 }
@@ -1045,7 +1071,7 @@ BOOL WINAPI PtInRegion( HRGN hrgn, INT x, INT y )
 	int i;
 
 	if (obj->numRects > 0 && is_in_rect(&obj->extents, x, y))
-	    for (i = 0; i < obj->numRects; i++)
+	    for (i = find_first_band(obj, y); i < obj->numRects && obj->rects[i].top <= y; i++)
 		if (is_in_rect(&obj->rects[i], x, y))
                 {
 		    ret = TRUE;
@@ -1088,7 +1114,7 @@ BOOL WINAPI RectInRegion( HRGN hrgn, const RECT *rect )
     /* this is (just) a useful optimization */
 	if ((obj->numRects > 0) && overlapping(&obj->extents, &rc))
 	{
-	    for (pCurRect = obj->rects, pRectEnd = pCurRect +
+	    for (pCurRect = obj->rects + find_first_band(obj, rc.top), pRectEnd = obj->rects +
 	     obj->numRects; pCurRect < pRectEnd; pCurRect++)
 	    {
 	        if (pCurRect->bottom <= rc.top)
@@ -1163,6 +1189,24 @@ BOOL WINAPI EqualRgn( HRGN hrgn1, HRGN hrgn2 )
     return ret;
 }
 
+/***********************************************************************
+ *           get_region_serial
+ *
+ * Return a number that changes every time the region is modified, 0 on error.
+ */
+DWORD get_region_serial( HRGN hrgn )
+{
+    WINEREGION *obj = GDI_GetObjPtr( hrgn, OBJ_REGION );
+    DWORD ret = 0;
+
+    if (obj)
+    {
+        ret = obj->serial;
+        GDI_ReleaseObj( hrgn );
+    }
+    return ret;
+}
+
 /***********************************************************************
  *           REGION_UnionRectWithRegion
  *           Adds a rectangle to a WINEREGION
@@ -1171,6 +1215,42 @@ static BOOL REGION_UnionRectWithRegion(const RECT *rect, WINEREGION *rgn)
 {
     WINEREGION region;
 
+    /* fast path for a rectangle entirely above or below the region, the
+     * bands are simply added, merging with the adjacent one if possible */
+    if (rgn->numRects && rect->left < rect->right && rect->top < rect->bottom)
+    {
+        RECT *last = &rgn->rects[rgn->numRects - 1], *first = rgn->rects;
+
+        if (rect->top >= rgn->extents.bottom)
+        {
+            if (rect->top == last->bottom && last->left == rect->left && last->right == rect->right &&
+                (rgn->numRects == 1 || last[-1].top != last->top))
+                last->bottom = rect->bottom;
+            else if (!add_rect( rgn, rect->left, rect->top, rect->right, rect->bottom ))
+                return FALSE;
+            rgn->extents.left = min( rgn->extents.left, rect->left );
+            rgn->extents.right = max( rgn->extents.right, rect->right );
+            rgn->extents.bottom = rect->bottom;
+            return TRUE;
+        }
+        if (rect->bottom <= rgn->extents.top)
+        {
+            if (rect->bottom == first->top && first->left == rect->left && first->right == rect->right &&
+                (rgn->numRects == 1 || first[1].top != first->top))
+                first->top = rect->top;
+            else
+            {
+                if (!add_rect( rgn, 0, 0, 0, 0 )) return FALSE;
+                memmove( rgn->rects + 1, rgn->rects, (rgn->numRects - 1) * sizeof(RECT) );
+                rgn->rects[0] = *rect;
+            }
+            rgn->extents.left = min( rgn->extents.left, rect->left );
+            rgn->extents.right = max( rgn->extents.right, rect->right );
+            rgn->extents.top = rect->top;
+            return TRUE;
+        }
+    }
+
     region.rects = &region.extents;
     region.numRects = 1;
     region.size = 1;
@@ -1186,6 +1266,7 @@ BOOL add_rect_to_region( HRGN rgn, const RECT *rect )
 
     if (!obj) return FALSE;
     ret = REGION_UnionRectWithRegion( rect, obj );
+    region_changed( obj );
     GDI_ReleaseObj( rgn );
     return ret;
 }
@@ -1223,6 +1304,7 @@ BOOL REGION_FrameRgn( HRGN hDest, HRGN hSrc, INT x, INT y )
 	bRet = TRUE;
     }
 done:
+    if (destObj) region_changed( destObj );
     HeapFree( GetProcessHeap(), 0, tmprgn.rects );
     if (destObj) GDI_ReleaseObj ( hDest );
     GDI_ReleaseObj( hSrc );
@@ -1315,6 +1397,7 @@ INT WINAPI CombineRgn(HRGN hDest, HRGN hSrc1, HRGN hSrc2, INT mode)
 	if(TRACE_ON(region))
 	  REGION_DumpRegion(destObj);
 
+        region_changed( destObj );
 	GDI_ReleaseObj( hDest );
     }
     return result;
@@ -1438,6 +1521,7 @@ INT mirror_region( HRGN dst, HRGN src, INT width )
     if ((dst_rgn = GDI_GetObjPtr( dst, OBJ_REGION )))
     {
         if (REGION_MirrorRegion( dst_rgn, src_rgn, width )) ret = get_region_type( dst_rgn );
+        region_changed( dst_rgn );
         GDI_ReleaseObj( dst_rgn );
     }
     GDI_ReleaseObj( src_rgn );
@@ -1929,6 +2013,68 @@ static BOOL REGION_IntersectO(WINEREGION *pReg,  RECT *r1, RECT *r1End,
     return TRUE;
 }
 
+/***********************************************************************
+ *	     REGION_IntersectRect
+ *
+ *      Intersect a region with a rectangle. This is the common case of
+ *      clipping, and it can be done in place: each band is clipped, and
+ *      merged with the previous one if they became identical.
+ */
+static BOOL REGION_IntersectRect( WINEREGION *newReg, WINEREGION *reg, RECT rect )
+{
+    RECT *src, *end, *dst, *band, *prev = NULL;
+    int i, count, prev_count = 0;
+
+    if (newReg != reg && newReg->size < reg->numRects)
+    {
+        RECT *rects = HeapReAlloc( GetProcessHeap(), 0, newReg->rects, reg->numRects * sizeof(RECT) );
+        if (!rects) return FALSE;
+        newReg->rects = rects;
+        newReg->size = reg->numRects;
+    }
+
+    src = reg->rects + find_first_band( reg, rect.top );
+    end = reg->rects + reg->numRects;
+    dst = newReg->rects;
+
+    while (src < end && src->top < rect.bottom)
+    {
+        int band_top = src->top;
+        int top = max( src->top, rect.top ), bottom = min( src->bottom, rect.bottom );
+
+        band = dst;
+        for ( ; src < end && src->top == band_top; src++)
+        {
+            int left = max( src->left, rect.left ), right = min( src->right, rect.right );
+
+            if (left >= right) continue;
+            dst->left = left;
+            dst->top = top;
+            dst->right = right;
+            dst->bottom = bottom;
+            dst++;
+        }
+        if (!(count = dst - band)) continue;
+
+        /* merge with the previous band if it's adjacent and has the same rectangles */
+        if (prev && prev_count == count && prev->bottom == top)
+        {
+            for (i = 0; i < count; i++)
+                if (prev[i].left != band[i].left || prev[i].right != band[i].right) break;
+            if (i == count)
+            {
+                for (i = 0; i < count; i++) prev[i].bottom = bottom;
+                dst = band;
+                continue;
+            }
+        }
+        prev = band;
+        prev_count = count;
+    }
+    newReg->numRects = dst - newReg->rects;
+    return TRUE;
+}
+
 /***********************************************************************
  *	     REGION_IntersectRegion
  */
@@ -1939,6 +2085,14 @@ static BOOL REGION_IntersectRegion(WINEREGION *newReg, WINEREGION *reg1,
     if ( (!(reg1->numRects)) || (!(reg2->numRects))  ||
 	(!overlapping(&reg1->extents, &reg2->extents)))
 	newReg->numRects = 0;
+    else if (reg2->numRects == 1)
+    {
+        if (!REGION_IntersectRect( newReg, reg1, reg2->extents )) return FALSE;
+    }
+    else if (reg1->numRects == 1)
+    {
+        if (!REGION_IntersectRect( newReg, reg2, reg1->extents )) return FALSE;
+    }
     else
 	if (!REGION_RegionOp (newReg, reg1, reg2, REGION_IntersectO, NULL, NULL)) return FALSE;
 
@@ -3028,6 +3028,219 @@ static void check_StretchBlt_stretch(HDC hdcDst, HDC hdcSrc, BITMAPINFO *dst_inf
         nXOriginDest, nYOriginDest, nWidthDest, nHeightDest, line);
 }
 
+static void test_StretchBlt_large(void)
+{
+    BITMAPINFO bmi;
+    HBITMAP bmp_src, bmp_dst;
+    HDC hdc_src, hdc_dst;
+    DWORD *src_bits, *dst_bits;
+    int x, y, errors = 0;
+    BOOL ret;
+
+    /* big enough to be split across several threads */
+    memset( &bmi, 0, sizeof(bmi) );
+    bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+    bmi.bmiHeader.biWidth = 600;
+    bmi.bmiHeader.biHeight = -300;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    hdc_src = CreateCompatibleDC( 0 );
+    hdc_dst = CreateCompatibleDC( 0 );
+    bmp_src = CreateDIBSection( hdc_src, &bmi, DIB_RGB_COLORS, (void **)&src_bits, NULL, 0 );
+    bmi.bmiHeader.biHeight = -600;
+    bmp_dst = CreateDIBSection( hdc_dst, &bmi, DIB_RGB_COLORS, (void **)&dst_bits, NULL, 0 );
+    SelectObject( hdc_src, bmp_src );
+    SelectObject( hdc_dst, bmp_dst );
+
+    for (y = 0; y < 300; y++)
+        for (x = 0; x < 600; x++)
+            src_bits[y * 600 + x] = (y << 12) | x;
+
+    SetStretchBltMode( hdc_dst, COLORONCOLOR );
+    ret = StretchBlt( hdc_dst, 0, 0, 600, 600, hdc_src, 0, 0, 600, 300, SRCCOPY );
+    ok( ret, "StretchBlt failed\n" );
+    GdiFlush();
+
+    for (y = 0; y < 600; y++)
+        for (x = 0; x < 600; x++)
+            if (dst_bits[y * 600 + x] != src_bits[(y / 2) * 600 + x] && errors++ < 10)
+                ok( 0, "%d,%d: got %08x expected %08x\n", x, y,
+                    dst_bits[y * 600 + x], src_bits[(y / 2) * 600 + x] );
+    ok( !errors, "%d pixels differ\n", errors );
+
+    DeleteDC( hdc_src );
+    DeleteDC( hdc_dst );
+    DeleteObject( bmp_src );
+    DeleteObject( bmp_dst );
+}
+
+static void test_StretchBlt_halftone(void)
+{
+    BITMAPINFO bmi;
+    HBITMAP bmp_src, bmp_dst;
+    HDC hdc_src, hdc_dst;
+    DWORD *src_bits, *dst_bits;
+    int x, y, c, val;
+    BOOL ret;
+
+    memset( &bmi, 0, sizeof(bmi) );
+    bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+    bmi.bmiHeader.biWidth = 8;
+    bmi.bmiHeader.biHeight = -8;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    hdc_src = CreateCompatibleDC( 0 );
+    hdc_dst = CreateCompatibleDC( 0 );
+    bmp_src = CreateDIBSection( hdc_src, &bmi, DIB_RGB_COLORS, (void **)&src_bits, NULL, 0 );
+    bmi.bmiHeader.biWidth = 4;
+    bmi.bmiHeader.biHeight = -4;
+    bmp_dst = CreateDIBSection( hdc_dst, &bmi, DIB_RGB_COLORS, (void **)&dst_bits, NULL, 0 );
+    SelectObject( hdc_src, bmp_src );
+    SelectObject( hdc_dst, bmp_dst );
+    SetStretchBltMode( hdc_dst, HALFTONE );
+    SetBrushOrgEx( hdc_dst, 0, 0, NULL );
+
+    /* a one pixel checkerboard should be filtered to grey, not sampled */
+    for (y = 0; y < 8; y++)
+        for (x = 0; x < 8; x++)
+            src_bits[y * 8 + x] = ((x + y) & 1) ? 0xffffff : 0;
+
+    ret = StretchBlt( hdc_dst, 0, 0, 4, 4, hdc_src, 0, 0, 8, 8, SRCCOPY );
+    ok( ret, "StretchBlt failed\n" );
+    for (y = 0; y < 4; y++)
+        for (x = 0; x < 4; x++)
+            for (c = 0; c < 3; c++)
+            {
+                val = (dst_bits[y * 4 + x] >> (c * 8)) & 0xff;
+                ok( val >= 0x40 && val <= 0xc0, "%d,%d: got %08x\n", x, y, dst_bits[y * 4 + x] );
+            }
+
+    /* a uniform colour is preserved exactly */
+    for (x = 0; x < 64; x++) src_bits[x] = 0x123456;
+    ret = StretchBlt( hdc_dst, 0, 0, 4, 4, hdc_src, 0, 0, 8, 8, SRCCOPY );
+    ok( ret, "StretchBlt failed\n" );
+    for (x = 0; x < 16; x++)
+        ok( (dst_bits[x] & 0xffffff) == 0x123456, "%d: got %08x\n", x, dst_bits[x] );
+
+    DeleteDC( hdc_src );
+    DeleteDC( hdc_dst );
+    DeleteObject( bmp_src );
+    DeleteObject( bmp_dst );
+}
+
+/* draw the operation on hdc_dst, or with clip_left >= 0 only the 16 columns starting there */
+static BOOL draw_band_op( int op, HDC hdc_dst, HDC hdc_src, int clip_left )
+{
+    TRIVERTEX vert[2];
+    GRADIENT_RECT rect = { 0, 1 };
+    BLENDFUNCTION blend = { AC_SRC_OVER, 0, 200, AC_SRC_ALPHA };
+    BOOL ret = FALSE;
+
+    vert[0].x = 0;
+    vert[0].y = 0;
+    vert[0].Red = 0x1234;
+    vert[0].Green = 0xff00;
+    vert[0].Blue = 0x0100;
+    vert[0].Alpha = 0x8000;
+    vert[1].x = 1024;
+    vert[1].y = 1024;
+    vert[1].Red = 0xfe00;
+    vert[1].Green = 0x0000;
+    vert[1].Blue = 0x9876;
+    vert[1].Alpha = 0xff00;
+
+    SaveDC( hdc_dst );
+    if (clip_left >= 0) IntersectClipRect( hdc_dst, clip_left, 0, clip_left + 16, 1024 );
+    switch (op)
+    {
+    case 0:  /* shrink, bands can only start on some of the rows */
+        SetStretchBltMode( hdc_dst, COLORONCOLOR );
+        ret = StretchBlt( hdc_dst, 0, 0, 1024, 601, hdc_src, 0, 0, 1024, 1024, SRCCOPY );
+        break;
+    case 1:
+        ret = pGdiAlphaBlend( hdc_dst, 0, 0, 1024, 1024, hdc_src, 0, 0, 1024, 1024, blend );
+        break;
+    case 2:
+        ret = pGdiGradientFill( hdc_dst, vert, 2, &rect, 1, GRADIENT_FILL_RECT_V );
+        break;
+    case 3:
+        ret = pGdiGradientFill( hdc_dst, vert, 2, &rect, 1, GRADIENT_FILL_RECT_H );
+        break;
+    }
+    RestoreDC( hdc_dst, -1 );
+    return ret;
+}
+
+static void test_band_ops(void)
+{
+    BITMAPINFO bmi;
+    HBITMAP bmp_src, bmp_dst, bmp_ref;
+    HDC hdc_src, hdc_dst, hdc_ref;
+    DWORD *src_bits, *dst_bits, *ref_bits;
+    int op, x, y, errors;
+    BOOL ret;
+
+    if (!pGdiAlphaBlend || !pGdiGradientFill)
+    {
+        win_skip( "GdiAlphaBlend or GdiGradientFill not supported\n" );
+        return;
+    }
+
+    memset( &bmi, 0, sizeof(bmi) );
+    bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+    bmi.bmiHeader.biWidth = 1024;
+    bmi.bmiHeader.biHeight = -1024;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    hdc_src = CreateCompatibleDC( 0 );
+    hdc_dst = CreateCompatibleDC( 0 );
+    hdc_ref = CreateCompatibleDC( 0 );
+    bmp_src = CreateDIBSection( hdc_src, &bmi, DIB_RGB_COLORS, (void **)&src_bits, NULL, 0 );
+    bmp_dst = CreateDIBSection( hdc_dst, &bmi, DIB_RGB_COLORS, (void **)&dst_bits, NULL, 0 );
+    bmp_ref = CreateDIBSection( hdc_ref, &bmi, DIB_RGB_COLORS, (void **)&ref_bits, NULL, 0 );
+    SelectObject( hdc_src, bmp_src );
+    SelectObject( hdc_dst, bmp_dst );
+    SelectObject( hdc_ref, bmp_ref );
+
+    for (y = 0; y < 1024; y++)
+        for (x = 0; x < 1024; x++)
+            src_bits[y * 1024 + x] = ((x + y) & 0xff) << 24 | (y & 0x3ff) << 12 | x;
+
+    /* the whole operation is big enough to be split into bands, the 16 column strips aren't */
+    for (op = 0; op < 4; op++)
+    {
+        for (y = 0; y < 1024; y++)
+            for (x = 0; x < 1024; x++)
+                dst_bits[y * 1024 + x] = ref_bits[y * 1024 + x] = (x * y) & 0xffffff;
+
+        ret = draw_band_op( op, hdc_dst, hdc_src, -1 );
+        ok( ret, "%d: failed\n", op );
+        for (x = 0; x < 1024; x += 16) draw_band_op( op, hdc_ref, hdc_src, x );
+        GdiFlush();
+
+        errors = 0;
+        for (y = 0; y < 1024; y++)
+            for (x = 0; x < 1024; x++)
+                if (dst_bits[y * 1024 + x] != ref_bits[y * 1024 + x] && errors++ < 10)
+                    ok( 0, "%d: %d,%d: got %08x expected %08x\n", op, x, y,
+                        dst_bits[y * 1024 + x], ref_bits[y * 1024 + x] );
+        ok( !errors, "%d: %d pixels differ\n", op, errors );
+    }
+
+    DeleteDC( hdc_src );
+    DeleteDC( hdc_dst );
+    DeleteDC( hdc_ref );
+    DeleteObject( bmp_src );
+    DeleteObject( bmp_dst );
+    DeleteObject( bmp_ref );
+}
+
 static void test_StretchBlt(void)
 {
     HBITMAP bmpDst, bmpSrc;
@@ -3518,6 +3731,92 @@ static void test_StretchDIBits(void)
     DeleteDC(hdcScreen);
 }
 
+static BYTE expect_blend( BYTE dst, BYTE src, BYTE alpha )
+{
+    return src + (dst * (255 - alpha) + 127) / 255;
+}
+
+static void test_AlphaBlend_pixels(void)
+{
+    static const DWORD src_pixels[11] =
+    {
+        0xff102030, 0x80404040, 0x00000000, 0x40101010, 0xc0806040, 0x20080402, 0xffffffff,
+        0x10101010, 0x7f3f1f0f, 0x01010101, 0xe0e0e0e0
+    };
+    BITMAPINFO bmi;
+    HBITMAP bmp_src, bmp_dst;
+    HDC hdc_src, hdc_dst;
+    DWORD *src_bits, *dst_bits;
+    BLENDFUNCTION blend;
+    BOOL ret;
+    int i, j;
+
+    if (!pGdiAlphaBlend)
+    {
+        win_skip("GdiAlphaBlend() is not implemented\n");
+        return;
+    }
+
+    memset( &bmi, 0, sizeof(bmi) );
+    bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+    bmi.bmiHeader.biWidth = 11;  /* not a multiple of 4 */
+    bmi.bmiHeader.biHeight = -1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    hdc_src = CreateCompatibleDC( 0 );
+    hdc_dst = CreateCompatibleDC( 0 );
+    bmp_src = CreateDIBSection( hdc_src, &bmi, DIB_RGB_COLORS, (void **)&src_bits, NULL, 0 );
+    bmp_dst = CreateDIBSection( hdc_dst, &bmi, DIB_RGB_COLORS, (void **)&dst_bits, NULL, 0 );
+    SelectObject( hdc_src, bmp_src );
+    SelectObject( hdc_dst, bmp_dst );
+    memcpy( src_bits, src_pixels, sizeof(src_pixels) );
+
+    blend.BlendOp = AC_SRC_OVER;
+    blend.BlendFlags = 0;
+    blend.SourceConstantAlpha = 255;
+    blend.AlphaFormat = AC_SRC_ALPHA;
+    for (i = 0; i < 11; i++) dst_bits[i] = 0x80c0a060;
+    ret = pGdiAlphaBlend( hdc_dst, 0, 0, 11, 1, hdc_src, 0, 0, 11, 1, blend );
+    ok( ret, "GdiAlphaBlend failed err %u\n", GetLastError() );
+    GdiFlush();
+
+    for (i = 0; i < 11; i++)
+    {
+        BYTE alpha = src_pixels[i] >> 24;
+
+        for (j = 0; j < 32; j += 8)
+        {
+            int expect = expect_blend( 0x80c0a060 >> j, src_pixels[i] >> j, alpha );
+            int got = (BYTE)(dst_bits[i] >> j);
+            ok( abs( got - expect ) <= 1, "%d: channel %d got %02x expected %02x\n", i, j / 8, got, expect );
+        }
+    }
+
+    blend.SourceConstantAlpha = 128;
+    blend.AlphaFormat = 0;
+    for (i = 0; i < 11; i++) dst_bits[i] = 0x80c0a060;
+    ret = pGdiAlphaBlend( hdc_dst, 0, 0, 11, 1, hdc_src, 0, 0, 11, 1, blend );
+    ok( ret, "GdiAlphaBlend failed err %u\n", GetLastError() );
+    GdiFlush();
+
+    for (i = 0; i < 11; i++)
+    {
+        for (j = 0; j < 24; j += 8)
+        {
+            int expect = ((BYTE)(src_pixels[i] >> j) * 128 + (BYTE)(0x80c0a060 >> j) * 127 + 127) / 255;
+            int got = (BYTE)(dst_bits[i] >> j);
+            ok( abs( got - expect ) <= 1, "%d: channel %d got %02x expected %02x\n", i, j / 8, got, expect );
+        }
+    }
+
+    DeleteDC( hdc_src );
+    DeleteDC( hdc_dst );
+    DeleteObject( bmp_src );
+    DeleteObject( bmp_dst );
+}
+
 static void test_GdiAlphaBlend(void)
 {
     HDC hdcNull;
@@ -5600,8 +5899,12 @@ START_TEST(bitmap)
     test_CreateBitmap();
     test_BitBlt();
     test_StretchBlt();
+    test_StretchBlt_large();
+    test_StretchBlt_halftone();
     test_StretchDIBits();
     test_GdiAlphaBlend();
+    test_AlphaBlend_pixels();
+    test_band_ops();
     test_GdiGradientFill();
     test_32bit_ddb();
     test_bitmapinfoheadersize();
@@ -512,6 +512,180 @@ static void test_window_dc_clipping(void)
 }
 
 
+static HRGN create_region(const RECT *rects, DWORD count)
+{
+    union
+    {
+        RGNDATA data;
+        char buf[sizeof(RGNDATAHEADER) + 8 * sizeof(RECT)];
+    } rgn;
+
+    rgn.data.rdh.dwSize = sizeof(rgn.data.rdh);
+    rgn.data.rdh.iType = RDH_RECTANGLES;
+    rgn.data.rdh.nCount = count;
+    rgn.data.rdh.nRgnSize = count * sizeof(RECT);
+    SetRectEmpty(&rgn.data.rdh.rcBound);
+    memcpy(rgn.data.Buffer, rects, count * sizeof(RECT));
+    return ExtCreateRegion(NULL, sizeof(rgn.data.rdh) + count * sizeof(RECT), &rgn.data);
+}
+
+static void verify_region_rects(HRGN hrgn, const RECT *rects, DWORD count, int line)
+{
+    union
+    {
+        RGNDATA data;
+        char buf[sizeof(RGNDATAHEADER) + 8 * sizeof(RECT)];
+    } rgn;
+    const RECT *rect;
+    DWORD ret, i;
+
+    ret = GetRegionData(hrgn, sizeof(rgn), &rgn.data);
+    ok_(__FILE__, line)(ret == sizeof(rgn.data.rdh) + count * sizeof(RECT), "got %u\n", ret);
+    ok_(__FILE__, line)(rgn.data.rdh.nCount == count, "expected %u rects, got %u\n", count, rgn.data.rdh.nCount);
+    if (rgn.data.rdh.nCount != count) return;
+
+    rect = (const RECT *)rgn.data.Buffer;
+    for (i = 0; i < count; i++)
+        ok_(__FILE__, line)(EqualRect(&rect[i], &rects[i]), "%u: expected (%d,%d-%d,%d), got (%d,%d-%d,%d)\n", i,
+                            rects[i].left, rects[i].top, rects[i].right, rects[i].bottom,
+                            rect[i].left, rect[i].top, rect[i].right, rect[i].bottom);
+}
+
+static void test_region_bands(void)
+{
+    static const RECT bands[] =
+    {
+        { 0, 0, 10, 10 }, { 20, 0, 30, 10 },
+        { 0, 10, 30, 20 },
+        { 0, 30, 10, 40 }
+    };
+    static const RECT clipped[] =
+    {
+        { 5, 5, 10, 10 }, { 20, 5, 25, 10 },
+        { 5, 10, 25, 20 },
+        { 5, 30, 10, 35 }
+    };
+    static const RECT coalesce[] =
+    {
+        { 0, 0, 10, 10 }, { 20, 0, 30, 10 },
+        { 0, 10, 10, 20 }, { 15, 10, 30, 20 }
+    };
+    static const RECT coalesced[] = { { 0, 0, 10, 20 } };
+    static const RECT appended[] =
+    {
+        { 0, 0, 10, 10 },
+        { 0, 10, 20, 20 },
+        { 5, 30, 15, 40 }
+    };
+    static const RECT clip_rect = { 5, 5, 25, 35 };
+    HRGN hrgn, hrgn_rect, hrgn_dst;
+    RECT rc;
+    int ret;
+
+    hrgn = create_region(bands, sizeof(bands) / sizeof(bands[0]));
+    ok(hrgn != 0, "ExtCreateRegion error %u\n", GetLastError());
+    verify_region_rects(hrgn, bands, sizeof(bands) / sizeof(bands[0]), __LINE__);
+
+    ok(PtInRegion(hrgn, 5, 5), "expected point in region\n");
+    ok(PtInRegion(hrgn, 25, 9), "expected point in region\n");
+    ok(!PtInRegion(hrgn, 15, 5), "expected point outside region\n");
+    ok(PtInRegion(hrgn, 15, 15), "expected point in region\n");
+    ok(!PtInRegion(hrgn, 5, 25), "expected point outside region\n");
+    ok(PtInRegion(hrgn, 5, 39), "expected point in region\n");
+    ok(!PtInRegion(hrgn, 5, 40), "expected point outside region\n");
+    ok(!PtInRegion(hrgn, 25, 35), "expected point outside region\n");
+
+    SetRect(&rc, 12, 2, 18, 8);
+    ok(!RectInRegion(hrgn, &rc), "expected rect outside region\n");
+    SetRect(&rc, 12, 2, 18, 12);
+    ok(RectInRegion(hrgn, &rc), "expected rect in region\n");
+    SetRect(&rc, 12, 22, 28, 38);
+    ok(!RectInRegion(hrgn, &rc), "expected rect outside region\n");
+    SetRect(&rc, 8, 38, 20, 50);
+    ok(RectInRegion(hrgn, &rc), "expected rect in region\n");
+
+    /* intersection with a rectangle, into another region and in place */
+    hrgn_rect = CreateRectRgnIndirect(&clip_rect);
+    hrgn_dst = CreateRectRgn(0, 0, 0, 0);
+    ret = CombineRgn(hrgn_dst, hrgn, hrgn_rect, RGN_AND);
+    ok(ret == COMPLEXREGION, "expected COMPLEXREGION, got %d\n", ret);
+    verify_region_rects(hrgn_dst, clipped, sizeof(clipped) / sizeof(clipped[0]), __LINE__);
+    ret = CombineRgn(hrgn_dst, hrgn_rect, hrgn, RGN_AND);
+    ok(ret == COMPLEXREGION, "expected COMPLEXREGION, got %d\n", ret);
+    verify_region_rects(hrgn_dst, clipped, sizeof(clipped) / sizeof(clipped[0]), __LINE__);
+    ret = CombineRgn(hrgn, hrgn, hrgn_rect, RGN_AND);
+    ok(ret == COMPLEXREGION, "expected COMPLEXREGION, got %d\n", ret);
+    verify_region_rects(hrgn, clipped, sizeof(clipped) / sizeof(clipped[0]), __LINE__);
+    DeleteObject(hrgn);
+
+    /* identical bands left after clipping are merged */
+    hrgn = create_region(coalesce, sizeof(coalesce) / sizeof(coalesce[0]));
+    SetRectRgn(hrgn_rect, 0, 0, 12, 20);
+    ret = CombineRgn(hrgn_dst, hrgn, hrgn_rect, RGN_AND);
+    ok(ret == SIMPLEREGION, "expected SIMPLEREGION, got %d\n", ret);
+    verify_region_rects(hrgn_dst, coalesced, 1, __LINE__);
+
+    SetRectRgn(hrgn_rect, 40, 0, 50, 20);
+    ret = CombineRgn(hrgn_dst, hrgn, hrgn_rect, RGN_AND);
+    ok(ret == NULLREGION, "expected NULLREGION, got %d\n", ret);
+    DeleteObject(hrgn);
+
+    /* rectangles added below the existing bands */
+    hrgn = create_region(appended, sizeof(appended) / sizeof(appended[0]));
+    verify_region_rects(hrgn, appended, sizeof(appended) / sizeof(appended[0]), __LINE__);
+    ret = GetRgnBox(hrgn, &rc);
+    ok(ret == COMPLEXREGION, "expected COMPLEXREGION, got %d\n", ret);
+    ok(rc.left == 0 && rc.top == 0 && rc.right == 20 && rc.bottom == 40,
+       "wrong box (%d,%d-%d,%d)\n", rc.left, rc.top, rc.right, rc.bottom);
+    DeleteObject(hrgn);
+
+    DeleteObject(hrgn_rect);
+    DeleteObject(hrgn_dst);
+}
+
+static void test_meta_region_update(void)
+{
+    HDC hdc;
+    HRGN hrgn;
+    HBITMAP hbmp;
+    int ret;
+
+    hdc = CreateCompatibleDC(0);
+    hbmp = CreateCompatibleBitmap(hdc, 100, 100);
+    SelectObject(hdc, hbmp);
+
+    hrgn = CreateRectRgn(0, 0, 50, 50);
+    ret = SelectClipRgn(hdc, hrgn);
+    ok(ret == SIMPLEREGION, "expected SIMPLEREGION, got %d\n", ret);
+    ret = SetMetaRgn(hdc);
+    ok(ret == SIMPLEREGION, "expected SIMPLEREGION, got %d\n", ret);
+
+    SetRectRgn(hrgn, 20, 20, 80, 80);
+    ret = SelectClipRgn(hdc, hrgn);
+    ok(ret == SIMPLEREGION, "expected SIMPLEREGION, got %d\n", ret);
+    ok(PtVisible(hdc, 30, 30), "expected point to be visible\n");
+    ok(!PtVisible(hdc, 10, 10), "expected point to be clipped\n");
+    ok(!PtVisible(hdc, 60, 60), "expected point to be clipped\n");
+
+    /* the clip region is updated in place, the total region must follow */
+    SetRectRgn(hrgn, 0, 0, 30, 30);
+    ret = SelectClipRgn(hdc, hrgn);
+    ok(ret == SIMPLEREGION, "expected SIMPLEREGION, got %d\n", ret);
+    ok(PtVisible(hdc, 10, 10), "expected point to be visible\n");
+    ok(!PtVisible(hdc, 40, 40), "expected point to be clipped\n");
+
+    SetRectRgn(hrgn, 40, 40, 60, 60);
+    ret = ExtSelectClipRgn(hdc, hrgn, RGN_OR);
+    ok(ret == COMPLEXREGION, "expected COMPLEXREGION, got %d\n", ret);
+    ok(PtVisible(hdc, 10, 10), "expected point to be visible\n");
+    ok(PtVisible(hdc, 45, 45), "expected point to be visible\n");
+    ok(!PtVisible(hdc, 55, 55), "expected point to be clipped\n");
+
+    DeleteObject(hrgn);
+    DeleteDC(hdc);
+    DeleteObject(hbmp);
+}
+
 START_TEST(clipping)
 {
     test_GetRandomRgn();
@@ -519,4 +693,6 @@ START_TEST(clipping)
     test_GetClipRgn();
     test_memory_dc_clipping();
     test_window_dc_clipping();
+    test_region_bands();
+    test_meta_region_update();
 }
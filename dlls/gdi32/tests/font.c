@@ -3688,6 +3688,115 @@ static int CALLBACK create_fixed_pitch_font_proc(const LOGFONT *lpelfe,
     return 1;
 }
 
+static void test_many_fonts(void)
+{
+    static const char *names[] = { "Tahoma", "tahoma", "TAHOMA" };
+    LOGFONTA lf;
+    TEXTMETRICA tm;
+    char buf[LF_FACESIZE];
+    HFONT hfont, old_hfont;
+    HDC hdc;
+    int i;
+
+    if (!is_truetype_font_installed("Tahoma"))
+    {
+        skip("Tahoma is not installed\n");
+        return;
+    }
+
+    /* fonts only differing by size or style should keep resolving to the same face */
+    hdc = CreateCompatibleDC(0);
+    for (i = 0; i < 600; i++)
+    {
+        memset(&lf, 0, sizeof(lf));
+        strcpy(lf.lfFaceName, names[i % 3]);
+        lf.lfHeight = -(1 + i / 2);
+        lf.lfItalic = i & 1;
+        hfont = CreateFontIndirectA(&lf);
+        ok(hfont != 0, "%d: CreateFontIndirect failed\n", i);
+        old_hfont = SelectObject(hdc, hfont);
+
+        GetTextFaceA(hdc, sizeof(buf), buf);
+        ok(!strcmp(buf, "Tahoma"), "%d: got face %s\n", i, buf);
+        GetTextMetricsA(hdc, &tm);
+        ok(tm.tmItalic == lf.lfItalic, "%d: got italic %d\n", i, tm.tmItalic);
+
+        DeleteObject(SelectObject(hdc, old_hfont));
+    }
+    DeleteDC(hdc);
+}
+
+static DWORD hash_bits(const DWORD *bits, int count)
+{
+    DWORD hash = 0;
+    int i;
+
+    for (i = 0; i < count; i++) hash = hash * 31 + bits[i];
+    return hash;
+}
+
+static void test_glyph_cache(void)
+{
+    static const RECT rect = { 0, 0, 320, 320 };
+    DWORD hashes[0x180 - 0x21], hash, blank, *bits;
+    BITMAPINFO bmi;
+    LOGFONTA lf;
+    HBITMAP hbmp;
+    HFONT hfont, old_hfont;
+    HDC hdc;
+    WCHAR ch;
+    int pass, errors = 0;
+
+    if (!is_truetype_font_installed("Tahoma"))
+    {
+        skip("Tahoma is not installed\n");
+        return;
+    }
+
+    memset(&bmi, 0, sizeof(bmi));
+    bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+    bmi.bmiHeader.biWidth = 320;
+    bmi.bmiHeader.biHeight = -320;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    hdc = CreateCompatibleDC(0);
+    hbmp = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, (void **)&bits, NULL, 0);
+    SelectObject(hdc, hbmp);
+
+    memset(&lf, 0, sizeof(lf));
+    strcpy(lf.lfFaceName, "Tahoma");
+    lf.lfHeight = -256;
+    lf.lfQuality = NONANTIALIASED_QUALITY;
+    hfont = CreateFontIndirectA(&lf);
+    old_hfont = SelectObject(hdc, hfont);
+
+    ExtTextOutW(hdc, 0, 0, ETO_OPAQUE, &rect, NULL, 0, NULL);
+    GdiFlush();
+    blank = hash_bits(bits, 320 * 320);
+
+    /* the glyphs of such a big font don't all fit in the glyph cache of the DIB engine,
+     * so by the second pass the first ones have been evicted and get rendered again */
+    for (pass = 0; pass < 2; pass++)
+    {
+        for (ch = 0x21; ch < 0x180; ch++)
+        {
+            ExtTextOutW(hdc, 10, 10, ETO_OPAQUE, &rect, &ch, 1, NULL);
+            GdiFlush();
+            hash = hash_bits(bits, 320 * 320);
+            if (!pass) hashes[ch - 0x21] = hash;
+            else if (hash != hashes[ch - 0x21] && errors++ < 10)
+                ok(0, "glyph %04x rendered differently the second time\n", ch);
+        }
+    }
+    ok(!errors, "%d glyphs rendered differently\n", errors);
+    ok(hashes['W' - 0x21] != blank, "nothing rendered\n");
+
+    DeleteObject(SelectObject(hdc, old_hfont));
+    DeleteDC(hdc);
+    DeleteObject(hbmp);
+}
+
 static void test_GetGlyphOutline(void)
 {
     HDC hdc;
@@ -5197,6 +5306,8 @@ START_TEST(font)
     test_GetTextMetrics();
     test_GdiRealizationInfo();
     test_GetTextFace();
+    test_many_fonts();
+    test_glyph_cache();
     test_GetGlyphOutline();
     test_GetTextMetrics2("Tahoma", -11);
     test_GetTextMetrics2("Tahoma", -55);
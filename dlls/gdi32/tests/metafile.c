@@ -3373,6 +3373,230 @@ static void test_emf_polybezier(void)
     DeleteEnhMetaFile(hemf);
 }
 
+static int CALLBACK count_emf_records(HDC hdc, HANDLETABLE *handle_table,
+                                      const ENHMETARECORD *emr, int n_objs, LPARAM param)
+{
+    (*(DWORD *)param)++;
+    return 1;
+}
+
+static void test_emf_clipped_playback(void)
+{
+    static const char text[] = "Wine";
+    ENHMETAHEADER header;
+    BITMAPINFO bmi;
+    HENHMETAFILE hemf;
+    HBITMAP hbmp;
+    HFONT hfont;
+    DWORD *bits, count;
+    HDC hdc, hdc_emf;
+    RECT rc;
+    BOOL ret;
+    int x, y, drawn;
+
+    hdc_emf = CreateEnhMetaFileA(0, NULL, NULL, NULL);
+    ok(hdc_emf != 0, "CreateEnhMetaFileA error %d\n", GetLastError());
+
+    PatBlt(hdc_emf, 10, 10, 10, 10, BLACKNESS);
+    PatBlt(hdc_emf, 60, 60, 10, 10, BLACKNESS);
+    hfont = CreateFontA(-12, 0, 0, 0, FW_NORMAL, 0, 0, 0, ANSI_CHARSET, 0, 0, 0, 0, "Arial");
+    SelectObject(hdc_emf, hfont);
+    SetTextAlign(hdc_emf, TA_BASELINE);
+    ExtTextOutA(hdc_emf, 10, 50, 0, NULL, text, sizeof(text) - 1, NULL);
+
+    hemf = CloseEnhMetaFile(hdc_emf);
+    ok(hemf != 0, "CloseEnhMetaFile error %d\n", GetLastError());
+    DeleteObject(hfont);
+
+    ret = GetEnhMetaFileHeader(hemf, sizeof(header), &header);
+    ok(ret == sizeof(header), "GetEnhMetaFileHeader returned %d\n", ret);
+    SetRect(&rc, header.rclBounds.left, header.rclBounds.top,
+            header.rclBounds.right + 1, header.rclBounds.bottom + 1);
+
+    memset(&bmi, 0, sizeof(bmi));
+    bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+    bmi.bmiHeader.biWidth = 100;
+    bmi.bmiHeader.biHeight = -100;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    hdc = CreateCompatibleDC(0);
+    hbmp = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, (void **)&bits, NULL, 0);
+    SelectObject(hdc, hbmp);
+
+    /* only the first rectangle is inside the clip box */
+    memset(bits, 0xff, 100 * 100 * 4);
+    IntersectClipRect(hdc, 0, 0, 40, 40);
+    ret = PlayEnhMetaFile(hdc, hemf, &rc);
+    ok(ret, "PlayEnhMetaFile error %d\n", GetLastError());
+    ok((bits[15 * 100 + 15] & 0xffffff) == 0, "got %08x\n", bits[15 * 100 + 15]);
+    ok((bits[65 * 100 + 65] & 0xffffff) == 0xffffff, "got %08x\n", bits[65 * 100 + 65]);
+    SelectClipRgn(hdc, NULL);
+
+    /* a partially visible rectangle and the text are still drawn */
+    memset(bits, 0xff, 100 * 100 * 4);
+    IntersectClipRect(hdc, 0, 40, 100, 100);
+    ret = PlayEnhMetaFile(hdc, hemf, &rc);
+    ok(ret, "PlayEnhMetaFile error %d\n", GetLastError());
+    ok((bits[15 * 100 + 15] & 0xffffff) == 0xffffff, "got %08x\n", bits[15 * 100 + 15]);
+    ok((bits[65 * 100 + 65] & 0xffffff) == 0, "got %08x\n", bits[65 * 100 + 65]);
+    for (y = 40, drawn = 0; y < 60; y++)
+        for (x = 0; x < 55; x++)
+            if ((bits[y * 100 + x] & 0xffffff) != 0xffffff) drawn++;
+    ok(drawn, "text wasn't drawn\n");
+    SelectClipRgn(hdc, NULL);
+
+    /* the clip box is in logical coordinates of the destination */
+    memset(bits, 0xff, 100 * 100 * 4);
+    SetViewportOrgEx(hdc, -50, -50, NULL);
+    ret = PlayEnhMetaFile(hdc, hemf, &rc);
+    ok(ret, "PlayEnhMetaFile error %d\n", GetLastError());
+    ok((bits[15 * 100 + 15] & 0xffffff) == 0, "got %08x\n", bits[15 * 100 + 15]);
+    SetViewportOrgEx(hdc, 0, 0, NULL);
+
+    /* enumeration doesn't skip anything */
+    IntersectClipRect(hdc, 0, 0, 1, 1);
+    count = 0;
+    ret = EnumEnhMetaFile(hdc, hemf, count_emf_records, &count, &rc);
+    ok(ret, "EnumEnhMetaFile error %d\n", GetLastError());
+    ok(count == header.nRecords, "expected %u records, got %u\n", header.nRecords, count);
+
+    DeleteDC(hdc);
+    DeleteObject(hbmp);
+    DeleteEnhMetaFile(hemf);
+}
+
+static void test_emf_clipped_text_update_cp(void)
+{
+    static const char text[] = "Wine";
+    static const INT dx[] = { 10, 10, 10, 10 };
+    ENHMETAHEADER header;
+    BITMAPINFO bmi;
+    HENHMETAFILE hemf;
+    HBITMAP hbmp;
+    DWORD *bits;
+    HDC hdc, hdc_emf;
+    RECT rc;
+    BOOL ret;
+    int x, line, diagonal;
+
+    hdc_emf = CreateEnhMetaFileA(0, NULL, NULL, NULL);
+    ok(hdc_emf != 0, "CreateEnhMetaFileA error %d\n", GetLastError());
+
+    /* the text moves the current position by the sum of the advances, the
+     * line then starts at the end of the text */
+    PatBlt(hdc_emf, 0, 0, 1, 1, BLACKNESS);
+    SetTextAlign(hdc_emf, TA_UPDATECP);
+    MoveToEx(hdc_emf, 10, 15, NULL);
+    SetRect(&rc, 10, 0, 60, 30);
+    ExtTextOutA(hdc_emf, 10, 15, ETO_CLIPPED, &rc, text, sizeof(text) - 1, dx);
+    LineTo(hdc_emf, 50, 90);
+    PatBlt(hdc_emf, 99, 99, 1, 1, BLACKNESS);
+
+    hemf = CloseEnhMetaFile(hdc_emf);
+    ok(hemf != 0, "CloseEnhMetaFile error %d\n", GetLastError());
+
+    ret = GetEnhMetaFileHeader(hemf, sizeof(header), &header);
+    ok(ret == sizeof(header), "GetEnhMetaFileHeader returned %d\n", ret);
+    SetRect(&rc, header.rclBounds.left, header.rclBounds.top,
+            header.rclBounds.right + 1, header.rclBounds.bottom + 1);
+
+    memset(&bmi, 0, sizeof(bmi));
+    bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+    bmi.bmiHeader.biWidth = 100;
+    bmi.bmiHeader.biHeight = -100;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    hdc = CreateCompatibleDC(0);
+    hbmp = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, (void **)&bits, NULL, 0);
+    SelectObject(hdc, hbmp);
+
+    /* the clipped text is outside of the clip box, but still updates the current position */
+    memset(bits, 0xff, 100 * 100 * 4);
+    IntersectClipRect(hdc, 0, 40, 100, 100);
+    ret = PlayEnhMetaFile(hdc, hemf, &rc);
+    ok(ret, "PlayEnhMetaFile error %d\n", GetLastError());
+    for (x = 40, line = diagonal = 0; x < 53; x++)
+    {
+        if ((bits[80 * 100 + x] & 0xffffff) == 0xffffff) continue;
+        if (x >= 48) line++;
+        else diagonal++;
+    }
+    ok(line && !diagonal, "line drawn from the wrong position, got %d %d\n", line, diagonal);
+
+    DeleteDC(hdc);
+    DeleteObject(hbmp);
+    DeleteEnhMetaFile(hemf);
+}
+
+static int CALLBACK play_emf_record(HDC hdc, HANDLETABLE *table, const ENHMETARECORD *emr,
+                                    int count, LPARAM param)
+{
+    return PlayEnhMetaFileRecord(hdc, table, emr, count);
+}
+
+static void test_emf_clipped_clip_reset(void)
+{
+    static DWORD expect[100 * 100];
+    ENHMETAHEADER header;
+    BITMAPINFO bmi;
+    HENHMETAFILE hemf;
+    HBITMAP hbmp;
+    DWORD *bits;
+    HDC hdc, hdc_emf;
+    RECT rc;
+    BOOL ret;
+
+    hdc_emf = CreateEnhMetaFileA(0, NULL, NULL, NULL);
+    ok(hdc_emf != 0, "CreateEnhMetaFileA error %d\n", GetLastError());
+
+    /* the rectangle is outside of the initial clip box, but the clip region is reset first */
+    PatBlt(hdc_emf, 0, 0, 1, 1, BLACKNESS);
+    SelectClipRgn(hdc_emf, NULL);
+    PatBlt(hdc_emf, 60, 60, 10, 10, BLACKNESS);
+    PatBlt(hdc_emf, 99, 99, 1, 1, BLACKNESS);
+
+    hemf = CloseEnhMetaFile(hdc_emf);
+    ok(hemf != 0, "CloseEnhMetaFile error %d\n", GetLastError());
+
+    ret = GetEnhMetaFileHeader(hemf, sizeof(header), &header);
+    ok(ret == sizeof(header), "GetEnhMetaFileHeader returned %d\n", ret);
+    SetRect(&rc, header.rclBounds.left, header.rclBounds.top,
+            header.rclBounds.right + 1, header.rclBounds.bottom + 1);
+
+    memset(&bmi, 0, sizeof(bmi));
+    bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+    bmi.bmiHeader.biWidth = 100;
+    bmi.bmiHeader.biHeight = -100;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    hdc = CreateCompatibleDC(0);
+    hbmp = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, (void **)&bits, NULL, 0);
+    SelectObject(hdc, hbmp);
+
+    /* enumeration plays every record, playback must give the same result */
+    memset(bits, 0xff, 100 * 100 * 4);
+    IntersectClipRect(hdc, 0, 0, 40, 40);
+    ret = EnumEnhMetaFile(hdc, hemf, play_emf_record, NULL, &rc);
+    ok(ret, "EnumEnhMetaFile error %d\n", GetLastError());
+    memcpy(expect, bits, sizeof(expect));
+    SelectClipRgn(hdc, NULL);
+
+    memset(bits, 0xff, 100 * 100 * 4);
+    IntersectClipRect(hdc, 0, 0, 40, 40);
+    ret = PlayEnhMetaFile(hdc, hemf, &rc);
+    ok(ret, "PlayEnhMetaFile error %d\n", GetLastError());
+    ok(bits[65 * 100 + 65] == expect[65 * 100 + 65], "got %08x expected %08x\n",
+       bits[65 * 100 + 65], expect[65 * 100 + 65]);
+    ok(!memcmp(bits, expect, sizeof(expect)), "playback differs from enumeration\n");
+
+    DeleteDC(hdc);
+    DeleteObject(hbmp);
+    DeleteEnhMetaFile(hemf);
+}
+
 START_TEST(metafile)
 {
     init_function_pointers();
@@ -3386,6 +3610,9 @@ START_TEST(metafile)
     test_emf_ExtTextOut_on_path();
     test_emf_clipping();
     test_emf_polybezier();
+    test_emf_clipped_playback();
+    test_emf_clipped_text_update_cp();
+    test_emf_clipped_clip_reset();
 
     /* For win-format metafiles (mfdrv) */
     test_mf_SaveDC();
@@ -3634,6 +3634,339 @@ end:
     return retval;
 }
 
+/* Anti-aliased filling. The edges of the flattened path are accumulated into
+ * sparse cells holding, for each pixel they cross, the signed height of the
+ * edges (cover) and the part of the pixel that they cover (area). Each
+ * scanline is then swept from left to right, which gives the coverage of
+ * every pixel as a sequence of spans without building a region. */
+struct raster_cell
+{
+    INT x, y;
+    REAL cover;
+    REAL area;
+};
+
+struct rasterizer
+{
+    GpRect bounds;
+    struct raster_cell *cells;
+    INT count, size;
+};
+
+static BOOL raster_add_cell(struct rasterizer *raster, INT x, INT y, REAL cover, REAL area)
+{
+    struct raster_cell *cell;
+
+    if (raster->count)
+    {
+        cell = &raster->cells[raster->count - 1];
+        if (cell->x == x && cell->y == y)
+        {
+            cell->cover += cover;
+            cell->area += area;
+            return TRUE;
+        }
+    }
+
+    if (raster->count == raster->size)
+    {
+        INT new_size = max(raster->size * 2, 256);
+        struct raster_cell *new_cells;
+
+        if (raster->cells)
+            new_cells = HeapReAlloc(GetProcessHeap(), 0, raster->cells, new_size * sizeof(*new_cells));
+        else
+            new_cells = HeapAlloc(GetProcessHeap(), 0, new_size * sizeof(*new_cells));
+        if (!new_cells) return FALSE;
+        raster->cells = new_cells;
+        raster->size = new_size;
+    }
+
+    cell = &raster->cells[raster->count++];
+    cell->x = x;
+    cell->y = y;
+    cell->cover = cover;
+    cell->area = area;
+    return TRUE;
+}
+
+/* add an edge lying inside scanline y, splitting it at pixel boundaries */
+static BOOL raster_add_row_edge(struct rasterizer *raster, INT y, REAL x0, REAL y0, REAL x1, REAL y1)
+{
+    INT left = raster->bounds.X, right = raster->bounds.X + raster->bounds.Width;
+    REAL dy = y1 - y0, xa, ya, boundary, yb;
+    INT x, step;
+
+    /* split the edge where it crosses the horizontal bounds */
+    if ((x0 < left && x1 > left) || (x0 > left && x1 < left))
+    {
+        yb = y0 + (left - x0) * dy / (x1 - x0);
+        return raster_add_row_edge(raster, y, x0, y0, left, yb) &&
+               raster_add_row_edge(raster, y, left, yb, x1, y1);
+    }
+    if ((x0 < right && x1 > right) || (x0 > right && x1 < right))
+    {
+        yb = y0 + (right - x0) * dy / (x1 - x0);
+        return raster_add_row_edge(raster, y, x0, y0, right, yb) &&
+               raster_add_row_edge(raster, y, right, yb, x1, y1);
+    }
+
+    /* edges on the left cover the whole scanline, edges on the right don't matter */
+    if (max(x0, x1) <= left) return raster_add_cell(raster, left, y, dy, dy);
+    if (min(x0, x1) >= right) return TRUE;
+
+    if (x0 == x1)
+    {
+        x = floorf(x0);
+        return raster_add_cell(raster, x, y, dy, dy * (1.0 - (x0 - x)));
+    }
+
+    step = x1 > x0 ? 1 : -1;
+    x = x1 > x0 ? floorf(x0) : ceilf(x0) - 1;
+    xa = x0;
+    ya = y0;
+    for (;;)
+    {
+        boundary = step > 0 ? x + 1 : x;
+        if (step > 0 ? x1 <= boundary : x1 >= boundary) break;
+
+        yb = y0 + (boundary - x0) * dy / (x1 - x0);
+        if (x >= left && x < right &&
+            !raster_add_cell(raster, x, y, yb - ya, (yb - ya) * (1.0 - ((xa + boundary) / 2 - x))))
+            return FALSE;
+        xa = boundary;
+        ya = yb;
+        x += step;
+    }
+    if (x < left || x >= right) return TRUE;
+    return raster_add_cell(raster, x, y, y1 - ya, (y1 - ya) * (1.0 - ((xa + x1) / 2 - x)));
+}
+
+static BOOL raster_add_edge(struct rasterizer *raster, REAL x0, REAL y0, REAL x1, REAL y1)
+{
+    INT top = raster->bounds.Y, bottom = raster->bounds.Y + raster->bounds.Height;
+    REAL dxdy, ymin, ymax, ya, yb;
+    INT y;
+
+    if (y0 == y1) return TRUE;
+    ymin = max(min(y0, y1), top);
+    ymax = min(max(y0, y1), bottom);
+    if (ymin >= ymax) return TRUE;
+
+    dxdy = (x1 - x0) / (y1 - y0);
+    for (y = floorf(ymin); y < ymax; y++)
+    {
+        ya = max(ymin, y);
+        yb = min(ymax, y + 1);
+        if (ya >= yb) continue;
+
+        /* keep the direction of the edge, it gives the sign of the coverage */
+        if (y0 < y1)
+        {
+            if (!raster_add_row_edge(raster, y, x0 + (ya - y0) * dxdy, ya, x0 + (yb - y0) * dxdy, yb))
+                return FALSE;
+        }
+        else
+        {
+            if (!raster_add_row_edge(raster, y, x0 + (yb - y0) * dxdy, yb, x0 + (ya - y0) * dxdy, ya))
+                return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static int compare_raster_cells(const void *a, const void *b)
+{
+    const struct raster_cell *cell1 = a, *cell2 = b;
+
+    if (cell1->y != cell2->y) return cell1->y - cell2->y;
+    return cell1->x - cell2->x;
+}
+
+static BYTE raster_coverage(REAL value, GpFillMode fill)
+{
+    value = fabsf(value);
+    if (fill == FillModeAlternate)
+    {
+        value = fmodf(value, 2.0);
+        if (value > 1.0) value = 2.0 - value;
+    }
+    else if (value > 1.0)
+        value = 1.0;
+    return gdip_round(value * 255.0);
+}
+
+/* scale the alpha of the pixels in [start, end) of a row by the coverage */
+static void raster_apply_span(DWORD *pixels, INT start, INT end, BYTE coverage)
+{
+    INT x;
+
+    if (coverage == 0xff) return;
+    for (x = start; x < end; x++)
+    {
+        DWORD alpha = ((pixels[x] >> 24) * coverage + 127) / 255;
+        pixels[x] = (pixels[x] & 0x00ffffff) | (alpha << 24);
+    }
+}
+
+static void raster_sweep(struct rasterizer *raster, DWORD *pixels, INT stride, GpFillMode fill)
+{
+    INT left = raster->bounds.X, right = raster->bounds.X + raster->bounds.Width;
+    INT i = 0, x, y;
+    REAL acc, cover, area;
+
+    qsort(raster->cells, raster->count, sizeof(*raster->cells), compare_raster_cells);
+
+    for (y = raster->bounds.Y; y < raster->bounds.Y + raster->bounds.Height; y++)
+    {
+        DWORD *row = pixels + (y - raster->bounds.Y) * stride - left;
+
+        acc = 0.0;
+        x = left;
+        while (i < raster->count && raster->cells[i].y == y)
+        {
+            INT cell_x = raster->cells[i].x;
+
+            cover = area = 0.0;
+            for (; i < raster->count && raster->cells[i].y == y && raster->cells[i].x == cell_x; i++)
+            {
+                cover += raster->cells[i].cover;
+                area += raster->cells[i].area;
+            }
+            raster_apply_span(row, x, cell_x, raster_coverage(acc, fill));
+            raster_apply_span(row, cell_x, cell_x + 1, raster_coverage(acc + area, fill));
+            acc += cover;
+            x = cell_x + 1;
+        }
+        raster_apply_span(row, x, right, raster_coverage(acc, fill));
+    }
+}
+
+static GpStatus SOFTWARE_GdipFillPathAntialias(GpGraphics *graphics, GpBrush *brush, GpPath *path)
+{
+    struct rasterizer raster;
+    GpStatus stat;
+    GpPath *flat_path;
+    GpMatrix world_to_device;
+    GpRectF graphics_bounds;
+    GpPointF *points;
+    REAL offset, xmin, ymin, xmax, ymax;
+    DWORD *pixel_data;
+    INT i, start;
+
+    stat = get_graphics_bounds(graphics, &graphics_bounds);
+
+    if (stat == Ok)
+        stat = get_graphics_transform(graphics, CoordinateSpaceDevice,
+            CoordinateSpaceWorld, &world_to_device);
+
+    if (stat == Ok)
+        stat = GdipClonePath(path, &flat_path);
+
+    if (stat != Ok)
+        return stat;
+
+    stat = GdipFlattenPath(flat_path, &world_to_device, FlatnessDefault);
+
+    if (stat != Ok || !flat_path->pathdata.Count)
+    {
+        GdipDeletePath(flat_path);
+        return stat;
+    }
+
+    /* by default pixel centers are at integer coordinates */
+    if (graphics->pixeloffset == PixelOffsetModeHalf || graphics->pixeloffset == PixelOffsetModeHighQuality)
+        offset = 0.0;
+    else
+        offset = 0.5;
+
+    points = flat_path->pathdata.Points;
+    xmin = xmax = points[0].X;
+    ymin = ymax = points[0].Y;
+    for (i = 0; i < flat_path->pathdata.Count; i++)
+    {
+        points[i].X += offset;
+        points[i].Y += offset;
+        xmin = min(xmin, points[i].X);
+        xmax = max(xmax, points[i].X);
+        ymin = min(ymin, points[i].Y);
+        ymax = max(ymax, points[i].Y);
+    }
+
+    raster.bounds.X = max(floorf(xmin), ceilf(graphics_bounds.X));
+    raster.bounds.Y = max(floorf(ymin), ceilf(graphics_bounds.Y));
+    raster.bounds.Width = min(ceilf(xmax), floorf(graphics_bounds.X + graphics_bounds.Width)) - raster.bounds.X;
+    raster.bounds.Height = min(ceilf(ymax), floorf(graphics_bounds.Y + graphics_bounds.Height)) - raster.bounds.Y;
+    raster.cells = NULL;
+    raster.count = raster.size = 0;
+
+    if (raster.bounds.Width <= 0 || raster.bounds.Height <= 0)
+    {
+        GdipDeletePath(flat_path);
+        return Ok;
+    }
+
+    /* every subpath is implicitly closed */
+    for (i = start = 0; stat == Ok && i < flat_path->pathdata.Count; i++)
+    {
+        INT next = i + 1;
+
+        if (next == flat_path->pathdata.Count ||
+            (flat_path->pathdata.Types[next] & PathPointTypePathTypeMask) == PathPointTypeStart)
+            next = start;
+
+        if (!raster_add_edge(&raster, points[i].X, points[i].Y, points[next].X, points[next].Y))
+            stat = OutOfMemory;
+
+        if (next == start) start = i + 1;
+    }
+
+    GdipDeletePath(flat_path);
+
+    if (stat == Ok)
+    {
+        pixel_data = GdipAlloc(sizeof(*pixel_data) * raster.bounds.Width * raster.bounds.Height);
+        if (!pixel_data)
+            stat = OutOfMemory;
+
+        if (stat == Ok)
+        {
+            stat = brush_fill_pixels(graphics, brush, pixel_data,
+                &raster.bounds, raster.bounds.Width);
+
+            if (stat == Ok)
+            {
+                raster_sweep(&raster, pixel_data, raster.bounds.Width, path->fill);
+
+                stat = alpha_blend_pixels(graphics, raster.bounds.X, raster.bounds.Y,
+                    (BYTE*)pixel_data, raster.bounds.Width, raster.bounds.Height,
+                    raster.bounds.Width * 4);
+            }
+
+            GdipFree(pixel_data);
+        }
+    }
+
+    HeapFree(GetProcessHeap(), 0, raster.cells);
+    return stat;
+}
+
+/* whether fills should go through the anti-aliased software rasterizer */
+static BOOL use_antialiased_fill(GpGraphics *graphics, GpBrush *brush)
+{
+    if (graphics->smoothing != SmoothingModeAntiAlias && graphics->smoothing != SmoothingModeHighQuality)
+        return FALSE;
+
+    if (!brush_can_fill_pixels(brush))
+        return FALSE;
+
+    if (graphics->image)
+        return graphics->image->type == ImageTypeBitmap;
+
+    /* the coverage is applied through alpha blending */
+    return GetDeviceCaps(graphics->hdc, SHADEBLENDCAPS) != SB_NONE;
+}
+
 static GpStatus SOFTWARE_GdipFillPath(GpGraphics *graphics, GpBrush *brush, GpPath *path)
 {
     GpStatus stat;
@@ -3668,7 +4001,9 @@ GpStatus WINGDIPAPI GdipFillPath(GpGraphics *graphics, GpBrush *brush, GpPath *p
     if(graphics->busy)
         return ObjectBusy;
 
-    if (!graphics->image && !graphics->alpha_hdc)
+    if (use_antialiased_fill(graphics, brush))
+        stat = SOFTWARE_GdipFillPathAntialias(graphics, brush, path);
+    else if (!graphics->image && !graphics->alpha_hdc)
         stat = GDI32_GdipFillPath(graphics, brush, path);
 
     if (stat == NotImplemented)
@@ -4471,6 +4471,70 @@ static void test_alpha_hdc(void)
     DeleteDC(hdc);
 }
 
+static void test_antialias_fill(void)
+{
+    GpStatus status;
+    GpGraphics *graphics;
+    GpBitmap *bitmap;
+    GpSolidFill *brush;
+    ARGB color;
+
+    status = GdipCreateBitmapFromScan0(10, 10, 0, PixelFormat24bppRGB, NULL, &bitmap);
+    expect(Ok, status);
+
+    status = GdipGetImageGraphicsContext((GpImage*)bitmap, &graphics);
+    expect(Ok, status);
+
+    status = GdipCreateSolidFill(0xffffffff, &brush);
+    expect(Ok, status);
+
+    status = GdipSetSmoothingMode(graphics, SmoothingModeAntiAlias);
+    expect(Ok, status);
+
+    /* pixel centers are on integer coordinates, the edges are half covered */
+    status = GdipFillRectangle(graphics, (GpBrush*)brush, 2.0, 2.0, 4.0, 4.0);
+    expect(Ok, status);
+
+    status = GdipBitmapGetPixel(bitmap, 4, 4, &color);
+    expect(Ok, status);
+    expect(0xffffffff, color);
+
+    status = GdipBitmapGetPixel(bitmap, 2, 4, &color);
+    expect(Ok, status);
+    ok((color & 0xff) > 0x40 && (color & 0xff) < 0xc0, "expected partial coverage, got %08x\n", color);
+
+    status = GdipBitmapGetPixel(bitmap, 4, 6, &color);
+    expect(Ok, status);
+    ok((color & 0xff) > 0x40 && (color & 0xff) < 0xc0, "expected partial coverage, got %08x\n", color);
+
+    status = GdipBitmapGetPixel(bitmap, 8, 8, &color);
+    expect(Ok, status);
+    expect(0xff000000, color);
+
+    /* with half pixel offset the rectangle is aligned on pixel boundaries */
+    status = GdipSetPixelOffsetMode(graphics, PixelOffsetModeHalf);
+    expect(Ok, status);
+
+    status = GdipFillRectangle(graphics, (GpBrush*)brush, 6.0, 2.0, 2.0, 2.0);
+    expect(Ok, status);
+
+    status = GdipBitmapGetPixel(bitmap, 6, 2, &color);
+    expect(Ok, status);
+    expect(0xffffffff, color);
+
+    status = GdipBitmapGetPixel(bitmap, 7, 3, &color);
+    expect(Ok, status);
+    expect(0xffffffff, color);
+
+    status = GdipBitmapGetPixel(bitmap, 8, 3, &color);
+    expect(Ok, status);
+    expect(0xff000000, color);
+
+    GdipDeleteBrush((GpBrush*)brush);
+    GdipDeleteGraphics(graphics);
+    GdipDisposeImage((GpImage*)bitmap);
+}
+
 static void test_bitmapfromgraphics(void)
 {
     GpStatus stat;
@@ -5565,6 +5629,7 @@ START_TEST(graphics)
     test_getdc_scaled();
     test_alpha_hdc();
     test_bitmapfromgraphics();
+    test_antialias_fill();
 
     GdiplusShutdown(gdiplusToken);
     DestroyWindow( hwnd );
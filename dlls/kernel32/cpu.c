@@ -211,6 +211,19 @@ BOOL WINAPI IsProcessorFeaturePresent (
     return FALSE;
 }
 
+/***********************************************************************
+ *           GetLargePageMinimum	[KERNEL32.@]
+ *
+ * Retrieve the minimum size of a large page.
+ *
+ * RETURNS
+ *  The large page size, or 0 if large pages are not supported.
+ */
+SIZE_T WINAPI GetLargePageMinimum(void)
+{
+    return SHARED_DATA->LargePageMinimum;
+}
+
 /***********************************************************************
  *           K32GetPerformanceInfo (KERNEL32.@)
  */
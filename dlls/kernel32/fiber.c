@@ -30,6 +30,7 @@
 
 #include <setjmp.h>
 #include <stdarg.h>
+#include <string.h>
 
 #define NONAMELESSUNION
 #include "windef.h"
@@ -39,6 +40,33 @@
 #include "wine/exception.h"
 #include "wine/library.h"
 
+#if defined(__i386__) || defined(__x86_64__)
+
+/* callee-saved registers of a suspended fiber, layout is used by switch_fiber_context */
+struct fiber_context
+{
+#ifdef __i386__
+    DWORD ebx;  /* 00 */
+    DWORD esi;  /* 04 */
+    DWORD edi;  /* 08 */
+    DWORD ebp;  /* 0c */
+    DWORD esp;  /* 10 */
+    DWORD eip;  /* 14 */
+#else
+    ULONG64 rbx;  /* 00 */
+    ULONG64 rbp;  /* 08 */
+    ULONG64 r12;  /* 10 */
+    ULONG64 r13;  /* 18 */
+    ULONG64 r14;  /* 20 */
+    ULONG64 r15;  /* 28 */
+    ULONG64 rsp;  /* 30 */
+    ULONG64 rip;  /* 38 */
+    ULONG64 rdi;  /* 40 first argument, only used to start a new fiber */
+#endif
+};
+
+#endif  /* __i386__ || __x86_64__ */
+
 struct fiber_data
 {
     LPVOID                param;             /* 00 fiber param */
@@ -46,19 +74,93 @@ struct fiber_data
     void                 *stack_base;        /* 08 top of fiber stack */
     void                 *stack_limit;       /* 0c fiber stack low-water mark */
     void                 *stack_allocation;  /* 10 base of the fiber stack allocation */
+#if defined(__i386__) || defined(__x86_64__)
+    struct fiber_context  context;           /* 14 saved registers (on Windows: CONTEXT) */
+#else
     sigjmp_buf            jmpbuf;            /* 14 setjmp buffer (on Windows: CONTEXT) */
+#endif
     DWORD                 flags;             /*    fiber flags */
     LPFIBER_START_ROUTINE start;             /*    start routine */
     void                **fls_slots;         /*    fiber storage slots */
+    void                 *actctx_frame;      /*    active activation context frame */
+    WORD                  fpu_cw;            /*    saved x87 control word (FIBER_FLAG_FLOAT_SWITCH) */
+    DWORD                 mxcsr;             /*    saved SSE control/status (FIBER_FLAG_FLOAT_SWITCH) */
 };
 
 
+#ifdef __i386__
+extern void switch_fiber_context( struct fiber_context *old, const struct fiber_context *new );
+__ASM_GLOBAL_FUNC( switch_fiber_context,
+                   "movl 4(%esp),%eax\n\t"   /* old */
+                   "movl 8(%esp),%edx\n\t"   /* new */
+                   "movl %ebx,0x00(%eax)\n\t"
+                   "movl %esi,0x04(%eax)\n\t"
+                   "movl %edi,0x08(%eax)\n\t"
+                   "movl %ebp,0x0c(%eax)\n\t"
+                   "leal 4(%esp),%ecx\n\t"
+                   "movl %ecx,0x10(%eax)\n\t"  /* stack pointer after return */
+                   "movl (%esp),%ecx\n\t"
+                   "movl %ecx,0x14(%eax)\n\t"  /* return address */
+                   "movl 0x00(%edx),%ebx\n\t"
+                   "movl 0x04(%edx),%esi\n\t"
+                   "movl 0x08(%edx),%edi\n\t"
+                   "movl 0x0c(%edx),%ebp\n\t"
+                   "movl 0x10(%edx),%esp\n\t"
+                   "jmp *0x14(%edx)" )
+#elif defined(__x86_64__)
+extern void switch_fiber_context( struct fiber_context *old, const struct fiber_context *new );
+__ASM_GLOBAL_FUNC( switch_fiber_context,
+                   "movq %rbx,0x00(%rdi)\n\t"
+                   "movq %rbp,0x08(%rdi)\n\t"
+                   "movq %r12,0x10(%rdi)\n\t"
+                   "movq %r13,0x18(%rdi)\n\t"
+                   "movq %r14,0x20(%rdi)\n\t"
+                   "movq %r15,0x28(%rdi)\n\t"
+                   "leaq 8(%rsp),%rax\n\t"
+                   "movq %rax,0x30(%rdi)\n\t"  /* stack pointer after return */
+                   "movq (%rsp),%rax\n\t"
+                   "movq %rax,0x38(%rdi)\n\t"  /* return address */
+                   "movq 0x00(%rsi),%rbx\n\t"
+                   "movq 0x08(%rsi),%rbp\n\t"
+                   "movq 0x10(%rsi),%r12\n\t"
+                   "movq 0x18(%rsi),%r13\n\t"
+                   "movq 0x20(%rsi),%r14\n\t"
+                   "movq 0x28(%rsi),%r15\n\t"
+                   "movq 0x40(%rsi),%rdi\n\t"
+                   "movq 0x30(%rsi),%rsp\n\t"
+                   "jmp *0x38(%rsi)" )
+#endif
+
+
+/* save the floating point control state of the current thread into the fiber */
+static inline void save_fpu_state( struct fiber_data *fiber )
+{
+#ifdef __i386__
+    __asm__ __volatile__( "fnstcw %0" : "=m" (fiber->fpu_cw) );
+#elif defined(__x86_64__)
+    __asm__ __volatile__( "fnstcw %0; stmxcsr %1" : "=m" (fiber->fpu_cw), "=m" (fiber->mxcsr) );
+#endif
+}
+
+/* restore the floating point control state saved by save_fpu_state */
+static inline void restore_fpu_state( const struct fiber_data *fiber )
+{
+#ifdef __i386__
+    __asm__ __volatile__( "fldcw %0" : : "m" (fiber->fpu_cw) );
+#elif defined(__x86_64__)
+    __asm__ __volatile__( "fldcw %0; ldmxcsr %1" : : "m" (fiber->fpu_cw), "m" (fiber->mxcsr) );
+#endif
+}
+
+
 /* call the fiber initial function once we have switched stack */
 static void start_fiber( void *arg )
 {
     struct fiber_data *fiber = arg;
     LPFIBER_START_ROUTINE start = fiber->start;
 
+    if (fiber->flags & FIBER_FLAG_FLOAT_SWITCH) restore_fpu_state( fiber );
+
     __TRY
     {
         fiber->start = NULL;
@@ -73,6 +175,28 @@ static void start_fiber( void *arg )
 }
 
 
+#if defined(__i386__) || defined(__x86_64__)
+/* set up the initial context of a new fiber so that switching to it calls start_fiber */
+static void init_fiber_context( struct fiber_data *fiber )
+{
+    ULONG_PTR sp = (ULONG_PTR)fiber->stack_base & ~15;
+
+    memset( &fiber->context, 0, sizeof(fiber->context) );
+#ifdef __i386__
+    sp -= 5 * sizeof(void *);  /* keep the argument 16-byte aligned */
+    ((void **)sp)[0] = NULL;   /* return address */
+    ((void **)sp)[1] = fiber;  /* argument */
+    fiber->context.esp = sp;
+    fiber->context.eip = (DWORD)start_fiber;
+#else
+    fiber->context.rsp = sp - 8;  /* as if called, with the return address slot */
+    fiber->context.rip = (ULONG_PTR)start_fiber;
+    fiber->context.rdi = (ULONG_PTR)fiber;
+#endif
+}
+#endif
+
+
 /***********************************************************************
  *           CreateFiber   (KERNEL32.@)
  */
@@ -110,6 +234,11 @@ LPVOID WINAPI CreateFiberEx( SIZE_T stack_commit, SIZE_T stack_reserve, DWORD fl
     fiber->start       = start;
     fiber->flags       = flags;
     fiber->fls_slots   = NULL;
+    fiber->actctx_frame = NULL;
+    if (flags & FIBER_FLAG_FLOAT_SWITCH) save_fpu_state( fiber );
+#if defined(__i386__) || defined(__x86_64__)
+    init_fiber_context( fiber );
+#endif
     return fiber;
 }
 
@@ -162,6 +291,7 @@ LPVOID WINAPI ConvertThreadToFiberEx( LPVOID param, DWORD flags )
     fiber->start            = NULL;
     fiber->flags            = flags;
     fiber->fls_slots        = NtCurrentTeb()->FlsSlots;
+    fiber->actctx_frame     = NtCurrentTeb()->ActivationContextStack.ActiveFrame;
     NtCurrentTeb()->Tib.u.FiberData = fiber;
     return fiber;
 }
@@ -191,12 +321,24 @@ void WINAPI SwitchToFiber( LPVOID fiber )
     struct fiber_data *new_fiber = fiber;
     struct fiber_data *current_fiber = NtCurrentTeb()->Tib.u.FiberData;
 
-    current_fiber->except      = NtCurrentTeb()->Tib.ExceptionList;
-    current_fiber->stack_limit = NtCurrentTeb()->Tib.StackLimit;
-    current_fiber->fls_slots   = NtCurrentTeb()->FlsSlots;
+    current_fiber->except       = NtCurrentTeb()->Tib.ExceptionList;
+    current_fiber->stack_limit  = NtCurrentTeb()->Tib.StackLimit;
+    current_fiber->fls_slots    = NtCurrentTeb()->FlsSlots;
+    current_fiber->actctx_frame = NtCurrentTeb()->ActivationContextStack.ActiveFrame;
     /* stack_allocation and stack_base never change */
 
-    /* FIXME: should save floating point context if requested in fiber->flags */
+    if (current_fiber->flags & FIBER_FLAG_FLOAT_SWITCH) save_fpu_state( current_fiber );
+
+#if defined(__i386__) || defined(__x86_64__)
+    NtCurrentTeb()->Tib.u.FiberData   = new_fiber;
+    NtCurrentTeb()->Tib.ExceptionList = new_fiber->except;
+    NtCurrentTeb()->Tib.StackBase     = new_fiber->stack_base;
+    NtCurrentTeb()->Tib.StackLimit    = new_fiber->stack_limit;
+    NtCurrentTeb()->DeallocationStack = new_fiber->stack_allocation;
+    NtCurrentTeb()->FlsSlots          = new_fiber->fls_slots;
+    NtCurrentTeb()->ActivationContextStack.ActiveFrame = new_fiber->actctx_frame;
+    switch_fiber_context( &current_fiber->context, &new_fiber->context );
+#else
     if (!sigsetjmp( current_fiber->jmpbuf, 0 ))
     {
         NtCurrentTeb()->Tib.u.FiberData   = new_fiber;
@@ -205,11 +347,15 @@ void WINAPI SwitchToFiber( LPVOID fiber )
         NtCurrentTeb()->Tib.StackLimit    = new_fiber->stack_limit;
         NtCurrentTeb()->DeallocationStack = new_fiber->stack_allocation;
         NtCurrentTeb()->FlsSlots          = new_fiber->fls_slots;
+        NtCurrentTeb()->ActivationContextStack.ActiveFrame = new_fiber->actctx_frame;
         if (new_fiber->start)  /* first time */
             wine_switch_to_stack( start_fiber, new_fiber, new_fiber->stack_base );
         else
             siglongjmp( new_fiber->jmpbuf, 1 );
     }
+#endif
+    /* we get here once another fiber switches back to us */
+    if (current_fiber->flags & FIBER_FLAG_FLOAT_SWITCH) restore_fpu_state( current_fiber );
 }
 
 /***********************************************************************
@@ -374,6 +374,8 @@ BOOL WINAPI ReadFileScatter( HANDLE file, FILE_SEGMENT_ELEMENT *segments, DWORD
     PIO_STATUS_BLOCK io_status;
     LARGE_INTEGER offset;
     NTSTATUS status;
+    HANDLE event = overlapped->hEvent;
+    void *cvalue = ((ULONG_PTR)event & 1) ? NULL : overlapped;
 
     TRACE( "(%p %p %u %p)\n", file, segments, count, overlapped );
 
@@ -383,7 +385,7 @@ BOOL WINAPI ReadFileScatter( HANDLE file, FILE_SEGMENT_ELEMENT *segments, DWORD
     io_status->u.Status = STATUS_PENDING;
     io_status->Information = 0;
 
-    status = NtReadFileScatter( file, NULL, NULL, NULL, io_status, segments, count, &offset, NULL );
+    status = NtReadFileScatter( file, event, NULL, cvalue, io_status, segments, count, &offset, NULL );
     if (status) SetLastError( RtlNtStatusToDosError(status) );
     return !status;
 }
@@ -506,6 +508,8 @@ BOOL WINAPI WriteFileGather( HANDLE file, FILE_SEGMENT_ELEMENT *segments, DWORD
     PIO_STATUS_BLOCK io_status;
     LARGE_INTEGER offset;
     NTSTATUS status;
+    HANDLE event = overlapped->hEvent;
+    void *cvalue = ((ULONG_PTR)event & 1) ? NULL : overlapped;
 
     TRACE( "%p %p %u %p\n", file, segments, count, overlapped );
 
@@ -515,7 +519,7 @@ BOOL WINAPI WriteFileGather( HANDLE file, FILE_SEGMENT_ELEMENT *segments, DWORD
     io_status->u.Status = STATUS_PENDING;
     io_status->Information = 0;
 
-    status = NtWriteFileGather( file, NULL, NULL, NULL, io_status, segments, count, &offset, NULL );
+    status = NtWriteFileGather( file, event, NULL, cvalue, io_status, segments, count, &offset, NULL );
     if (status) SetLastError( RtlNtStatusToDosError(status) );
     return !status;
 }
@@ -27,6 +27,15 @@
 #include <errno.h>
 #include <stdio.h>
 #include <stdarg.h>
+#ifdef HAVE_SYS_IOCTL_H
+# include <sys/ioctl.h>
+#endif
+#ifdef HAVE_SYS_SYSCALL_H
+# include <sys/syscall.h>
+#endif
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
 
 #define NONAMELESSUNION
 #define NONAMELESSSTRUCT
@@ -888,6 +897,152 @@ static BOOL is_same_file(HANDLE h1, HANDLE h2)
     return ret;
 }
 
+/* state of a CopyFileEx operation, used to report progress */
+struct copy_progress
+{
+    LPPROGRESS_ROUTINE routine;
+    LPVOID             param;
+    LPBOOL             cancel_ptr;
+    HANDLE             source;
+    HANDLE             dest;
+    LARGE_INTEGER      total;
+    LARGE_INTEGER      transferred;
+    DWORD              action;      /* PROGRESS_* code that stopped the copy */
+    BOOL               quiet;
+};
+
+/* notify the progress routine; returns FALSE if the copy has to be aborted */
+static BOOL copy_progress_notify( struct copy_progress *cp, DWORD reason )
+{
+    DWORD ret = PROGRESS_CONTINUE;
+
+    if (cp->cancel_ptr && *cp->cancel_ptr) ret = PROGRESS_CANCEL;
+    else if (cp->routine && !cp->quiet)
+        ret = cp->routine( cp->total, cp->transferred, cp->total, cp->transferred, 1,
+                           reason, cp->source, cp->dest, cp->param );
+
+    switch (ret)
+    {
+    case PROGRESS_QUIET:
+        cp->quiet = TRUE;
+        /* fall through */
+    case PROGRESS_CONTINUE:
+        return TRUE;
+    case PROGRESS_CANCEL:
+    case PROGRESS_STOP:
+        cp->action = ret;
+        break;
+    default:
+        FIXME( "unhandled progress routine return value %u\n", ret );
+        cp->action = PROGRESS_STOP;
+        break;
+    }
+    SetLastError( ERROR_REQUEST_ABORTED );
+    return FALSE;
+}
+
+#ifdef __linux__
+
+#ifndef FICLONE
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+
+#define COPY_CHUNK_SIZE (1024 * 1024)
+
+/* the plain sendfile syscall fails past 2Gb on 32-bit platforms */
+#ifdef __NR_sendfile64
+#define NR_SENDFILE __NR_sendfile64
+#else
+#define NR_SENDFILE __NR_sendfile
+#endif
+
+/***********************************************************************
+ *           copy_file_unix
+ *
+ * Copy the file data without going through user space: share the extents
+ * when the filesystem supports reflinks, otherwise use copy_file_range()
+ * or sendfile() from the current file positions.
+ * Returns 1 when done, 0 when the caller should fall back to ReadFile/WriteFile
+ * from the current positions, -1 on error.
+ */
+static int copy_file_unix( HANDLE h1, HANDLE h2, struct copy_progress *cp )
+{
+    struct stat st_src, st_dst;
+    BOOL use_copy_range = TRUE;
+    int src, dst, ret = 0;
+    ssize_t count;
+
+    if (wine_server_handle_to_fd( h1, FILE_READ_DATA, &src, NULL )) return 0;
+    if (wine_server_handle_to_fd( h2, FILE_WRITE_DATA, &dst, NULL ))
+    {
+        wine_server_release_fd( h1, src );
+        return 0;
+    }
+    if (fstat( src, &st_src ) == -1 || !S_ISREG( st_src.st_mode ) ||
+        fstat( dst, &st_dst ) == -1 || !S_ISREG( st_dst.st_mode ))
+        goto done;
+
+    if (st_src.st_size && !st_dst.st_size && !ioctl( dst, FICLONE, src ))
+    {
+        TRACE( "cloned %s bytes\n", wine_dbgstr_longlong( (ULONGLONG)st_src.st_size ));
+        cp->transferred.QuadPart = st_src.st_size;
+        ret = copy_progress_notify( cp, CALLBACK_CHUNK_FINISHED ) ? 1 : -1;
+        goto done;
+    }
+
+    for (;;)
+    {
+#ifdef __NR_copy_file_range
+        if (use_copy_range)
+        {
+            count = syscall( __NR_copy_file_range, src, NULL, dst, NULL, COPY_CHUNK_SIZE, 0 );
+            if (count == -1 && (errno == ENOSYS || errno == EXDEV || errno == EINVAL ||
+                                errno == EOPNOTSUPP || errno == EBADF))
+            {
+                use_copy_range = FALSE;
+                continue;
+            }
+        }
+        else
+#endif
+            count = syscall( NR_SENDFILE, dst, src, NULL, COPY_CHUNK_SIZE );
+
+        if (count == -1)
+        {
+            if (errno == EINTR) continue;
+            if (errno == ENOSYS || errno == EINVAL) break;  /* use ReadFile/WriteFile */
+            FILE_SetDosError();
+            ret = -1;
+            break;
+        }
+        if (!count)
+        {
+            ret = 1;
+            break;
+        }
+        cp->transferred.QuadPart += count;
+        if (!copy_progress_notify( cp, CALLBACK_CHUNK_FINISHED ))
+        {
+            ret = -1;
+            break;
+        }
+    }
+
+done:
+    wine_server_release_fd( h2, dst );
+    wine_server_release_fd( h1, src );
+    return ret;
+}
+
+#else  /* __linux__ */
+
+static int copy_file_unix( HANDLE h1, HANDLE h2, struct copy_progress *cp )
+{
+    return 0;
+}
+
+#endif  /* __linux__ */
+
 /**************************************************************************
  *           CopyFileW   (KERNEL32.@)
  */
@@ -924,11 +1079,13 @@ BOOL WINAPI CopyFileExW(LPCWSTR source, LPCWSTR dest,
                         LPBOOL cancel_ptr, DWORD flags)
 {
     static const int buffer_size = 65536;
+    struct copy_progress cp;
     HANDLE h1, h2;
     BY_HANDLE_FILE_INFORMATION info;
     DWORD count;
     BOOL ret = FALSE;
     char *buffer;
+    int copied;
 
     if (!source || !dest)
     {
@@ -989,9 +1146,28 @@ BOOL WINAPI CopyFileExW(LPCWSTR source, LPCWSTR dest,
         return FALSE;
     }
 
+    cp.routine = progress;
+    cp.param = param;
+    cp.cancel_ptr = cancel_ptr;
+    cp.source = h1;
+    cp.dest = h2;
+    cp.total.u.LowPart = info.nFileSizeLow;
+    cp.total.u.HighPart = info.nFileSizeHigh;
+    cp.transferred.QuadPart = 0;
+    cp.action = PROGRESS_CONTINUE;
+    cp.quiet = FALSE;
+    if (!copy_progress_notify( &cp, CALLBACK_STREAM_SWITCH )) goto done;
+
+    if ((copied = copy_file_unix( h1, h2, &cp )))
+    {
+        ret = (copied > 0);
+        goto done;
+    }
+
     while (ReadFile( h1, buffer, buffer_size, &count, NULL ) && count)
     {
         char *p = buffer;
+        cp.transferred.QuadPart += count;
         while (count != 0)
         {
             DWORD res;
@@ -999,6 +1175,7 @@ BOOL WINAPI CopyFileExW(LPCWSTR source, LPCWSTR dest,
             p += res;
             count -= res;
         }
+        if (!copy_progress_notify( &cp, CALLBACK_CHUNK_FINISHED )) goto done;
     }
     ret =  TRUE;
 done:
@@ -1007,6 +1184,7 @@ done:
     HeapFree( GetProcessHeap(), 0, buffer );
     CloseHandle( h1 );
     CloseHandle( h2 );
+    if (cp.action == PROGRESS_CANCEL) DeleteFileW( dest );
     return ret;
 }
 
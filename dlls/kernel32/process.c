@@ -48,6 +48,7 @@
 # include <unistd.h>
 #endif
 #ifdef __APPLE__
+#include <crt_externs.h>
 #include <CoreFoundation/CoreFoundation.h>
 #include <pthread.h>
 #endif
@@ -68,8 +69,10 @@ WINE_DECLARE_DEBUG_CHANNEL(relay);
 
 #ifdef __APPLE__
 extern char **__wine_get_main_environment(void);
+#define environ (*_NSGetEnviron())
 #else
 extern char **__wine_main_environ;
+extern char **environ;
 static char **__wine_get_main_environment(void) { return __wine_main_environ; }
 #endif
 
@@ -1441,6 +1444,44 @@ static char **build_envp( const WCHAR *envW )
 }
 
 
+/***********************************************************************
+ *           spawn_fork
+ *
+ * Create the intermediate child used to detach new processes. On Linux
+ * vfork() only suspends the calling thread and doesn't copy the address
+ * space, which is the expensive part of forking a Wine process; the
+ * child must only use data prepared beforehand, and then exec or exit.
+ */
+#ifdef __linux__
+#define spawn_fork() vfork()
+#else
+#define spawn_fork() fork()
+#endif
+
+
+/***********************************************************************
+ *           reset_signal_handlers
+ *
+ * Restore the default handlers before exec, so that none of ours can run
+ * in a vfork() child on the memory of the parent.
+ */
+static void reset_signal_handlers(void)
+{
+    struct sigaction sa;
+    int sig;
+
+    for (sig = 1; sig < NSIG; sig++)
+    {
+        if (sigaction( sig, NULL, &sa ) == -1) continue;
+        if (sa.sa_handler == SIG_DFL || sa.sa_handler == SIG_IGN) continue;
+        sa.sa_handler = SIG_DFL;
+        sa.sa_flags = 0;
+        sigemptyset( &sa.sa_mask );
+        sigaction( sig, &sa, NULL );
+    }
+}
+
+
 /***********************************************************************
  *           fork_and_exec
  *
@@ -1452,6 +1493,7 @@ static int fork_and_exec( const char *filename, const WCHAR *cmdline, const WCHA
     int fd[2], stdin_fd = -1, stdout_fd = -1, stderr_fd = -1;
     int pid, err;
     char **argv, **envp;
+    sigset_t all_set, old_set;
 
     if (!env) env = GetEnvironmentStringsW();
 
@@ -1499,10 +1541,17 @@ static int fork_and_exec( const char *filename, const WCHAR *cmdline, const WCHA
     argv = build_argv( cmdline, 0 );
     envp = build_envp( env );
 
-    if (!(pid = fork()))  /* child */
+    /* keep our handlers from running in the children until they are reset */
+    sigfillset( &all_set );
+    sigprocmask( SIG_BLOCK, &all_set, &old_set );
+
+    /* everything the grandchild needs is prepared beforehand, so it can share our memory */
+    if (!(pid = spawn_fork()))  /* child */
     {
-        if (!(pid = fork()))  /* grandchild */
+        if (!(pid = spawn_fork()))  /* grandchild */
         {
+            reset_signal_handlers();
+            sigprocmask( SIG_SETMASK, &old_set, NULL );
             close( fd[0] );
 
             if (flags & (CREATE_NEW_PROCESS_GROUP | CREATE_NEW_CONSOLE | DETACHED_PROCESS))
@@ -1553,6 +1602,7 @@ static int fork_and_exec( const char *filename, const WCHAR *cmdline, const WCHA
 
         _exit(0); /* child if fork succeeded */
     }
+    sigprocmask( SIG_SETMASK, &old_set, NULL );
     HeapFree( GetProcessHeap(), 0, argv );
     HeapFree( GetProcessHeap(), 0, envp );
     if (stdin_fd != -1) close( stdin_fd );
@@ -1795,6 +1845,58 @@ static BOOL terminate_main_thread(void)
 }
 #endif
 
+/***********************************************************************
+ *           build_loader_envp
+ *
+ * Build the environment of the new loader: ours, with the given
+ * NAME=value strings replacing any existing definitions.
+ */
+static char **build_loader_envp( char **vars )
+{
+    char **envp, **src;
+    int count = 1, i;
+
+    for (src = environ; *src; src++) count++;
+    for (i = 0; vars[i]; i++) count++;
+
+    if (!(envp = HeapAlloc( GetProcessHeap(), 0, count * sizeof(*envp) ))) return NULL;
+
+    count = 0;
+    for (src = environ; *src; src++)
+    {
+        for (i = 0; vars[i]; i++)
+            if (!strncmp( *src, vars[i], strchr( vars[i], '=' ) - vars[i] + 1 )) break;
+        if (!vars[i]) envp[count++] = *src;
+    }
+    for (i = 0; vars[i]; i++) envp[count++] = vars[i];
+    envp[count] = NULL;
+    return envp;
+}
+
+
+/***********************************************************************
+ *           exec_loader_paths
+ *
+ * Try the candidates returned by wine_get_wine_binary_paths in order.
+ * argv has two free entries in front for the preloader and the loader.
+ */
+static void exec_loader_paths( char **paths, char **argv, char **envp )
+{
+    int i;
+
+    for (i = 0; paths[i]; i += 2)
+    {
+        argv[1] = paths[i + 1];
+        if (paths[i][0])
+        {
+            argv[0] = paths[i];
+            execve( argv[0], argv, envp );
+        }
+        execve( argv[1], argv + 1, envp );
+    }
+}
+
+
 /***********************************************************************
  *           exec_loader
  */
@@ -1805,18 +1907,40 @@ static pid_t exec_loader( LPCWSTR cmd_line, unsigned int flags, int socketfd,
     pid_t pid;
     char *wineloader = NULL;
     const char *loader = NULL;
-    char **argv;
-
-    argv = build_argv( cmd_line, 1 );
+    char **argv, **envp, **paths, *vars[5];
+    char preloader_reserve[64], socket_env[64];
+    sigset_t all_set, old_set;
+    int count = 0;
 
     if (!is_win64 ^ !(binary_info->flags & BINARY_FLAG_64BIT))
         loader = get_alternate_loader( &wineloader );
 
-    if (exec_only || !(pid = fork()))  /* child */
+    sprintf( socket_env, "WINESERVERSOCKET=%u", socketfd );
+    sprintf( preloader_reserve, "WINEPRELOADRESERVE=%lx-%lx",
+             (unsigned long)binary_info->res_start, (unsigned long)binary_info->res_end );
+
+    vars[count++] = preloader_reserve;
+    vars[count++] = socket_env;
+    if (winedebug) vars[count++] = winedebug;
+    if (wineloader) vars[count++] = wineloader;
+    vars[count] = NULL;
+
+    argv = build_argv( cmd_line, 2 );
+    envp = build_loader_envp( vars );
+    paths = wine_get_wine_binary_paths( loader, wineloader ? wineloader + sizeof("WINELOADER=") - 1
+                                                           : getenv("WINELOADER") );
+
+    /* keep our handlers from running in the children until they are reset */
+    sigfillset( &all_set );
+    sigprocmask( SIG_BLOCK, &all_set, &old_set );
+
+    /* everything the grandchild needs is prepared beforehand, so it can share our memory */
+    if (exec_only || !(pid = spawn_fork()))  /* child */
     {
-        if (exec_only || !(pid = fork()))  /* grandchild */
+        if (exec_only || !(pid = spawn_fork()))  /* grandchild */
         {
-            char preloader_reserve[64], socket_env[64];
+            reset_signal_handlers();
+            sigprocmask( SIG_SETMASK, &old_set, NULL );
 
             if (flags & (CREATE_NEW_PROCESS_GROUP | CREATE_NEW_CONSOLE | DETACHED_PROCESS))
             {
@@ -1842,21 +1966,13 @@ static pid_t exec_loader( LPCWSTR cmd_line, unsigned int flags, int socketfd,
             /* Reset signals that we previously set to SIG_IGN */
             signal( SIGPIPE, SIG_DFL );
 
-            sprintf( socket_env, "WINESERVERSOCKET=%u", socketfd );
-            sprintf( preloader_reserve, "WINEPRELOADRESERVE=%lx-%lx",
-                     (unsigned long)binary_info->res_start, (unsigned long)binary_info->res_end );
-
-            putenv( preloader_reserve );
-            putenv( socket_env );
-            if (winedebug) putenv( winedebug );
-            if (wineloader) putenv( wineloader );
             if (unixdir) chdir(unixdir);
 
-            if (argv)
+            if (argv && envp)
             {
                 do
                 {
-                    wine_exec_wine_binary( loader, argv, getenv("WINELOADER") );
+                    exec_loader_paths( paths, argv, envp );
                 }
 #ifdef __APPLE__
                 while (errno == ENOTSUP && exec_only && terminate_main_thread());
@@ -1869,6 +1985,7 @@ static pid_t exec_loader( LPCWSTR cmd_line, unsigned int flags, int socketfd,
 
         _exit(pid == -1);
     }
+    sigprocmask( SIG_SETMASK, &old_set, NULL );
 
     if (pid != -1)
     {
@@ -1879,7 +1996,9 @@ static pid_t exec_loader( LPCWSTR cmd_line, unsigned int flags, int socketfd,
         } while (wret < 0 && errno == EINTR);
     }
 
+    wine_free_wine_binary_paths( paths );
     HeapFree( GetProcessHeap(), 0, wineloader );
+    HeapFree( GetProcessHeap(), 0, envp );
     HeapFree( GetProcessHeap(), 0, argv );
     return pid;
 }
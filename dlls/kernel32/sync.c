@@ -2140,6 +2140,47 @@ BOOL WINAPI GetQueuedCompletionStatus( HANDLE CompletionPort, LPDWORD lpNumberOf
     return FALSE;
 }
 
+/******************************************************************************
+ *		GetQueuedCompletionStatusEx (KERNEL32.@)
+ */
+BOOL WINAPI GetQueuedCompletionStatusEx( HANDLE port, OVERLAPPED_ENTRY *entries, ULONG count,
+                                         ULONG *written, DWORD timeout, BOOL alertable )
+{
+    FILE_IO_COMPLETION_INFORMATION info[64];
+    LARGE_INTEGER time;
+    NTSTATUS status;
+    ULONG i, removed;
+
+    TRACE("(%p,%p,%u,%p,%u,%d)\n", port, entries, count, written, timeout, alertable);
+
+    if (!count)
+    {
+        SetLastError( ERROR_INVALID_PARAMETER );
+        return FALSE;
+    }
+    if (count > sizeof(info) / sizeof(info[0])) count = sizeof(info) / sizeof(info[0]);
+
+    status = NtRemoveIoCompletionEx( port, info, count, &removed, get_nt_timeout( &time, timeout ),
+                                     alertable );
+    *written = removed;
+    if (status == STATUS_SUCCESS)
+    {
+        for (i = 0; i < removed; i++)
+        {
+            entries[i].lpCompletionKey            = info[i].CompletionKey;
+            entries[i].lpOverlapped               = (LPOVERLAPPED)info[i].CompletionValue;
+            entries[i].Internal                   = info[i].IoStatusBlock.u.Status;
+            entries[i].dwNumberOfBytesTransferred = info[i].IoStatusBlock.Information;
+        }
+        return TRUE;
+    }
+
+    if (status == STATUS_TIMEOUT) SetLastError( WAIT_TIMEOUT );
+    else if (status == STATUS_USER_APC) SetLastError( WAIT_IO_COMPLETION );
+    else SetLastError( RtlNtStatusToDosError(status) );
+    return FALSE;
+}
+
 
 /******************************************************************************
  *		PostQueuedCompletionStatus (KERNEL32.@)
@@ -699,6 +699,84 @@ static void test_readdirectorychanges_null(void)
     ok( r == TRUE, "failed to remove directory\n");
 }
 
+static void test_readdirectorychanges_many(void)
+{
+    char path[MAX_PATH], file[MAX_PATH + 64];
+    static DWORD buffer[0x4000];
+    FILE_NOTIFY_INFORMATION *pfni;
+    OVERLAPPED ov;
+    HANDLE hdir, hfile;
+    DWORD r, i;
+
+    if (!pReadDirectoryChangesW)
+    {
+        win_skip("ReadDirectoryChangesW is not available\n");
+        return;
+    }
+
+    GetTempPathA( MAX_PATH, path );
+    lstrcatA( path, "many" );
+    RemoveDirectoryA( path );
+    r = CreateDirectoryA( path, NULL );
+    ok( r == TRUE, "failed to create directory\n" );
+
+    hdir = CreateFileA( path, GENERIC_READ|SYNCHRONIZE|FILE_LIST_DIRECTORY,
+                        FILE_SHARE_READ|FILE_SHARE_WRITE|FILE_SHARE_DELETE, NULL,
+                        OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL );
+    ok( hdir != INVALID_HANDLE_VALUE, "failed to open directory\n" );
+
+    memset( &ov, 0, sizeof(ov) );
+    ov.hEvent = CreateEvent( NULL, 1, 0, NULL );
+    r = pReadDirectoryChangesW( hdir, buffer, sizeof(buffer), FALSE, FILE_NOTIFY_CHANGE_FILE_NAME,
+                                NULL, &ov, NULL );
+    ok( r == TRUE, "should return true\n" );
+
+    sprintf( file, "%s\\first", path );
+    hfile = CreateFileA( file, GENERIC_WRITE, 0, NULL, CREATE_NEW, FILE_FLAG_DELETE_ON_CLOSE, NULL );
+    ok( hfile != INVALID_HANDLE_VALUE, "failed to create file\n" );
+    r = WaitForSingleObject( ov.hEvent, 1000 );
+    ok( r == WAIT_OBJECT_0, "event should be ready\n" );
+    CloseHandle( hfile );
+    Sleep( 100 );
+
+    /* queue more changes than a single read from the server returns */
+    for (i = 0; i < 100; i++)
+    {
+        sprintf( file, "%s\\a_file_with_a_rather_long_name_%03u", path, i );
+        hfile = CreateFileA( file, GENERIC_WRITE, 0, NULL, CREATE_NEW, 0, NULL );
+        ok( hfile != INVALID_HANDLE_VALUE, "failed to create %s\n", file );
+        CloseHandle( hfile );
+    }
+
+    ResetEvent( ov.hEvent );
+    ov.Internal = 0xdeadbeef;
+    ov.InternalHigh = 0;
+    r = pReadDirectoryChangesW( hdir, buffer, sizeof(buffer), FALSE, FILE_NOTIFY_CHANGE_FILE_NAME,
+                                NULL, &ov, NULL );
+    ok( r == TRUE, "should return true\n" );
+    r = WaitForSingleObject( ov.hEvent, 1000 );
+    ok( r == WAIT_OBJECT_0, "event should be ready\n" );
+    ok( ov.Internal == STATUS_SUCCESS, "ov.Internal is %lx\n", ov.Internal );
+    ok( ov.InternalHigh > 0, "no changes returned\n" );
+
+    pfni = (FILE_NOTIFY_INFORMATION *)buffer;
+    if (ov.InternalHigh)
+        ok( pfni->Action == FILE_ACTION_ADDED || pfni->Action == FILE_ACTION_REMOVED,
+            "action wrong %d\n", pfni->Action );
+
+    CancelIo( hdir );
+    CloseHandle( ov.hEvent );
+    CloseHandle( hdir );
+
+    for (i = 0; i < 100; i++)
+    {
+        sprintf( file, "%s\\a_file_with_a_rather_long_name_%03u", path, i );
+        DeleteFileA( file );
+    }
+    r = RemoveDirectoryA( path );
+    ok( r == TRUE, "failed to remove directory\n" );
+}
+
 static void test_readdirectorychanges_filedir(void)
 {
     NTSTATUS r;
@@ -1100,6 +1178,7 @@ START_TEST(change)
     test_readdirectorychanges();
     test_readdirectorychanges_null();
     test_readdirectorychanges_filedir();
+    test_readdirectorychanges_many();
     test_readdirectorychanges_cr();
     test_ffcn_directory_overlap();
 }
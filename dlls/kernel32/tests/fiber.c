@@ -36,6 +36,8 @@ static BOOL (WINAPI *pFlsSetValue)(DWORD,PVOID);
 static LPVOID fibers[2];
 static BYTE testparam = 185;
 static WORD cbCount;
+static DWORD switchCount;
+static DWORD switchFls = FLS_OUT_OF_INDEXES;
 
 static VOID init_funcs(void)
 {
@@ -71,6 +73,18 @@ static VOID WINAPI FiberMainProc(LPVOID lpFiberParameter)
     pSwitchToFiber(fibers[0]);
 }
 
+static VOID WINAPI FiberPingPongProc(LPVOID lpFiberParameter)
+{
+    ok(lpFiberParameter == &switchCount, "Parameterdata expected not to be changed\n");
+    if (switchFls != FLS_OUT_OF_INDEXES)
+        ok(!pFlsGetValue(switchFls), "new fiber should not see the FLS data of the thread\n");
+    for (;;)
+    {
+        switchCount++;
+        pSwitchToFiber(fibers[0]);
+    }
+}
+
 static void test_ConvertThreadToFiber(void)
 {
     if (pConvertThreadToFiber)
@@ -183,6 +197,45 @@ static void test_FiberLocalStorage(PFLS_CALLBACK_FUNCTION cbfunc)
         todo_wine ok(cbCount == 1, "Wrong callback count: %d\n", cbCount);
 }
 
+static void test_FiberSwitching(void)
+{
+    DWORD i;
+
+    if (!pConvertThreadToFiberEx || !pCreateFiberEx)
+    {
+        win_skip( "ConvertThreadToFiberEx or CreateFiberEx not present\n" );
+        return;
+    }
+
+    fibers[0] = pConvertThreadToFiberEx(&testparam, FIBER_FLAG_FLOAT_SWITCH);
+    ok(fibers[0] != 0, "ConvertThreadToFiberEx failed with error %d\n", GetLastError());
+    fibers[1] = pCreateFiberEx(0, 0, FIBER_FLAG_FLOAT_SWITCH, FiberPingPongProc, &switchCount);
+    ok(fibers[1] != 0, "CreateFiberEx failed with error %d\n", GetLastError());
+
+    if (pFlsAlloc)
+    {
+        switchFls = pFlsAlloc(NULL);
+        ok(switchFls != FLS_OUT_OF_INDEXES, "FlsAlloc failed with error %d\n", GetLastError());
+        pFlsSetValue(switchFls, (PVOID)0xdeadbeef);
+    }
+
+    switchCount = 0;
+    for (i = 0; i < 100000; i++) pSwitchToFiber(fibers[1]);
+    ok(switchCount == 100000, "Wrong switch count: %d\n", switchCount);
+    ok(GetCurrentFiber() == fibers[0], "Wrong current fiber %p/%p\n", GetCurrentFiber(), fibers[0]);
+    ok(GetFiberData() == &testparam, "Wrong fiber data %p\n", GetFiberData());
+
+    if (switchFls != FLS_OUT_OF_INDEXES)
+    {
+        ok(pFlsGetValue(switchFls) == (PVOID)0xdeadbeef, "FLS data not restored\n");
+        pFlsFree(switchFls);
+        switchFls = FLS_OUT_OF_INDEXES;
+    }
+
+    pDeleteFiber(fibers[1]);
+    test_ConvertFiberToThread();
+}
+
 START_TEST(fiber)
 {
     init_funcs();
@@ -194,6 +247,7 @@ START_TEST(fiber)
     }
 
     test_FiberHandling();
+    test_FiberSwitching();
     test_FiberLocalStorage(NULL);
     test_FiberLocalStorage(FiberLocalStorageProc);
 }
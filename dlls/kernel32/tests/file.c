@@ -43,6 +43,8 @@ static DWORD (WINAPI *pQueueUserAPC)(PAPCFUNC pfnAPC, HANDLE hThread, ULONG_PTR
 static BOOL (WINAPI *pGetFileInformationByHandleEx)(HANDLE, FILE_INFO_BY_HANDLE_CLASS, LPVOID, DWORD);
 static HANDLE (WINAPI *pOpenFileById)(HANDLE, LPFILE_ID_DESCRIPTOR, DWORD, DWORD, LPSECURITY_ATTRIBUTES, DWORD);
 static BOOL (WINAPI *pSetFileValidData)(HANDLE, LONGLONG);
+static BOOL (WINAPI *pReadFileScatter)(HANDLE, FILE_SEGMENT_ELEMENT *, DWORD, LPDWORD, LPOVERLAPPED);
+static BOOL (WINAPI *pWriteFileGather)(HANDLE, FILE_SEGMENT_ELEMENT *, DWORD, LPDWORD, LPOVERLAPPED);
 
 /* keep filename and filenameW the same */
 static const char filename[] = "testfile.xxx";
@@ -80,6 +82,8 @@ static void InitFunctionPointers(void)
     pGetFileInformationByHandleEx = (void *) GetProcAddress(hkernel32, "GetFileInformationByHandleEx");
     pOpenFileById = (void *) GetProcAddress(hkernel32, "OpenFileById");
     pSetFileValidData = (void *) GetProcAddress(hkernel32, "SetFileValidData");
+    pReadFileScatter = (void *) GetProcAddress(hkernel32, "ReadFileScatter");
+    pWriteFileGather = (void *) GetProcAddress(hkernel32, "WriteFileGather");
 }
 
 static void test__hread( void )
@@ -789,6 +793,87 @@ static void test_CopyFileW(void)
 }
 
 
+struct copy_progress_data
+{
+    DWORD calls;
+    DWORD stream_switch;
+    DWORD action;
+    LONGLONG transferred;
+};
+
+static DWORD WINAPI copy_progress( LARGE_INTEGER total, LARGE_INTEGER transferred,
+                                   LARGE_INTEGER stream_size, LARGE_INTEGER stream_transferred,
+                                   DWORD stream, DWORD reason, HANDLE source, HANDLE dest, LPVOID param )
+{
+    struct copy_progress_data *data = param;
+
+    ok(stream == 1, "wrong stream %u\n", stream);
+    ok(transferred.QuadPart >= data->transferred, "transferred went backwards\n");
+    ok(transferred.QuadPart <= total.QuadPart, "transferred %u > total %u\n",
+       transferred.u.LowPart, total.u.LowPart);
+    if (reason == CALLBACK_STREAM_SWITCH) data->stream_switch++;
+    data->transferred = transferred.QuadPart;
+    data->calls++;
+    return data->action;
+}
+
+static void test_CopyFileEx(void)
+{
+    char temp_path[MAX_PATH], source[MAX_PATH], dest[MAX_PATH];
+    struct copy_progress_data data;
+    DWORD ret, size = 3 * 65536 + 123, written;
+    HANDLE hfile;
+    char *buffer;
+
+    GetTempPathA(MAX_PATH, temp_path);
+    GetTempFileNameA(temp_path, "cfe", 0, source);
+    GetTempFileNameA(temp_path, "cfe", 0, dest);
+
+    buffer = HeapAlloc(GetProcessHeap(), 0, size);
+    for (ret = 0; ret < size; ret++) buffer[ret] = ret * 7;
+    hfile = CreateFileA(source, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, 0);
+    ok(hfile != INVALID_HANDLE_VALUE, "CreateFile error %u\n", GetLastError());
+    ret = WriteFile(hfile, buffer, size, &written, NULL);
+    ok(ret && written == size, "WriteFile error %u\n", GetLastError());
+    CloseHandle(hfile);
+
+    memset(&data, 0, sizeof(data));
+    data.action = PROGRESS_CONTINUE;
+    ret = CopyFileExA(source, dest, copy_progress, &data, NULL, 0);
+    ok(ret, "CopyFileExA error %u\n", GetLastError());
+    ok(data.stream_switch == 1, "got %u stream switches\n", data.stream_switch);
+    ok(data.calls >= 2, "got %u calls\n", data.calls);
+    ok(data.transferred == size, "got %u bytes transferred\n", (DWORD)data.transferred);
+
+    memset(buffer, 0, size);
+    hfile = CreateFileA(dest, GENERIC_READ, 0, NULL, OPEN_EXISTING, 0, 0);
+    ok(hfile != INVALID_HANDLE_VALUE, "CreateFile error %u\n", GetLastError());
+    ret = ReadFile(hfile, buffer, size, &written, NULL);
+    ok(ret && written == size, "ReadFile error %u, got %u bytes\n", GetLastError(), written);
+    for (ret = 0; ret < size; ret++) if (buffer[ret] != (char)(ret * 7)) break;
+    ok(ret == size, "data mismatch at %u\n", ret);
+    CloseHandle(hfile);
+
+    memset(&data, 0, sizeof(data));
+    data.action = PROGRESS_CANCEL;
+    SetLastError(0xdeadbeef);
+    ret = CopyFileExA(source, dest, copy_progress, &data, NULL, 0);
+    ok(!ret, "CopyFileExA succeeded\n");
+    ok(GetLastError() == ERROR_REQUEST_ABORTED, "wrong error %u\n", GetLastError());
+    ok(data.calls == 1, "got %u calls\n", data.calls);
+    ok(GetFileAttributesA(dest) == INVALID_FILE_ATTRIBUTES, "destination not removed\n");
+
+    memset(&data, 0, sizeof(data));
+    data.action = PROGRESS_QUIET;
+    ret = CopyFileExA(source, dest, copy_progress, &data, NULL, 0);
+    ok(ret, "CopyFileExA error %u\n", GetLastError());
+    ok(data.calls == 1, "got %u calls\n", data.calls);
+
+    HeapFree(GetProcessHeap(), 0, buffer);
+    DeleteFileA(source);
+    DeleteFileA(dest);
+}
+
 /*
  *   Debugging routine to dump a buffer in a hexdump-like fashion.
  */
@@ -2852,6 +2937,51 @@ static void test_overlapped(void)
     ok( r == TRUE, "close handle failed\n");
 }
 
+static void test_overlapped_large_read(void)
+{
+    static const DWORD file_size = 16 * 1024 * 1024, read_size = 8 * 1024 * 1024;
+    char temp_path[MAX_PATH], temp_file[MAX_PATH];
+    OVERLAPPED ov;
+    HANDLE hfile;
+    DWORD *buf, count, i, bad;
+    BOOL ret;
+
+    GetTempPathA(MAX_PATH, temp_path);
+    GetTempFileNameA(temp_path, "ovl", 0, temp_file);
+    buf = VirtualAlloc(NULL, file_size, MEM_COMMIT, PAGE_READWRITE);
+    for (i = 0; i < file_size / sizeof(DWORD); i++) buf[i] = i;
+
+    hfile = CreateFileA(temp_file, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, 0);
+    ok(hfile != INVALID_HANDLE_VALUE, "CreateFile error %u\n", GetLastError());
+    ret = WriteFile(hfile, buf, file_size, &count, NULL);
+    ok(ret && count == file_size, "WriteFile error %u, wrote %u\n", GetLastError(), count);
+    CloseHandle(hfile);
+
+    /* unbuffered so that the data has to come from the disk, the read may
+     * complete from the cache in part only but it still returns everything */
+    hfile = CreateFileA(temp_file, GENERIC_READ, 0, NULL, OPEN_EXISTING,
+                        FILE_FLAG_OVERLAPPED | FILE_FLAG_NO_BUFFERING, 0);
+    ok(hfile != INVALID_HANDLE_VALUE, "CreateFile error %u\n", GetLastError());
+    memset(buf, 0, file_size);
+    memset(&ov, 0, sizeof(ov));
+    ov.Offset = 4 * 1024 * 1024;
+    ov.hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+    ret = ReadFile(hfile, buf, read_size, NULL, &ov);
+    ok(ret || GetLastError() == ERROR_IO_PENDING, "ReadFile error %u\n", GetLastError());
+    count = 0;
+    ret = GetOverlappedResult(hfile, &ov, &count, TRUE);
+    ok(ret, "GetOverlappedResult error %u\n", GetLastError());
+    ok(count == read_size, "expected %u bytes, got %u\n", read_size, count);
+    for (i = bad = 0; i < read_size / sizeof(DWORD); i++)
+        if (buf[i] != i + ov.Offset / sizeof(DWORD)) bad++;
+    ok(!bad, "%u wrong values\n", bad);
+
+    CloseHandle(ov.hEvent);
+    CloseHandle(hfile);
+    VirtualFree(buf, 0, MEM_RELEASE);
+    DeleteFileA(temp_file);
+}
+
 static void test_RemoveDirectory(void)
 {
     int rc;
@@ -3442,6 +3572,150 @@ static void test_OpenFileById(void)
     DeleteFile(tempFileName);
 }
 
+static void test_ReadFileScatter(void)
+{
+    char temp_path[MAX_PATH], temp_file[MAX_PATH];
+    FILE_SEGMENT_ELEMENT segments[5];
+    OVERLAPPED ovl;
+    SYSTEM_INFO si;
+    HANDLE hfile, event;
+    DWORD count, page, i;
+    char *wbuf, *rbuf;
+    BOOL ret;
+
+    if (!pReadFileScatter || !pWriteFileGather)
+    {
+        win_skip("ReadFileScatter/WriteFileGather are not available\n");
+        return;
+    }
+
+    GetSystemInfo(&si);
+    page = si.dwPageSize;
+
+    GetTempPathA(MAX_PATH, temp_path);
+    GetTempFileNameA(temp_path, "sg", 0, temp_file);
+    hfile = CreateFileA(temp_file, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                        FILE_FLAG_NO_BUFFERING | FILE_FLAG_OVERLAPPED, 0);
+    ok(hfile != INVALID_HANDLE_VALUE, "CreateFile error %u\n", GetLastError());
+    if (hfile == INVALID_HANDLE_VALUE) return;
+
+    wbuf = VirtualAlloc(NULL, 4 * page, MEM_COMMIT, PAGE_READWRITE);
+    rbuf = VirtualAlloc(NULL, 4 * page, MEM_COMMIT, PAGE_READWRITE);
+    for (i = 0; i < 4 * page; i++) wbuf[i] = i / page + 'a';
+    event = CreateEventA(NULL, TRUE, FALSE, NULL);
+
+    /* write the pages in reverse order */
+    memset(segments, 0, sizeof(segments));
+    for (i = 0; i < 4; i++)
+        segments[i].Buffer = wbuf + (3 - i) * page;
+
+    memset(&ovl, 0, sizeof(ovl));
+    ovl.hEvent = event;
+    ret = pWriteFileGather(hfile, segments, 4 * page, NULL, &ovl);
+    ok(ret || GetLastError() == ERROR_IO_PENDING, "WriteFileGather error %u\n", GetLastError());
+    count = 0;
+    ret = GetOverlappedResult(hfile, &ovl, &count, TRUE);
+    ok(ret, "GetOverlappedResult error %u\n", GetLastError());
+    ok(count == 4 * page, "expected %u, got %u\n", 4 * page, count);
+
+    /* read them back in order, starting from the second page */
+    for (i = 0; i < 3; i++)
+        segments[i].Buffer = rbuf + i * page;
+    segments[3].Buffer = NULL;
+
+    memset(&ovl, 0, sizeof(ovl));
+    ovl.Offset = page;
+    ovl.hEvent = event;
+    ret = pReadFileScatter(hfile, segments, 3 * page, NULL, &ovl);
+    ok(ret || GetLastError() == ERROR_IO_PENDING, "ReadFileScatter error %u\n", GetLastError());
+    count = 0;
+    ret = GetOverlappedResult(hfile, &ovl, &count, TRUE);
+    ok(ret, "GetOverlappedResult error %u\n", GetLastError());
+    ok(count == 3 * page, "expected %u, got %u\n", 3 * page, count);
+    for (i = 0; i < 3; i++)
+        ok(rbuf[i * page] == 'c' - i && rbuf[(i + 1) * page - 1] == 'c' - i,
+           "page %u: got %c\n", i, rbuf[i * page]);
+
+    /* the length has to be a multiple of the page size */
+    memset(&ovl, 0, sizeof(ovl));
+    ovl.hEvent = event;
+    SetLastError(0xdeadbeef);
+    ret = pReadFileScatter(hfile, segments, 3 * page - 1, NULL, &ovl);
+    ok(!ret, "ReadFileScatter succeeded\n");
+    ok(GetLastError() == ERROR_INVALID_PARAMETER, "wrong error %u\n", GetLastError());
+
+    CloseHandle(event);
+    CloseHandle(hfile);
+    VirtualFree(wbuf, 0, MEM_RELEASE);
+    VirtualFree(rbuf, 0, MEM_RELEASE);
+    DeleteFileA(temp_file);
+}
+
+static void test_ReadFileScatter_large(void)
+{
+    static const DWORD pages = 600;  /* more than a single vectored I/O call */
+    char temp_path[MAX_PATH], temp_file[MAX_PATH];
+    FILE_SEGMENT_ELEMENT *segments;
+    OVERLAPPED ovl;
+    SYSTEM_INFO si;
+    HANDLE hfile;
+    DWORD count, page, i, bad;
+    char *wbuf, *rbuf;
+    BOOL ret;
+
+    if (!pReadFileScatter || !pWriteFileGather)
+    {
+        win_skip("ReadFileScatter/WriteFileGather are not available\n");
+        return;
+    }
+
+    GetSystemInfo(&si);
+    page = si.dwPageSize;
+
+    GetTempPathA(MAX_PATH, temp_path);
+    GetTempFileNameA(temp_path, "sg", 0, temp_file);
+    hfile = CreateFileA(temp_file, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                        FILE_FLAG_NO_BUFFERING | FILE_FLAG_OVERLAPPED, 0);
+    ok(hfile != INVALID_HANDLE_VALUE, "CreateFile error %u\n", GetLastError());
+    if (hfile == INVALID_HANDLE_VALUE) return;
+
+    wbuf = VirtualAlloc(NULL, pages * page, MEM_COMMIT, PAGE_READWRITE);
+    rbuf = VirtualAlloc(NULL, pages * page, MEM_COMMIT, PAGE_READWRITE);
+    segments = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, (pages + 1) * sizeof(*segments));
+    for (i = 0; i < pages * page; i++) wbuf[i] = i / page;
+    memset(&ovl, 0, sizeof(ovl));
+    ovl.hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+
+    for (i = 0; i < pages; i++) segments[i].Buffer = wbuf + i * page;
+    ret = pWriteFileGather(hfile, segments, pages * page, NULL, &ovl);
+    ok(ret || GetLastError() == ERROR_IO_PENDING, "WriteFileGather error %u\n", GetLastError());
+    count = 0;
+    ret = GetOverlappedResult(hfile, &ovl, &count, TRUE);
+    ok(ret, "GetOverlappedResult error %u\n", GetLastError());
+    ok(count == pages * page, "expected %u, got %u\n", pages * page, count);
+
+    /* read the pages back in reverse order */
+    for (i = 0; i < pages; i++) segments[i].Buffer = rbuf + (pages - 1 - i) * page;
+    ResetEvent(ovl.hEvent);
+    ret = pReadFileScatter(hfile, segments, pages * page, NULL, &ovl);
+    ok(ret || GetLastError() == ERROR_IO_PENDING, "ReadFileScatter error %u\n", GetLastError());
+    count = 0;
+    ret = GetOverlappedResult(hfile, &ovl, &count, TRUE);
+    ok(ret, "GetOverlappedResult error %u\n", GetLastError());
+    ok(count == pages * page, "expected %u, got %u\n", pages * page, count);
+    for (i = bad = 0; i < pages; i++)
+        if (rbuf[i * page] != (char)(pages - 1 - i) || rbuf[(i + 1) * page - 1] != (char)(pages - 1 - i))
+            bad++;
+    ok(!bad, "%u wrong pages\n", bad);
+
+    CloseHandle(ovl.hEvent);
+    CloseHandle(hfile);
+    HeapFree(GetProcessHeap(), 0, segments);
+    VirtualFree(wbuf, 0, MEM_RELEASE);
+    VirtualFree(rbuf, 0, MEM_RELEASE);
+    DeleteFileA(temp_file);
+}
+
 static void test_SetFileValidData(void)
 {
     BOOL ret;
@@ -3591,6 +3865,7 @@ START_TEST(file)
     test_GetTempFileNameA();
     test_CopyFileA();
     test_CopyFileW();
+    test_CopyFileEx();
     test_CreatFile();
     test_CreateFileA();
     test_CreateFileW();
@@ -3612,10 +3887,13 @@ START_TEST(file)
     test_read_write();
     test_OpenFile();
     test_overlapped();
+    test_overlapped_large_read();
     test_RemoveDirectory();
     test_ReplaceFileA();
     test_ReplaceFileW();
     test_GetFileInformationByHandleEx();
     test_OpenFileById();
     test_SetFileValidData();
+    test_ReadFileScatter();
+    test_ReadFileScatter_large();
 }
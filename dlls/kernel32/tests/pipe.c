@@ -1860,6 +1860,58 @@ static void test_readfileex_pending(void)
     CloseHandle(event);
 }
 
+static DWORD CALLBACK flush_reader(LPVOID arg)
+{
+    HANDLE server = arg;
+    char buf[16];
+    DWORD num;
+    BOOL ret;
+
+    Sleep(50);
+    ret = ReadFile(server, buf, sizeof(buf), &num, NULL);
+    ok(ret, "ReadFile failed with error %d\n", GetLastError());
+    ok(num == 4, "read %d bytes\n", num);
+    return 0;
+}
+
+static void test_client_flush(void)
+{
+    HANDLE server, client, thread;
+    DWORD num, avail;
+    BOOL ret;
+
+    server = CreateNamedPipe(PIPENAME, PIPE_ACCESS_DUPLEX, PIPE_TYPE_BYTE | PIPE_WAIT,
+        /* nMaxInstances */ 1,
+        /* nOutBufSize */ 1024,
+        /* nInBufSize */ 1024,
+        /* nDefaultWait */ NMPWAIT_USE_DEFAULT_WAIT,
+        /* lpSecurityAttrib */ NULL);
+    ok(server != INVALID_HANDLE_VALUE, "CreateNamedPipe failed\n");
+    client = CreateFileA(PIPENAME, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, 0);
+    ok(client != INVALID_HANDLE_VALUE, "CreateFile failed with error %d\n", GetLastError());
+
+    /* flushing with nothing written returns immediately */
+    ret = FlushFileBuffers(client);
+    ok(ret, "FlushFileBuffers failed with error %d\n", GetLastError());
+
+    ret = WriteFile(client, "test", 4, &num, NULL);
+    ok(ret, "WriteFile failed with error %d\n", GetLastError());
+
+    /* the flush waits until the server has read the data */
+    thread = CreateThread(NULL, 0, flush_reader, server, 0, NULL);
+    ret = FlushFileBuffers(client);
+    ok(ret, "FlushFileBuffers failed with error %d\n", GetLastError());
+    avail = 0xdeadbeef;
+    ret = PeekNamedPipe(server, NULL, 0, NULL, &avail, NULL);
+    ok(ret, "PeekNamedPipe failed with error %d\n", GetLastError());
+    ok(avail == 0, "%d bytes still available\n", avail);
+
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+    CloseHandle(client);
+    CloseHandle(server);
+}
+
 START_TEST(pipe)
 {
     HMODULE hmod;
@@ -1880,4 +1932,5 @@ START_TEST(pipe)
     test_overlapped();
     test_NamedPipeHandleState();
     test_readfileex_pending();
+    test_client_flush();
 }
@@ -63,6 +63,8 @@ static BOOL   (WINAPI *pVirtualFreeEx)(HANDLE, LPVOID, SIZE_T, DWORD);
 static BOOL   (WINAPI *pQueryFullProcessImageNameA)(HANDLE hProcess, DWORD dwFlags, LPSTR lpExeName, PDWORD lpdwSize);
 static BOOL   (WINAPI *pQueryFullProcessImageNameW)(HANDLE hProcess, DWORD dwFlags, LPWSTR lpExeName, PDWORD lpdwSize);
 static DWORD  (WINAPI *pK32GetProcessImageFileNameA)(HANDLE,LPSTR,DWORD);
+static LPWSTR (CDECL *pwine_get_dos_file_name)(LPCSTR);
+static LPSTR  (CDECL *pwine_get_unix_file_name)(LPCWSTR);
 
 /* ############################### */
 static char     base[MAX_PATH];
@@ -206,6 +208,8 @@ static int     init(void)
     pQueryFullProcessImageNameA = (void *) GetProcAddress(hkernel32, "QueryFullProcessImageNameA");
     pQueryFullProcessImageNameW = (void *) GetProcAddress(hkernel32, "QueryFullProcessImageNameW");
     pK32GetProcessImageFileNameA = (void *) GetProcAddress(hkernel32, "K32GetProcessImageFileNameA");
+    pwine_get_dos_file_name = (void *) GetProcAddress(hkernel32, "wine_get_dos_file_name");
+    pwine_get_unix_file_name = (void *) GetProcAddress(hkernel32, "wine_get_unix_file_name");
     return 1;
 }
 
@@ -1507,6 +1511,111 @@ static  void    test_ExitCode(void)
     assert(DeleteFileA(resfile) != 0);
 }
 
+static void test_ManyChildren(void)
+{
+    char                buffer[MAX_PATH], files[8][MAX_PATH];
+    PROCESS_INFORMATION info[8];
+    STARTUPINFOA        startup;
+    DWORD               code, i;
+
+    memset(&startup, 0, sizeof(startup));
+    startup.cb = sizeof(startup);
+
+    /* start all the children before waiting for any of them */
+    for (i = 0; i < 8; i++)
+    {
+        get_file_name(files[i]);
+        sprintf(buffer, "\"%s\" tests/process.c \"%s\" exit_code", selfname, files[i]);
+        ok(CreateProcessA(NULL, buffer, NULL, NULL, FALSE, 0, NULL, NULL, &startup, &info[i]),
+           "CreateProcess %u failed %u\n", i, GetLastError());
+    }
+
+    for (i = 0; i < 8; i++)
+    {
+        ok(WaitForSingleObject(info[i].hProcess, 30000) == WAIT_OBJECT_0, "child %u didn't terminate\n", i);
+        ok(GetExitCodeProcess(info[i].hProcess, &code), "GetExitCodeProcess failed %u\n", GetLastError());
+        ok(code == 123, "child %u exited with %u\n", i, code);
+        CloseHandle(info[i].hProcess);
+        CloseHandle(info[i].hThread);
+        DeleteFileA(files[i]);
+    }
+}
+
+static void test_UnixChildren(void)
+{
+    char                sh[MAX_PATH], file[MAX_PATH], buffer[MAX_PATH + 64];
+    WCHAR               fileW[MAX_PATH], *shW;
+    char               *unix_file;
+    PROCESS_INFORMATION info;
+    STARTUPINFOA        startup;
+    HANDLE              hFile;
+    DWORD               size, i;
+    BOOL                ret;
+
+    if (!pwine_get_dos_file_name || !pwine_get_unix_file_name)
+    {
+        win_skip("Unix binaries can only be started on Wine\n");
+        return;
+    }
+    shW = pwine_get_dos_file_name("/bin/sh");
+    if (!shW || GetFileAttributesW(shW) == INVALID_FILE_ATTRIBUTES)
+    {
+        skip("/bin/sh not found\n");
+        HeapFree(GetProcessHeap(), 0, shW);
+        return;
+    }
+    WideCharToMultiByte(CP_ACP, 0, shW, -1, sh, sizeof(sh), NULL, NULL);
+    HeapFree(GetProcessHeap(), 0, shW);
+
+    memset(&startup, 0, sizeof(startup));
+    startup.cb = sizeof(startup);
+
+    /* the child doesn't get a process handle, so have it create a file */
+    get_file_name(file);
+    DeleteFileA(file);
+    MultiByteToWideChar(CP_ACP, 0, file, -1, fileW, MAX_PATH);
+    unix_file = pwine_get_unix_file_name(fileW);
+    ok(unix_file != NULL, "no Unix name for %s\n", file);
+    if (!unix_file) return;
+    sprintf(buffer, "sh -c \"echo ok > '%s'\"", unix_file);
+    HeapFree(GetProcessHeap(), 0, unix_file);
+
+    ret = CreateProcessA(sh, buffer, NULL, NULL, FALSE, 0, NULL, NULL, &startup, &info);
+    ok(ret, "CreateProcess failed %u\n", GetLastError());
+    for (i = 0; ret && i < 100; i++)
+    {
+        hFile = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                            NULL, OPEN_EXISTING, 0, NULL);
+        if (hFile != INVALID_HANDLE_VALUE)
+        {
+            size = 0;
+            ReadFile(hFile, buffer, sizeof(buffer), &size, NULL);
+            CloseHandle(hFile);
+            if (size == 3) break;
+        }
+        Sleep(100);
+    }
+    if (ret)
+    {
+        ok(i < 100, "Unix child didn't run\n");
+        ok(!memcmp(buffer, "ok\n", 3), "wrong data %s\n", buffer);
+    }
+    DeleteFileA(file);
+
+    /* the exec failure is reported through the error pipe */
+    hFile = CreateFileA(file, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+    ok(hFile != INVALID_HANDLE_VALUE, "couldn't create %s\n", file);
+    WriteFile(hFile, "not a binary\n", 13, &size, NULL);
+    CloseHandle(hFile);
+
+    SetLastError(0xdeadbeef);
+    ret = CreateProcessA(file, file, NULL, NULL, FALSE, 0, NULL, NULL, &startup, &info);
+    ok(!ret, "CreateProcess succeeded\n");
+    ok(GetLastError() == ERROR_ACCESS_DENIED || GetLastError() == ERROR_BAD_FORMAT,
+       "wrong error %u\n", GetLastError());
+    DeleteFileA(file);
+}
+
 static void test_OpenProcess(void)
 {
     HANDLE hproc;
@@ -2080,6 +2189,8 @@ START_TEST(process)
     test_DebuggingFlag();
     test_Console();
     test_ExitCode();
+    test_ManyChildren();
+    test_UnixChildren();
     test_OpenProcess();
     test_GetProcessVersion();
     test_GetProcessImageFileNameA();
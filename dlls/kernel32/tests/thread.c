@@ -978,6 +978,60 @@ static void test_SetThreadContext(void)
 
 #endif  /* __i386__ */
 
+static LONG virtual_loop_done;
+
+static DWORD WINAPI virtual_loop_thread(LPVOID p)
+{
+    MEMORY_BASIC_INFORMATION info;
+    DWORD old_prot;
+    char *mem = p;
+
+    while (!virtual_loop_done)
+    {
+        VirtualQuery( mem, &info, sizeof(info) );
+        VirtualProtect( mem, 0x1000, PAGE_READONLY, &old_prot );
+        VirtualProtect( mem, 0x1000, PAGE_READWRITE, &old_prot );
+        mem[0]++;
+    }
+    return 0;
+}
+
+static void test_SuspendThread_virtual(void)
+{
+    HANDLE thread;
+    DWORD ret, i;
+    char *mem;
+
+    mem = VirtualAlloc( NULL, 0x1000, MEM_COMMIT, PAGE_READWRITE );
+    ok( mem != NULL, "VirtualAlloc failed %u\n", GetLastError() );
+    thread = CreateThread( NULL, 0, virtual_loop_thread, mem, 0, NULL );
+    ok( thread != NULL, "CreateThread failed %u\n", GetLastError() );
+
+    /* suspending a thread that is busy in virtual memory calls must neither
+     * deadlock nor lose the suspend request */
+    for (i = 0; i < 100; i++)
+    {
+        CONTEXT ctx;
+        char val;
+
+        ret = SuspendThread( thread );
+        ok( ret == 0, "SuspendThread returned %d\n", ret );
+        ctx.ContextFlags = CONTEXT_CONTROL;
+        ok( GetThreadContext( thread, &ctx ), "GetThreadContext failed %u\n", GetLastError() );
+        val = mem[0];
+        Sleep( 1 );
+        ok( mem[0] == val, "thread kept running while suspended\n" );
+        ret = ResumeThread( thread );
+        ok( ret == 1, "ResumeThread returned %d\n", ret );
+    }
+
+    virtual_loop_done = 1;
+    ret = WaitForSingleObject( thread, 5000 );
+    ok( ret == WAIT_OBJECT_0, "thread did not exit: %d\n", ret );
+    CloseHandle( thread );
+    VirtualFree( mem, 0, MEM_RELEASE );
+}
+
 static HANDLE finish_event;
 static LONG times_executed;
 
@@ -1500,6 +1554,7 @@ START_TEST(thread)
 #ifdef __i386__
    test_SetThreadContext();
 #endif
+   test_SuspendThread_virtual();
    test_QueueUserWorkItem();
    test_RegisterWaitForSingleObject();
    test_TLS();
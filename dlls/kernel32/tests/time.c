@@ -718,6 +718,48 @@ static void test_GetCalendarInfo(void)
     ok( ret == 5, "wrong size %u\n", ret );
 }
 
+static void test_counters(void)
+{
+    LARGE_INTEGER freq, start, prev, counter;
+    DWORD tick, elapsed_tick, elapsed_qpc, elapsed_time;
+    ULARGE_INTEGER start_time, end_time;
+    FILETIME ft;
+    int i;
+
+    ok( QueryPerformanceFrequency( &freq ), "QueryPerformanceFrequency failed\n" );
+    ok( freq.QuadPart > 0, "wrong frequency %x%08x\n", freq.u.HighPart, freq.u.LowPart );
+    GetSystemTimeAsFileTime( &ft );
+    QueryPerformanceCounter( &start );
+    tick = GetTickCount();
+    start_time.u.LowPart = ft.dwLowDateTime;
+    start_time.u.HighPart = ft.dwHighDateTime;
+
+    prev = start;
+    for (i = 0; i < 100000; i++)
+    {
+        QueryPerformanceCounter( &counter );
+        if (counter.QuadPart < prev.QuadPart) break;
+        prev = counter;
+    }
+    ok( i == 100000, "counter went backwards from %x%08x to %x%08x\n",
+        prev.u.HighPart, prev.u.LowPart, counter.u.HighPart, counter.u.LowPart );
+
+    Sleep( 200 );
+    GetSystemTimeAsFileTime( &ft );
+    QueryPerformanceCounter( &counter );
+    elapsed_tick = GetTickCount() - tick;
+    elapsed_qpc = (counter.QuadPart - start.QuadPart) * 1000 / freq.QuadPart;
+    end_time.u.LowPart = ft.dwLowDateTime;
+    end_time.u.HighPart = ft.dwHighDateTime;
+    elapsed_time = (end_time.QuadPart - start_time.QuadPart) / 10000;
+    ok( elapsed_qpc >= 150 && elapsed_qpc < 1000, "wrong counter delta %u ms\n", elapsed_qpc );
+    ok( elapsed_tick + 50 >= elapsed_qpc && elapsed_tick <= elapsed_qpc + 50,
+        "tick count delta %u ms, counter delta %u ms\n", elapsed_tick, elapsed_qpc );
+    /* the counter must run at the rate of the system clock */
+    ok( elapsed_time + 50 >= elapsed_qpc && elapsed_time <= elapsed_qpc + 50,
+        "system time delta %u ms, counter delta %u ms\n", elapsed_time, elapsed_qpc );
+}
+
 START_TEST(time)
 {
     HMODULE hKernel = GetModuleHandle("kernel32");
@@ -734,4 +776,5 @@ START_TEST(time)
     test_TzSpecificLocalTimeToSystemTime();
     test_FileTimeToDosDateTime();
     test_GetCalendarInfo();
+    test_counters();
 }
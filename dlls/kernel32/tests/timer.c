@@ -68,7 +68,64 @@ static void test_timer(void)
     CloseHandle( handle );
 }
 
+static void test_many_timers(void)
+{
+    HANDLE (WINAPI *pCreateWaitableTimerA)( SECURITY_ATTRIBUTES*, BOOL, LPSTR );
+    BOOL (WINAPI *pSetWaitableTimer)(HANDLE, LARGE_INTEGER*, LONG, PTIMERAPCROUTINE, LPVOID, BOOL);
+    BOOL (WINAPI *pCancelWaitableTimer)(HANDLE);
+    HMODULE hker = GetModuleHandle("kernel32");
+    HANDLE handles[64];
+    LARGE_INTEGER due;
+    DWORD ret;
+    BOOL r;
+    int i;
+
+    pCreateWaitableTimerA = (void*)GetProcAddress( hker, "CreateWaitableTimerA");
+    pSetWaitableTimer = (void*)GetProcAddress( hker, "SetWaitableTimer");
+    pCancelWaitableTimer = (void*)GetProcAddress( hker, "CancelWaitableTimer");
+    if( !pCreateWaitableTimerA || !pSetWaitableTimer || !pCancelWaitableTimer )
+    {
+        win_skip("waitable timers are not available\n");
+        return;
+    }
+
+    /* due times in scrambled order, some of them rescheduled or cancelled while pending */
+    for (i = 0; i < 64; i++)
+    {
+        handles[i] = pCreateWaitableTimerA( NULL, TRUE, NULL );
+        ok( handles[i] != NULL, "failed to create waitable timer %d\n", i );
+        due.QuadPart = -10000 * (10 + (i * 37) % 64 * 3);
+        r = pSetWaitableTimer( handles[i], &due, 0, NULL, NULL, FALSE );
+        ok( r, "failed to set timer %d\n", i );
+    }
+    for (i = 0; i < 64; i += 3)
+    {
+        r = pCancelWaitableTimer( handles[i] );
+        ok( r, "failed to cancel timer %d\n", i );
+    }
+    for (i = 1; i < 64; i += 6)
+    {
+        due.QuadPart = -10000 * (5 + i);
+        r = pSetWaitableTimer( handles[i], &due, 0, NULL, NULL, FALSE );
+        ok( r, "failed to reset timer %d\n", i );
+    }
+
+    for (i = 0; i < 64; i++)
+    {
+        ret = WaitForSingleObject( handles[i], i % 3 ? 5000 : 0 );
+        if (i % 3) ok( ret == WAIT_OBJECT_0, "timer %d not signaled: %u\n", i, ret );
+    }
+    Sleep( 100 );
+    for (i = 0; i < 64; i += 3)
+    {
+        ret = WaitForSingleObject( handles[i], 0 );
+        ok( ret == WAIT_TIMEOUT, "cancelled timer %d signaled: %u\n", i, ret );
+    }
+    for (i = 0; i < 64; i++) CloseHandle( handles[i] );
+}
+
 START_TEST(timer)
 {
     test_timer();
+    test_many_timers();
 }
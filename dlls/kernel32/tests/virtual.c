@@ -40,6 +40,7 @@ static UINT   (WINAPI *pResetWriteWatch)(LPVOID,SIZE_T);
 static NTSTATUS (WINAPI *pNtAreMappedFilesTheSame)(PVOID,PVOID);
 static NTSTATUS (WINAPI *pNtMapViewOfSection)(HANDLE, HANDLE, PVOID *, ULONG, SIZE_T, const LARGE_INTEGER *, SIZE_T *, ULONG, ULONG, ULONG);
 static DWORD (WINAPI *pNtUnmapViewOfSection)(HANDLE, PVOID);
+static SIZE_T (WINAPI *pGetLargePageMinimum)(void);
 
 /* ############################### */
 
@@ -2487,6 +2488,63 @@ static void test_shared_memory(int is_child)
     CloseHandle(mapping);
 }
 
+static void test_large_pages(void)
+{
+    SYSTEM_INFO si;
+    SIZE_T size;
+    HANDLE mapping;
+    char *ptr;
+
+    if (!pGetLargePageMinimum)
+    {
+        win_skip("GetLargePageMinimum not supported\n");
+        return;
+    }
+    size = pGetLargePageMinimum();
+    if (!size)
+    {
+        skip("large pages not supported\n");
+        return;
+    }
+    GetSystemInfo(&si);
+    ok(size > si.dwPageSize, "large page size %lx too small\n", size);
+    ok(!(size & (size - 1)), "large page size %lx not a power of 2\n", size);
+
+    /* large pages must be reserved and committed at once, in whole pages */
+    ptr = VirtualAlloc(NULL, size / 2, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+    ok(!ptr, "VirtualAlloc succeeded with half a large page\n");
+    if (ptr) VirtualFree(ptr, 0, MEM_RELEASE);
+    ptr = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE);
+    ok(!ptr, "VirtualAlloc succeeded without MEM_COMMIT\n");
+    if (ptr) VirtualFree(ptr, 0, MEM_RELEASE);
+
+    ptr = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+    if (!ptr)
+    {
+        ok(GetLastError() == ERROR_PRIVILEGE_NOT_HELD, "VirtualAlloc failed %u\n", GetLastError());
+        skip("no privilege to allocate large pages\n");
+        return;
+    }
+    ok(!((ULONG_PTR)ptr & (size - 1)), "%p not aligned to a large page\n", ptr);
+    memset(ptr, 0x55, size);
+    ok(ptr[size - 1] == 0x55, "wrong data %x\n", ptr[size - 1]);
+    ok(VirtualFree(ptr, 0, MEM_RELEASE), "VirtualFree failed %u\n", GetLastError());
+
+    mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE | SEC_COMMIT | SEC_LARGE_PAGES,
+                                 0, size, NULL);
+    ok(mapping != NULL, "CreateFileMapping failed %u\n", GetLastError());
+    ptr = MapViewOfFile(mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, 0);
+    ok(ptr != NULL, "MapViewOfFile failed %u\n", GetLastError());
+    if (ptr)
+    {
+        ok(!((ULONG_PTR)ptr & (size - 1)), "%p not aligned to a large page\n", ptr);
+        memset(ptr, 0x55, size);
+        ok(ptr[size - 1] == 0x55, "wrong data %x\n", ptr[size - 1]);
+        UnmapViewOfFile(ptr);
+    }
+    CloseHandle(mapping);
+}
+
 START_TEST(virtual)
 {
     int argc;
@@ -2529,6 +2587,7 @@ START_TEST(virtual)
                                                        "NtAreMappedFilesTheSame" );
     pNtMapViewOfSection = (void *)GetProcAddress(GetModuleHandle("ntdll.dll"), "NtMapViewOfSection");
     pNtUnmapViewOfSection = (void *)GetProcAddress(GetModuleHandle("ntdll.dll"), "NtUnmapViewOfSection");
+    pGetLargePageMinimum = (void *) GetProcAddress(hkernel32, "GetLargePageMinimum");
 
     test_shared_memory(0);
     test_mapping();
@@ -2545,4 +2604,5 @@ START_TEST(virtual)
     test_IsBadWritePtr();
     test_IsBadCodePtr();
     test_write_watch();
+    test_large_pages();
 }
@@ -3207,14 +3207,21 @@ static void WINAPI read_changes_user_apc( void *arg, IO_STATUS_BLOCK *io, ULONG
 static NTSTATUS read_changes_apc( void *user, PIO_STATUS_BLOCK iosb, NTSTATUS status, void **apc )
 {
     struct read_changes_info *info = user;
-    char data[PATH_MAX];
+    char *data = NULL;
     NTSTATUS ret;
-    int size;
+    int size = 0;
+
+    /* the server removes the records it returns, so only ask for what is sure to fit
+     * in the caller's buffer: a record of n bytes takes at most 2 * n - 4 bytes once
+     * converted, since each name byte may become a WCHAR */
+    if (info->Buffer && info->BufferSize >= sizeof(FILE_NOTIFY_INFORMATION))
+        size = (info->BufferSize + 4) / 2;
+    if (size && !(data = RtlAllocateHeap( GetProcessHeap(), 0, size ))) size = 0;
 
     SERVER_START_REQ( read_change )
     {
         req->handle = wine_server_obj_handle( info->FileHandle );
-        wine_server_set_reply( req, data, PATH_MAX );
+        wine_server_set_reply( req, data, size );
         ret = wine_server_call( req );
         size = wine_server_reply_size( reply );
     }
@@ -3227,7 +3234,7 @@ static NTSTATUS read_changes_apc( void *user, PIO_STATUS_BLOCK iosb, NTSTATUS st
         DWORD *last_entry_offset = NULL;
         struct filesystem_event *event = (struct filesystem_event*)data;
 
-        while (size && left >= sizeof(*pfni))
+        while (size && left >= offsetof(FILE_NOTIFY_INFORMATION, FileName))
         {
             /* convert to an NT style path */
             for (i=0; i<event->len; i++)
@@ -3271,6 +3278,7 @@ static NTSTATUS read_changes_apc( void *user, PIO_STATUS_BLOCK iosb, NTSTATUS st
         size = 0;
     }
 
+    RtlFreeHeap( GetProcessHeap(), 0, data );
     iosb->u.Status = ret;
     iosb->Information = size;
     *apc = read_changes_user_apc;
@@ -66,6 +66,12 @@
 #ifdef HAVE_SYS_STATFS_H
 # include <sys/statfs.h>
 #endif
+#ifdef HAVE_SYS_SYSCALL_H
+# include <sys/syscall.h>
+#endif
+#ifdef HAVE_SYS_UIO_H
+# include <sys/uio.h>
+#endif
 #ifdef HAVE_VALGRIND_MEMCHECK_H
 # include <valgrind/memcheck.h>
 #endif
@@ -357,6 +363,290 @@ NTSTATUS FILE_GetNtStatus(void)
     }
 }
 
+/***********************************************************************
+ *                  Regular file I/O in worker threads                 *
+ *
+ * Regular files are always ready for I/O as far as poll() is concerned,
+ * so they are read and written synchronously. When the data isn't in the
+ * page cache an overlapped request would block the caller though, so
+ * in that case it is handed to a thread pool worker and completed from
+ * there, which lets the application keep several requests in flight.
+ */
+
+#define MAX_SEGMENT_IOVECS 256  /* pages transferred per preadv/pwritev call */
+
+struct async_file_io
+{
+    HANDLE                handle;
+    HANDLE                event;
+    IO_STATUS_BLOCK      *iosb;
+    ULONG_PTR             cvalue;
+    int                   fd;
+    BOOL                  is_write;
+    char                 *buffer;    /* single buffer, or NULL for segments */
+    FILE_SEGMENT_ELEMENT *segments;  /* page segments for scatter/gather I/O */
+    ULONG                 length;
+    ULONGLONG             offset;
+    ULONG                 done;      /* bytes already transferred before queuing */
+};
+
+/* fill an iovec array from page segments, starting at byte position pos;
+ * the length is a multiple of the page size, callers reject anything else */
+static int segments_to_iovec( const FILE_SEGMENT_ELEMENT *segments, ULONG length, ULONG pos,
+                              struct iovec *iov, int max )
+{
+    ULONG seg = pos / page_size;
+    int count;
+
+    for (count = 0; count < max && seg < length / page_size; count++, seg++)
+    {
+        iov[count].iov_base = (char *)segments[seg].Buffer;
+        iov[count].iov_len  = page_size;
+    }
+    if (count)
+    {
+        iov[0].iov_base = (char *)iov[0].iov_base + pos % page_size;
+        iov[0].iov_len -= pos % page_size;
+    }
+    return count;
+}
+
+/* transfer the first buffers of an iovec array; returns -1 and sets errno on failure */
+static int file_iovec_io( int fd, struct iovec *iov, int count, const LARGE_INTEGER *offset,
+                          ULONG pos, BOOL is_write )
+{
+    if (!offset)
+        return is_write ? writev( fd, iov, count ) : readv( fd, iov, count );
+#ifdef HAVE_PREADV
+    if (!is_write) return preadv( fd, iov, count, offset->QuadPart + pos );
+#endif
+#ifdef HAVE_PWRITEV
+    if (is_write) return pwritev( fd, iov, count, offset->QuadPart + pos );
+#endif
+    /* no vectored positional I/O, transfer one segment at a time */
+    if (is_write) return pwrite( fd, iov[0].iov_base, iov[0].iov_len, offset->QuadPart + pos );
+    return pread( fd, iov[0].iov_base, iov[0].iov_len, offset->QuadPart + pos );
+}
+
+/***********************************************************************
+ *           file_segments_io
+ *
+ * Read or write page segments for NtReadFileScatter/NtWriteFileGather,
+ * as many pages as possible per system call.
+ * offset is NULL to use the current file position.
+ */
+static NTSTATUS file_segments_io( int fd, const FILE_SEGMENT_ELEMENT *segments, ULONG length,
+                                  const LARGE_INTEGER *offset, BOOL is_write, ULONG *total )
+{
+    struct iovec iov[MAX_SEGMENT_IOVECS];
+    int count, result;
+
+    while (*total < length)
+    {
+        count = segments_to_iovec( segments, length, *total, iov, MAX_SEGMENT_IOVECS );
+        if ((result = file_iovec_io( fd, iov, count, offset, *total, is_write )) == -1)
+        {
+            if (errno == EINTR) continue;
+            if (is_write && errno == EFAULT) return STATUS_INVALID_USER_BUFFER;
+            return FILE_GetNtStatus();
+        }
+        if (!result) return is_write ? STATUS_DISK_FULL : STATUS_END_OF_FILE;
+        *total += result;
+    }
+    return STATUS_SUCCESS;
+}
+
+#if defined(__linux__) && defined(__NR_preadv2) && defined(__NR_pwritev2)
+
+#define RWF_NOWAIT_FLAG 0x00000008  /* RWF_NOWAIT */
+
+/* try a regular file read or write that fails with EAGAIN instead of waiting for the disk */
+static int file_io_nowait( int fd, const struct iovec *iov, int count, ULONGLONG offset, BOOL is_write )
+{
+    static int nowait_supported[2] = { 1, 1 };
+    size_t length = 0;
+    int i, ret;
+
+    for (i = 0; i < count; i++) length += iov[i].iov_len;
+    if (!nowait_supported[is_write] || !length)
+    {
+        errno = ENOSYS;
+        return -1;
+    }
+    ret = syscall( is_write ? __NR_pwritev2 : __NR_preadv2, fd, iov, count,
+                   (unsigned long)offset, (unsigned long)(offset >> 32), RWF_NOWAIT_FLAG );
+    if (ret == -1 && (errno == ENOSYS || errno == EOPNOTSUPP)) nowait_supported[is_write] = 0;
+    /* a short count may only be the cached part of the data, the caller has to transfer the rest */
+    return ret;
+}
+
+#else
+
+static inline int file_io_nowait( int fd, const struct iovec *iov, int count, ULONGLONG offset, BOOL is_write )
+{
+    errno = ENOSYS;
+    return -1;
+}
+
+#endif
+
+/***********************************************************************
+ *           file_buffer_io
+ *
+ * Transfer the rest of a single buffer regular file I/O, starting after the
+ * first done bytes. Returns the total count, or -1 if nothing was transferred.
+ */
+static int file_buffer_io( int fd, char *buffer, ULONG length, ULONGLONG offset, ULONG done, BOOL is_write )
+{
+    int result;
+
+    while (done < length)
+    {
+        if (is_write) result = pwrite( fd, buffer + done, length - done, offset + done );
+        else result = pread( fd, buffer + done, length - done, offset + done );
+        if (result == -1)
+        {
+            if (errno == EINTR) continue;
+            if (!done) return -1;
+            break;
+        }
+        if (!result) break;
+        done += result;
+    }
+    return done;
+}
+
+/* thread pool callback performing a queued regular file I/O */
+static DWORD CALLBACK async_file_io_proc( void *arg )
+{
+    struct async_file_io *io = arg;
+    NTSTATUS status = STATUS_SUCCESS;
+    ULONG total = io->done;
+    int result;
+
+    if (io->segments)
+    {
+        LARGE_INTEGER offset;
+
+        offset.QuadPart = io->offset;
+        status = file_segments_io( io->fd, io->segments, io->length, &offset, io->is_write, &total );
+    }
+    else
+    {
+        result = file_buffer_io( io->fd, io->buffer, io->length, io->offset, io->done, io->is_write );
+        if (result == -1)
+        {
+            if (io->is_write && errno == EFAULT) status = STATUS_INVALID_USER_BUFFER;
+            else status = FILE_GetNtStatus();
+        }
+        else if (!result && !io->is_write) status = STATUS_END_OF_FILE;
+        else total = result;
+    }
+    close( io->fd );
+
+    TRACE( "%p: %s %u bytes at %s = 0x%08x\n", io->handle, io->is_write ? "wrote" : "read",
+           total, wine_dbgstr_longlong( io->offset ), status );
+
+    io->iosb->Information = total;
+    io->iosb->u.Status = status;
+    if (io->cvalue) NTDLL_AddCompletion( io->handle, io->cvalue, status, total );
+    NtSetEvent( io->event, NULL );
+    RtlFreeHeap( GetProcessHeap(), 0, io );
+    return 0;
+}
+
+/***********************************************************************
+ *           queue_async_file_io
+ *
+ * Queue a regular file I/O that would block to the thread pool, either on
+ * a single buffer or on page segments. The worker transfers the data after
+ * the first done bytes, and reports them as part of the total.
+ * On success the fd is owned by the worker and STATUS_PENDING is returned.
+ */
+static NTSTATUS queue_async_file_io( HANDLE handle, HANDLE event, IO_STATUS_BLOCK *iosb, ULONG_PTR cvalue,
+                                     int fd, int needs_close, void *buffer, FILE_SEGMENT_ELEMENT *segments,
+                                     ULONG length, ULONGLONG offset, ULONG done, BOOL is_write )
+{
+    struct async_file_io *io;
+    NTSTATUS status;
+
+    if (!(io = RtlAllocateHeap( GetProcessHeap(), 0, sizeof(*io) ))) return STATUS_NO_MEMORY;
+    if ((io->fd = needs_close ? fd : dup( fd )) == -1)
+    {
+        RtlFreeHeap( GetProcessHeap(), 0, io );
+        return FILE_GetNtStatus();
+    }
+    io->handle   = handle;
+    io->event    = event;
+    io->iosb     = iosb;
+    io->cvalue   = cvalue;
+    io->is_write = is_write;
+    io->buffer   = buffer;
+    io->segments = segments;
+    io->length   = length;
+    io->offset   = offset;
+    io->done     = done;
+
+    NtResetEvent( event, NULL );
+    iosb->u.Status = STATUS_PENDING;
+    if ((status = RtlQueueWorkItem( async_file_io_proc, io, WT_EXECUTELONGFUNCTION )))
+    {
+        if (!needs_close) close( io->fd );
+        RtlFreeHeap( GetProcessHeap(), 0, io );
+        return status;
+    }
+    return STATUS_PENDING;
+}
+
+/* check whether an I/O on a regular file may be queued to the thread pool if it would block */
+static inline BOOL can_queue_file_io( HANDLE event, PIO_APC_ROUTINE apc, unsigned int options )
+{
+    /* without an event, GetOverlappedResult would wait on the file handle which is always signaled */
+    return event && !apc && !(options & (FILE_SYNCHRONOUS_IO_ALERT | FILE_SYNCHRONOUS_IO_NONALERT));
+}
+
+/***********************************************************************
+ *           file_segments_io_nowait
+ *
+ * Transfer page segments without blocking, for as long as the data is cached.
+ * Returns TRUE if the rest of the transfer, after *total bytes, has to be
+ * handed to a worker.
+ */
+static BOOL file_segments_io_nowait( int fd, const FILE_SEGMENT_ELEMENT *segments, ULONG length,
+                                     ULONGLONG offset, BOOL is_write, ULONG *total )
+{
+    struct iovec iov[MAX_SEGMENT_IOVECS];
+    int count, result;
+
+    while (*total < length)
+    {
+        count = segments_to_iovec( segments, length, *total, iov, MAX_SEGMENT_IOVECS );
+        result = file_io_nowait( fd, iov, count, offset + *total, is_write );
+        if (result == -1) return errno == EAGAIN;
+        if (!result) return FALSE;  /* end of file */
+        *total += result;
+    }
+    return FALSE;
+}
+
+/* check whether a non-blocking I/O left part of the transfer to a worker;
+ * a zero count can only be the end of file, nowait fails with EAGAIN otherwise */
+static inline BOOL file_nowait_incomplete( int result, ULONG length )
+{
+    if (result == -1) return errno == EAGAIN;
+    return result && (ULONG)result < length;
+}
+
+/* try a single buffer regular file I/O without blocking */
+static inline int file_buffer_io_nowait( int fd, void *buffer, ULONG length, ULONGLONG offset, BOOL is_write )
+{
+    struct iovec iov;
+
+    iov.iov_base = buffer;
+    iov.iov_len  = length;
+    return file_io_nowait( fd, &iov, 1, offset, is_write );
+}
+
 /***********************************************************************
  *             FILE_AsyncReadService      (INTERNAL)
  */
@@ -603,14 +893,23 @@ NTSTATUS WINAPI NtReadFile(HANDLE hFile, HANDLE hEvent,
 
     if (type == FD_TYPE_FILE && offset && offset->QuadPart != (LONGLONG)-2 /* FILE_USE_FILE_POINTER_POSITION */ )
     {
-        /* async I/O doesn't make sense on regular files */
-        while ((result = pread( unix_handle, buffer, length, offset->QuadPart )) == -1)
+        /* async I/O only makes sense on regular files if the data isn't cached,
+         * the worker reads whatever part of it isn't */
+        result = 0;
+        if (can_queue_file_io( hEvent, apc, options ))
         {
-            if (errno != EINTR)
-            {
-                status = FILE_GetNtStatus();
-                goto done;
-            }
+            result = file_buffer_io_nowait( unix_handle, buffer, length, offset->QuadPart, FALSE );
+            if (file_nowait_incomplete( result, length ) &&
+                queue_async_file_io( hFile, hEvent, io_status, cvalue, unix_handle, needs_close,
+                                     buffer, NULL, length, offset->QuadPart, max( result, 0 ), FALSE ) == STATUS_PENDING)
+                return STATUS_PENDING;
+        }
+
+        if ((result = file_buffer_io( unix_handle, buffer, length, offset->QuadPart,
+                                      max( result, 0 ), FALSE )) == -1)
+        {
+            status = FILE_GetNtStatus();
+            goto done;
         }
         if (options & (FILE_SYNCHRONOUS_IO_ALERT | FILE_SYNCHRONOUS_IO_NONALERT))
             /* update file pointer position */
@@ -766,10 +1065,10 @@ NTSTATUS WINAPI NtReadFileScatter( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
                                    PIO_STATUS_BLOCK io_status, FILE_SEGMENT_ELEMENT *segments,
                                    ULONG length, PLARGE_INTEGER offset, PULONG key )
 {
-    int result, unix_handle, needs_close;
+    int unix_handle, needs_close;
     unsigned int options;
     NTSTATUS status;
-    ULONG pos = 0, total = 0;
+    ULONG total = 0;
     enum server_fd_type type;
     ULONG_PTR cvalue = apc ? 0 : (ULONG_PTR)apc_user;
     BOOL send_completion = FALSE;
@@ -792,33 +1091,16 @@ NTSTATUS WINAPI NtReadFileScatter( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
         goto error;
     }
 
-    while (length)
-    {
-        if (offset && offset->QuadPart != (LONGLONG)-2 /* FILE_USE_FILE_POINTER_POSITION */)
-            result = pread( unix_handle, (char *)segments->Buffer + pos,
-                            page_size - pos, offset->QuadPart + total );
-        else
-            result = read( unix_handle, (char *)segments->Buffer + pos, page_size - pos );
+    if (offset && offset->QuadPart == (LONGLONG)-2 /* FILE_USE_FILE_POINTER_POSITION */) offset = NULL;
 
-        if (result == -1)
-        {
-            if (errno == EINTR) continue;
-            status = FILE_GetNtStatus();
-            break;
-        }
-        if (!result)
-        {
-            status = STATUS_END_OF_FILE;
-            break;
-        }
-        total += result;
-        length -= result;
-        if ((pos += result) == page_size)
-        {
-            pos = 0;
-            segments++;
-        }
-    }
+    /* every chunk that is cached is transferred inline, the worker does the rest */
+    if (offset && can_queue_file_io( event, apc, options ) &&
+        file_segments_io_nowait( unix_handle, segments, length, offset->QuadPart, FALSE, &total ) &&
+        queue_async_file_io( file, event, io_status, cvalue, unix_handle, needs_close,
+                             NULL, segments, length, offset->QuadPart, total, FALSE ) == STATUS_PENDING)
+        return STATUS_PENDING;
+
+    status = file_segments_io( unix_handle, segments, length, offset, FALSE, &total );
 
     send_completion = cvalue != 0;
 
@@ -949,15 +1231,24 @@ NTSTATUS WINAPI NtWriteFile(HANDLE hFile, HANDLE hEvent,
 
     if (type == FD_TYPE_FILE && offset && offset->QuadPart != (LONGLONG)-2 /* FILE_USE_FILE_POINTER_POSITION */ )
     {
-        /* async I/O doesn't make sense on regular files */
-        while ((result = pwrite( unix_handle, buffer, length, offset->QuadPart )) == -1)
+        /* async I/O only makes sense on regular files if the disk would block us,
+         * the worker writes whatever part of the data couldn't be written at once */
+        result = 0;
+        if (can_queue_file_io( hEvent, apc, options ))
         {
-            if (errno != EINTR)
-            {
-                if (errno == EFAULT) status = STATUS_INVALID_USER_BUFFER;
-                else status = FILE_GetNtStatus();
-                goto done;
-            }
+            result = file_buffer_io_nowait( unix_handle, (void *)buffer, length, offset->QuadPart, TRUE );
+            if (file_nowait_incomplete( result, length ) &&
+                queue_async_file_io( hFile, hEvent, io_status, cvalue, unix_handle, needs_close,
+                                     (void *)buffer, NULL, length, offset->QuadPart, max( result, 0 ), TRUE ) == STATUS_PENDING)
+                return STATUS_PENDING;
+        }
+
+        if ((result = file_buffer_io( unix_handle, (char *)buffer, length, offset->QuadPart,
+                                      max( result, 0 ), TRUE )) == -1)
+        {
+            if (errno == EFAULT) status = STATUS_INVALID_USER_BUFFER;
+            else status = FILE_GetNtStatus();
+            goto done;
         }
 
         if (options & (FILE_SYNCHRONOUS_IO_ALERT | FILE_SYNCHRONOUS_IO_NONALERT))
@@ -1097,10 +1388,10 @@ NTSTATUS WINAPI NtWriteFileGather( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
                                    PIO_STATUS_BLOCK io_status, FILE_SEGMENT_ELEMENT *segments,
                                    ULONG length, PLARGE_INTEGER offset, PULONG key )
 {
-    int result, unix_handle, needs_close;
+    int unix_handle, needs_close;
     unsigned int options;
     NTSTATUS status;
-    ULONG pos = 0, total = 0;
+    ULONG total = 0;
     enum server_fd_type type;
     ULONG_PTR cvalue = apc ? 0 : (ULONG_PTR)apc_user;
     BOOL send_completion = FALSE;
@@ -1123,38 +1414,17 @@ NTSTATUS WINAPI NtWriteFileGather( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
         goto error;
     }
 
-    while (length)
-    {
-        if (offset && offset->QuadPart != (LONGLONG)-2 /* FILE_USE_FILE_POINTER_POSITION */)
-            result = pwrite( unix_handle, (char *)segments->Buffer + pos,
-                             page_size - pos, offset->QuadPart + total );
-        else
-            result = write( unix_handle, (char *)segments->Buffer + pos, page_size - pos );
+    if (offset && offset->QuadPart == (LONGLONG)-2 /* FILE_USE_FILE_POINTER_POSITION */) offset = NULL;
 
-        if (result == -1)
-        {
-            if (errno == EINTR) continue;
-            if (errno == EFAULT)
-            {
-                status = STATUS_INVALID_USER_BUFFER;
-                goto error;
-            }
-            status = FILE_GetNtStatus();
-            break;
-        }
-        if (!result)
-        {
-            status = STATUS_DISK_FULL;
-            break;
-        }
-        total += result;
-        length -= result;
-        if ((pos += result) == page_size)
-        {
-            pos = 0;
-            segments++;
-        }
-    }
+    /* every chunk that is cached is transferred inline, the worker does the rest */
+    if (offset && can_queue_file_io( event, apc, options ) &&
+        file_segments_io_nowait( unix_handle, segments, length, offset->QuadPart, TRUE, &total ) &&
+        queue_async_file_io( file, event, io_status, cvalue, unix_handle, needs_close,
+                             NULL, segments, length, offset->QuadPart, total, TRUE ) == STATUS_PENDING)
+        return STATUS_PENDING;
+
+    status = file_segments_io( unix_handle, segments, length, offset, TRUE, &total );
+    if (status == STATUS_INVALID_USER_BUFFER) goto error;
 
     send_completion = cvalue != 0;
 
@@ -917,6 +917,22 @@ static inline int have_sse_daz_mode(void)
 #endif
 }
 
+/* return the frequency of an invariant TSC, or 0 if it isn't exactly known */
+static ULONGLONG get_tsc_frequency(void)
+{
+    unsigned int regs[4];
+
+    do_cpuid(0x80000000, regs);
+    if (regs[0] < 0x80000007) return 0;
+    do_cpuid(0x80000007, regs);  /* get advanced power management features */
+    if (!(regs[3] & (1 << 8))) return 0;
+    do_cpuid(0x00000000, regs);
+    if (regs[0] < 0x00000015) return 0;
+    do_cpuid(0x00000015, regs);  /* get TSC to core crystal clock ratio */
+    if (!regs[0] || !regs[1] || !regs[2]) return 0;
+    return (ULONGLONG)regs[2] * regs[1] / regs[0];
+}
+
 static inline void get_cpuinfo(SYSTEM_CPU_INFORMATION* info)
 {
     unsigned int regs[4], regs2[4];
@@ -964,6 +980,8 @@ static inline void get_cpuinfo(SYSTEM_CPU_INFORMATION* info)
         if((regs2[3] & (1 << 26)) && (regs2[3] & (1 << 24))) /* has SSE2 and FXSAVE/FXRSTOR */
             user_shared_data->ProcessorFeatures[PF_SSE_DAZ_MODE_AVAILABLE] = have_sse_daz_mode();
 
+        if(regs2[3] & (1 << 4)) init_tsc_counter( get_tsc_frequency() );
+
         if (regs[1] == AUTH && regs[3] == ENTI && regs[2] == CAMD)
         {
             info->Level = (regs2[0] >> 8) & 0xf; /* family */
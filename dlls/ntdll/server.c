@@ -300,10 +300,16 @@ unsigned int wine_server_call( void *req_ptr )
 
 /***********************************************************************
  *           server_enter_uninterrupted_section
+ *
+ * The signals in server_block_set are not masked here; instead the thread is
+ * flagged so that the ntdll handlers (SIGINT, SIGUSR1, and SIGUSR2 on i386)
+ * defer them until the section is left. The other signals in the set have
+ * no ntdll handler. This saves two sigprocmask syscalls on every virtual
+ * memory operation.
  */
-void server_enter_uninterrupted_section( RTL_CRITICAL_SECTION *cs, sigset_t *sigset )
+void server_enter_uninterrupted_section( RTL_CRITICAL_SECTION *cs )
 {
-    pthread_sigmask( SIG_BLOCK, &server_block_set, sigset );
+    ntdll_get_thread_data()->uninterrupted++;
     RtlEnterCriticalSection( cs );
 }
 
@@ -311,10 +317,67 @@ void server_enter_uninterrupted_section( RTL_CRITICAL_SECTION *cs, sigset_t *sig
 /***********************************************************************
  *           server_leave_uninterrupted_section
  */
-void server_leave_uninterrupted_section( RTL_CRITICAL_SECTION *cs, sigset_t *sigset )
+void server_leave_uninterrupted_section( RTL_CRITICAL_SECTION *cs )
 {
+    struct ntdll_thread_data *thread_data = ntdll_get_thread_data();
+    unsigned int pending;
+    sigset_t set;
+    int sig;
+
     RtlLeaveCriticalSection( cs );
-    pthread_sigmask( SIG_SETMASK, sigset, NULL );
+    if (--thread_data->uninterrupted) return;
+
+    /* a handler running from here on sees the section as left and won't defer */
+    if ((pending = thread_data->blocked_signals))
+    {
+        /* the signals are pending again, unblocking them delivers them */
+        thread_data->blocked_signals = 0;
+        sigemptyset( &set );
+        for (sig = 1; pending; sig++)
+        {
+            if (!(pending & (1u << sig))) continue;
+            pending &= ~(1u << sig);
+            sigaddset( &set, sig );
+        }
+        pthread_sigmask( SIG_UNBLOCK, &set, NULL );
+    }
+    if ((pending = thread_data->deferred_signals))
+    {
+        thread_data->deferred_signals = 0;
+        for (sig = 1; pending; sig++)
+        {
+            if (!(pending & (1u << sig))) continue;
+            pending &= ~(1u << sig);
+            raise( sig );
+        }
+    }
+}
+
+
+/***********************************************************************
+ *           server_defer_signal
+ *
+ * Called at the start of the handlers for signals in server_block_set.
+ * Returns TRUE if the signal has been deferred until the end of the current
+ * uninterrupted section, in which case the handler must return immediately.
+ */
+BOOL server_defer_signal( int sig, siginfo_t *siginfo, void *sigcontext )
+{
+    struct ntdll_thread_data *thread_data = ntdll_get_thread_data();
+
+    if (!thread_data->uninterrupted) return FALSE;
+#if defined(__linux__) && defined(__NR_rt_tgsigqueueinfo) && defined(__NR_gettid)
+    /* queue the signal again with its original siginfo, and keep it blocked
+     * in the interrupted context until the section is left */
+    if (!syscall( __NR_rt_tgsigqueueinfo, getpid(), syscall( __NR_gettid ), sig, siginfo ))
+    {
+        sigaddset( &((ucontext_t *)sigcontext)->uc_sigmask, sig );
+        thread_data->blocked_signals |= 1u << sig;
+        return TRUE;
+    }
+#endif
+    thread_data->deferred_signals |= 1u << sig;
+    return TRUE;
 }
 
 
@@ -543,7 +606,6 @@ int server_remove_fd_from_cache( HANDLE handle )
 int server_get_unix_fd( HANDLE handle, unsigned int wanted_access, int *unix_fd,
                         int *needs_close, enum server_fd_type *type, unsigned int *options )
 {
-    sigset_t sigset;
     obj_handle_t fd_handle;
     int ret = 0, fd;
     unsigned int access = 0;
@@ -552,7 +614,7 @@ int server_get_unix_fd( HANDLE handle, unsigned int wanted_access, int *unix_fd,
     *needs_close = 0;
     wanted_access &= FILE_READ_DATA | FILE_WRITE_DATA;
 
-    server_enter_uninterrupted_section( &fd_cache_section, &sigset );
+    server_enter_uninterrupted_section( &fd_cache_section );
 
     fd = get_cached_fd( handle, type, &access, options );
     if (fd != -1) goto done;
@@ -578,7 +640,7 @@ int server_get_unix_fd( HANDLE handle, unsigned int wanted_access, int *unix_fd,
     SERVER_END_REQ;
 
 done:
-    server_leave_uninterrupted_section( &fd_cache_section, &sigset );
+    server_leave_uninterrupted_section( &fd_cache_section );
     if (!ret && ((access & wanted_access) != wanted_access))
     {
         ret = STATUS_ACCESS_DENIED;
@@ -608,6 +608,7 @@ static void fpe_handler( int signal, siginfo_t *siginfo, void *sigcontext )
  */
 static void int_handler( int signal, siginfo_t *siginfo, void *sigcontext )
 {
+    if (server_defer_signal( signal, siginfo, sigcontext )) return;
     if (!dispatch_signal(SIGINT))
     {
         EXCEPTION_RECORD rec;
@@ -670,6 +671,7 @@ static void usr1_handler( int signal, siginfo_t *siginfo, void *sigcontext )
 {
     CONTEXT context;
 
+    if (server_defer_signal( signal, siginfo, sigcontext )) return;
     save_context( &context, sigcontext );
     wait_suspend( &context );
     restore_context( &context, sigcontext );
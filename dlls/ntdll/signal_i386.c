@@ -1910,7 +1910,12 @@ done:
  */
 static void usr2_handler( int signal, siginfo_t *siginfo, void *sigcontext )
 {
-    EXCEPTION_RECORD *rec = setup_exception( sigcontext, raise_vm86_sti_exception );
+    EXCEPTION_RECORD *rec;
+    WORD fs, gs;
+
+    init_handler( sigcontext, &fs, &gs );
+    if (server_defer_signal( signal, siginfo, sigcontext )) return;
+    rec = setup_exception( sigcontext, raise_vm86_sti_exception );
     rec->ExceptionCode = EXCEPTION_VM86_STI;
 }
 #endif /* __HAVE_VM86 */
@@ -2083,6 +2088,7 @@ static void int_handler( int signal, siginfo_t *siginfo, void *sigcontext )
 {
     WORD fs, gs;
     init_handler( sigcontext, &fs, &gs );
+    if (server_defer_signal( signal, siginfo, sigcontext )) return;
     if (!dispatch_signal(SIGINT))
     {
         EXCEPTION_RECORD *rec = setup_exception( sigcontext, raise_generic_exception );
@@ -2127,6 +2133,7 @@ static void usr1_handler( int signal, siginfo_t *siginfo, void *sigcontext )
     WORD fs, gs;
 
     init_handler( sigcontext, &fs, &gs );
+    if (server_defer_signal( signal, siginfo, sigcontext )) return;
     save_context( &context, sigcontext, fs, gs );
     wait_suspend( &context );
     restore_context( &context, sigcontext );
@@ -2338,6 +2338,7 @@ static void fpe_handler( int signal, siginfo_t *siginfo, void *sigcontext )
  */
 static void int_handler( int signal, siginfo_t *siginfo, void *sigcontext )
 {
+    if (server_defer_signal( signal, siginfo, sigcontext )) return;
     if (!dispatch_signal(SIGINT))
     {
         EXCEPTION_RECORD *rec = setup_exception( sigcontext, raise_generic_exception );
@@ -2379,6 +2380,7 @@ static void usr1_handler( int signal, siginfo_t *siginfo, void *ucontext )
 {
     CONTEXT context;
 
+    if (server_defer_signal( signal, siginfo, ucontext )) return;
     save_context( &context, ucontext );
     wait_suspend( &context );
     restore_context( &context, ucontext );
@@ -1362,6 +1362,63 @@ NTSTATUS WINAPI NtRemoveIoCompletion( HANDLE CompletionPort, PULONG_PTR Completi
     return status;
 }
 
+/******************************************************************
+ *              NtRemoveIoCompletionEx (NTDLL.@)
+ *              ZwRemoveIoCompletionEx (NTDLL.@)
+ *
+ * (Wait for and) retrieve several completion messages from completion object's queue
+ * with a single server round trip
+ *
+ * PARAMS
+ *      CompletionPort  [I] HANDLE to I/O completion object
+ *      info            [O] array receiving the completion messages
+ *      count           [I] size of the array
+ *      written         [O] number of messages retrieved
+ *      WaitTime        [I] optional wait time in NTDLL format
+ *      alertable       [I] whether the wait is alertable
+ *
+ */
+NTSTATUS WINAPI NtRemoveIoCompletionEx( HANDLE CompletionPort, FILE_IO_COMPLETION_INFORMATION *info,
+                                        ULONG count, ULONG *written, LARGE_INTEGER *WaitTime,
+                                        BOOLEAN alertable )
+{
+    completion_packet_t packets[64];
+    NTSTATUS status;
+    ULONG i;
+
+    TRACE("(%p, %p, %u, %p, %p, %u)\n", CompletionPort, info, count, written, WaitTime, alertable);
+
+    if (!count) return STATUS_INVALID_PARAMETER;
+    if (count > sizeof(packets) / sizeof(packets[0])) count = sizeof(packets) / sizeof(packets[0]);
+
+    for (;;)
+    {
+        SERVER_START_REQ( remove_completions )
+        {
+            req->handle = wine_server_obj_handle( CompletionPort );
+            wine_server_set_reply( req, packets, count * sizeof(packets[0]) );
+            if (!(status = wine_server_call( req )))
+                count = wine_server_reply_size( reply ) / sizeof(packets[0]);
+        }
+        SERVER_END_REQ;
+        if (status != STATUS_PENDING) break;
+
+        status = NtWaitForSingleObject( CompletionPort, alertable, WaitTime );
+        if (status != WAIT_OBJECT_0) break;
+    }
+
+    if (status) count = 0;
+    for (i = 0; i < count; i++)
+    {
+        info[i].CompletionKey             = packets[i].ckey;
+        info[i].CompletionValue           = packets[i].cvalue;
+        info[i].IoStatusBlock.Information = packets[i].information;
+        info[i].IoStatusBlock.u.Status    = packets[i].status;
+    }
+    if (written) *written = count;
+    return status;
+}
+
 /******************************************************************
  *              NtOpenIoCompletion (NTDLL.@)
  *              ZwOpenIoCompletion (NTDLL.@)
@@ -72,6 +72,7 @@ static NTSTATUS (WINAPI *pNtCreateIoCompletion)(PHANDLE, ACCESS_MASK, POBJECT_AT
 static NTSTATUS (WINAPI *pNtOpenIoCompletion)(PHANDLE, ACCESS_MASK, POBJECT_ATTRIBUTES);
 static NTSTATUS (WINAPI *pNtQueryIoCompletion)(HANDLE, IO_COMPLETION_INFORMATION_CLASS, PVOID, ULONG, PULONG);
 static NTSTATUS (WINAPI *pNtRemoveIoCompletion)(HANDLE, PULONG_PTR, PULONG_PTR, PIO_STATUS_BLOCK, PLARGE_INTEGER);
+static NTSTATUS (WINAPI *pNtRemoveIoCompletionEx)(HANDLE, FILE_IO_COMPLETION_INFORMATION*, ULONG, ULONG*, LARGE_INTEGER*, BOOLEAN);
 static NTSTATUS (WINAPI *pNtSetIoCompletion)(HANDLE, ULONG_PTR, ULONG_PTR, NTSTATUS, ULONG);
 static NTSTATUS (WINAPI *pNtSetInformationFile)(HANDLE, PIO_STATUS_BLOCK, PVOID, ULONG, FILE_INFORMATION_CLASS);
 static NTSTATUS (WINAPI *pNtQueryInformationFile)(HANDLE, PIO_STATUS_BLOCK, PVOID, ULONG, FILE_INFORMATION_CLASS);
@@ -482,13 +483,15 @@ static void read_file_test(void)
     const char text[] = "foobar";
     HANDLE handle, read, write;
     NTSTATUS status;
-    IO_STATUS_BLOCK iosb, iosb2;
+    IO_STATUS_BLOCK iosb, iosb2, iosbs[4];
     DWORD written;
     int apc_count = 0;
-    char buffer[128];
+    char buffer[128], buffers[4][16];
     LARGE_INTEGER offset;
     HANDLE event = CreateEventA( NULL, TRUE, FALSE, NULL );
+    HANDLE events[4];
     BOOL ret;
+    UINT i;
 
     buffer[0] = 1;
 
@@ -797,6 +800,25 @@ static void read_file_test(void)
         SleepEx( 1, TRUE ); /* alertable sleep */
         ok( !apc_count, "apc was called\n" );
     }
+
+    /* several reads in flight, completed through their events */
+    for (i = 0; i < 4; i++)
+    {
+        events[i] = CreateEventA( NULL, TRUE, TRUE, NULL );
+        U(iosbs[i]).Status = 0xdeadbabe;
+        iosbs[i].Information = 0xdeadbeef;
+        offset.QuadPart = i;
+        status = pNtReadFile( handle, events[i], NULL, NULL, &iosbs[i], buffers[i], sizeof(buffers[i]), &offset, NULL );
+        ok( status == STATUS_SUCCESS || status == STATUS_PENDING, "%u: wrong status %x\n", i, status );
+    }
+    for (i = 0; i < 4; i++)
+    {
+        ok( !WaitForSingleObject( events[i], 1000 ), "%u: event not signaled\n", i );
+        ok( U(iosbs[i]).Status == STATUS_SUCCESS, "%u: wrong status %x\n", i, U(iosbs[i]).Status );
+        ok( iosbs[i].Information == strlen(text) - i, "%u: wrong info %lu\n", i, iosbs[i].Information );
+        ok( !memcmp( buffers[i], text + i, strlen(text) - i ), "%u: wrong data\n", i );
+        CloseHandle( events[i] );
+    }
     CloseHandle( handle );
 
     /* now a non-overlapped file */
@@ -1009,6 +1031,51 @@ static void test_iocp_setcompletion(HANDLE h)
     ok( !count, "Unexpected msg count: %d\n", count );
 }
 
+static void test_iocp_removeex(HANDLE h)
+{
+    FILE_IO_COMPLETION_INFORMATION info[4];
+    LARGE_INTEGER timeout;
+    NTSTATUS res;
+    ULONG i, count;
+
+    if (!pNtRemoveIoCompletionEx)
+    {
+        win_skip( "NtRemoveIoCompletionEx not available\n" );
+        return;
+    }
+
+    for (i = 0; i < 3; i++)
+    {
+        res = pNtSetIoCompletion( h, CKEY_FIRST + i, CVALUE_FIRST + i, STATUS_SUCCESS, i );
+        ok( res == STATUS_SUCCESS, "NtSetIoCompletion failed: %x\n", res );
+    }
+
+    timeout.QuadPart = 0;
+    count = 0xdeadbeef;
+    memset( info, 0xcc, sizeof(info) );
+    res = pNtRemoveIoCompletionEx( h, info, 2, &count, &timeout, FALSE );
+    ok( res == STATUS_SUCCESS, "NtRemoveIoCompletionEx failed: %x\n", res );
+    ok( count == 2, "Unexpected msg count: %u\n", count );
+    for (i = 0; i < 2; i++)
+    {
+        ok( info[i].CompletionKey == CKEY_FIRST + i, "Invalid completion key: %lx\n", info[i].CompletionKey );
+        ok( info[i].CompletionValue == CVALUE_FIRST + i, "Invalid completion value: %lx\n", info[i].CompletionValue );
+        ok( info[i].IoStatusBlock.Information == i, "Invalid information: %lu\n", info[i].IoStatusBlock.Information );
+    }
+
+    count = 0xdeadbeef;
+    res = pNtRemoveIoCompletionEx( h, info, 4, &count, &timeout, FALSE );
+    ok( res == STATUS_SUCCESS, "NtRemoveIoCompletionEx failed: %x\n", res );
+    ok( count == 1, "Unexpected msg count: %u\n", count );
+    ok( info[0].CompletionKey == CKEY_FIRST + 2, "Invalid completion key: %lx\n", info[0].CompletionKey );
+
+    res = pNtRemoveIoCompletionEx( h, info, 4, &count, &timeout, FALSE );
+    ok( res == STATUS_TIMEOUT, "NtRemoveIoCompletionEx returned %x\n", res );
+
+    count = get_pending_msgs(h);
+    ok( !count, "Unexpected msg count: %d\n", count );
+}
+
 static void test_iocp_fileio(HANDLE h)
 {
     static const char pipe_name[] = "\\\\.\\pipe\\iocompletiontestnamedpipe";
@@ -1312,6 +1379,7 @@ static void test_iocompletion(void)
     if ( h && h != INVALID_HANDLE_VALUE)
     {
         test_iocp_setcompletion(h);
+        test_iocp_removeex(h);
         test_iocp_fileio(h);
         pNtClose(h);
     }
@@ -1796,6 +1864,7 @@ START_TEST(file)
     pNtOpenIoCompletion     = (void *)GetProcAddress(hntdll, "NtOpenIoCompletion");
     pNtQueryIoCompletion    = (void *)GetProcAddress(hntdll, "NtQueryIoCompletion");
     pNtRemoveIoCompletion   = (void *)GetProcAddress(hntdll, "NtRemoveIoCompletion");
+    pNtRemoveIoCompletionEx = (void *)GetProcAddress(hntdll, "NtRemoveIoCompletionEx");
     pNtSetIoCompletion      = (void *)GetProcAddress(hntdll, "NtSetIoCompletion");
     pNtSetInformationFile   = (void *)GetProcAddress(hntdll, "NtSetInformationFile");
     pNtQueryInformationFile = (void *)GetProcAddress(hntdll, "NtQueryInformationFile");
@@ -199,7 +199,6 @@ HANDLE thread_init(void)
     void *addr;
     SIZE_T size, info_size;
     HANDLE exe_file = 0;
-    LARGE_INTEGER now;
     NTSTATUS status;
     struct ntdll_thread_data *thread_data;
     static struct debug_info debug_info;  /* debug info for initial thread */
@@ -218,6 +217,7 @@ HANDLE thread_init(void)
         exit(1);
     }
     user_shared_data = addr;
+    user_shared_data->LargePageMinimum = virtual_get_large_page_size();
 
     /* allocate and initialize the PEB */
 
@@ -298,15 +298,9 @@ HANDLE thread_init(void)
     }
 
     /* initialize time values in user_shared_data */
-    NtQuerySystemTime( &now );
-    user_shared_data->SystemTime.LowPart = now.u.LowPart;
-    user_shared_data->SystemTime.High1Time = user_shared_data->SystemTime.High2Time = now.u.HighPart;
-    user_shared_data->u.TickCountQuad = (now.QuadPart - server_start_time) / 10000;
-    user_shared_data->u.TickCount.High2Time = user_shared_data->u.TickCount.High1Time;
-    user_shared_data->TickCountLowDeprecated = user_shared_data->u.TickCount.LowPart;
     user_shared_data->TickCountMultiplier = 1 << 24;
-
     fill_cpu_info();
+    init_shared_time();
 
     return exe_file;
 }
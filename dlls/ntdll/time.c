@@ -38,6 +38,7 @@
 #ifdef HAVE_UNISTD_H
 # include <unistd.h>
 #endif
+#include <stdio.h>
 #ifdef __APPLE__
 # include <mach/mach_time.h>
 #endif
@@ -48,6 +49,7 @@
 #define WIN32_NO_STATUS
 #include "windef.h"
 #include "winternl.h"
+#include "ddk/wdm.h"
 #include "wine/unicode.h"
 #include "wine/debug.h"
 #include "ntdll_misc.h"
@@ -101,8 +103,8 @@ static inline int IsLeapYear(int Year)
 	return Year % 4 == 0 && (Year % 100 != 0 || Year % 400 == 0) ? 1 : 0;
 }
 
-/* return a monotonic time counter, in Win32 ticks */
-static ULONGLONG monotonic_counter(void)
+/* return the monotonic system clock, in Win32 ticks */
+static ULONGLONG monotonic_clock(void)
 {
     struct timeval now;
 
@@ -125,6 +127,129 @@ static ULONGLONG monotonic_counter(void)
     return now.tv_sec * (ULONGLONG)TICKSPERSEC + now.tv_usec * 10 + TICKS_1601_TO_1970 - server_start_time;
 }
 
+#if defined(__i386__) || defined(__x86_64__)
+
+static BOOL use_tsc;
+static ULONGLONG tsc_mult;   /* Win32 ticks per TSC cycle, shifted left by tsc_shift */
+static int tsc_shift;
+static ULONGLONG tsc_offset; /* offset from the scaled TSC to the monotonic clock */
+
+static inline ULONGLONG rdtsc(void)
+{
+    unsigned int low, high;
+
+    __asm__ __volatile__( "rdtsc" : "=a" (low), "=d" (high) );
+    return ((ULONGLONG)high << 32) | low;
+}
+
+/* exact (tsc * tsc_mult) >> tsc_shift without 128-bit arithmetic */
+static inline ULONGLONG tsc_to_ticks( ULONGLONG tsc )
+{
+    ULONGLONG low = (tsc & 0xffffffff) * tsc_mult;
+    ULONGLONG high = (tsc >> 32) * tsc_mult + (low >> 32);
+    return high >> (tsc_shift - 32);
+}
+
+/***********************************************************************
+ *       init_tsc_counter
+ *
+ * Switch the monotonic counter to the TSC. This is only done when the CPU
+ * reports an invariant TSC with a known frequency and the kernel itself
+ * uses it as clock source, so that it is synchronized across CPUs. The
+ * frequency from CPUID is nominal, so it is checked against the monotonic
+ * clock first, and the clock is kept if they disagree.
+ */
+void init_tsc_counter( ULONGLONG frequency )
+{
+#ifdef __linux__
+    char buffer[16];
+    FILE *f;
+#endif
+    ULONGLONG start_tsc, start_clock, tsc, clock;
+
+    if (frequency <= 20000000) return;
+
+#ifdef __linux__
+    if (!(f = fopen( "/sys/devices/system/clocksource/clocksource0/current_clocksource", "r" ))) return;
+    if (!fgets( buffer, sizeof(buffer), f )) buffer[0] = 0;
+    fclose( f );
+    if (strcmp( buffer, "tsc\n" )) return;
+#else
+    return;
+#endif
+
+    /* measure the TSC rate over 250us, which is precise enough to catch a wrong crystal frequency */
+    start_clock = monotonic_clock();
+    start_tsc = rdtsc();
+    do
+    {
+        clock = monotonic_clock();
+        tsc = rdtsc();
+    } while (clock - start_clock < TICKSPERSEC / 4000);
+
+    tsc = (tsc - start_tsc) * TICKSPERSEC / (clock - start_clock);
+    if (tsc < frequency - frequency / 1000 || tsc > frequency + frequency / 1000)
+    {
+        WARN( "TSC runs at %s Hz instead of %s Hz, not using it\n",
+              wine_dbgstr_longlong(tsc), wine_dbgstr_longlong(frequency) );
+        return;
+    }
+
+    /* keep tsc_mult below 2^32 so that tsc_to_ticks can't overflow */
+    for (tsc_shift = 40; tsc_shift > 32; tsc_shift--)
+        if (((ULONGLONG)TICKSPERSEC << tsc_shift) / frequency <= 0xffffffff) break;
+    tsc_mult = ((ULONGLONG)TICKSPERSEC << tsc_shift) / frequency;
+    tsc_offset = monotonic_clock() - tsc_to_ticks( rdtsc() );
+    use_tsc = TRUE;
+    TRACE( "using TSC at %s Hz\n", wine_dbgstr_longlong(frequency) );
+}
+
+#else
+
+void init_tsc_counter( ULONGLONG frequency )
+{
+}
+
+#endif
+
+/* return a monotonic time counter, in Win32 ticks */
+static inline ULONGLONG monotonic_counter(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+    if (use_tsc) return tsc_to_ticks( rdtsc() ) + tsc_offset;
+#endif
+    return monotonic_clock();
+}
+
+/* KSYSTEM_TIME values are written High2Time first and High1Time last,
+ * so that readers can detect a torn value by comparing both high parts */
+static inline void set_shared_time( volatile KSYSTEM_TIME *time, ULONGLONG value )
+{
+    time->High2Time = value >> 32;
+    time->LowPart   = value;
+    time->High1Time = value >> 32;
+}
+
+/***********************************************************************
+ *           init_shared_time
+ *
+ * Initialize the times in user_shared_data. The page is private to each
+ * process, so nothing keeps them current afterwards; the time functions
+ * query the clocks directly instead.
+ */
+void init_shared_time(void)
+{
+    ULONGLONG counter = monotonic_counter();
+    struct timeval now;
+
+    gettimeofday( &now, 0 );
+    set_shared_time( &user_shared_data->SystemTime,
+                     now.tv_sec * (ULONGLONG)TICKSPERSEC + TICKS_1601_TO_1970 + now.tv_usec * 10 );
+    set_shared_time( &user_shared_data->InterruptTime, counter );
+    set_shared_time( &user_shared_data->u.TickCount, counter / TICKSPERMSEC );
+    user_shared_data->TickCountLowDeprecated = counter / TICKSPERMSEC;
+}
+
 /******************************************************************************
  *       RtlTimeToTimeFields [NTDLL.@]
  *
@@ -283,6 +408,9 @@ static LONG TIME_GetBias(void)
         last_bias = tzi.Bias;
         last_bias += is_dst ? tzi.DaylightBias : tzi.StandardBias;
         last_bias *= SECSPERMIN;
+        /* only written here, under TIME_tz_section, and once per second at most */
+        if (user_shared_data)
+            set_shared_time( &user_shared_data->TimeZoneBias, (LONGLONG)last_bias * TICKSPERSEC );
     }
 
     ret = last_bias;
@@ -153,6 +153,7 @@ static void *preload_reserve_start;
 static void *preload_reserve_end;
 static int use_locks;
 static int force_exec_prot;  /* whether to force PROT_EXEC on all PROT_READ mmaps */
+static SIZE_T large_page_size;  /* transparent huge page size, 0 if not supported */
 
 
 /***********************************************************************
@@ -232,16 +233,15 @@ static void VIRTUAL_DumpView( struct file_view *view )
 #ifdef WINE_VM_DEBUG
 static void VIRTUAL_Dump(void)
 {
-    sigset_t sigset;
     struct file_view *view;
 
     TRACE( "Dump of all virtual memory views:\n" );
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    server_enter_uninterrupted_section( &csVirtual );
     LIST_FOR_EACH_ENTRY( view, &views_list, struct file_view, entry )
     {
         VIRTUAL_DumpView( view );
     }
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    server_leave_uninterrupted_section( &csVirtual );
 }
 #endif
 
@@ -1128,7 +1128,6 @@ static NTSTATUS map_image( HANDLE hmapping, int fd, char *base, SIZE_T total_siz
     NTSTATUS status = STATUS_CONFLICTING_ADDRESSES;
     int i;
     off_t pos;
-    sigset_t sigset;
     struct stat st;
     struct file_view *view = NULL;
     char *ptr, *header_end, *header_start;
@@ -1136,7 +1135,7 @@ static NTSTATUS map_image( HANDLE hmapping, int fd, char *base, SIZE_T total_siz
 
     /* zero-map the whole range */
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    server_enter_uninterrupted_section( &csVirtual );
 
     if (base >= (char *)address_space_start)  /* make sure the DOS area remains free */
         status = map_view( &view, base, total_size, mask, FALSE,
@@ -1372,7 +1371,7 @@ static NTSTATUS map_image( HANDLE hmapping, int fd, char *base, SIZE_T total_siz
  done:
     view->mapping = dup_mapping;
     view->map_protect = map_vprot;
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    server_leave_uninterrupted_section( &csVirtual );
 
     *addr_ptr = ptr;
 #ifdef VALGRIND_LOAD_PDB_DEBUGINFO
@@ -1383,7 +1382,7 @@ static NTSTATUS map_image( HANDLE hmapping, int fd, char *base, SIZE_T total_siz
 
  error:
     if (view) delete_view( view );
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    server_leave_uninterrupted_section( &csVirtual );
     if (dup_mapping) NtClose( dup_mapping );
     return status;
 }
@@ -1402,6 +1401,53 @@ static int alloc_virtual_heap( void *base, size_t size, void *arg )
     return (*heap_base != (void *)-1);
 }
 
+/***********************************************************************
+ *           get_large_page_size
+ *
+ * Retrieve the size of the huge pages used by the host kernel.
+ */
+static SIZE_T get_large_page_size(void)
+{
+    unsigned long size = 0;
+#ifdef __linux__
+    char line[128];
+    FILE *f;
+
+    if ((f = fopen( "/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r" )))
+    {
+        if (fscanf( f, "%lu", &size ) != 1) size = 0;
+        fclose( f );
+    }
+    if (!size && (f = fopen( "/proc/meminfo", "r" )))
+    {
+        while (fgets( line, sizeof(line), f ))
+            if (sscanf( line, "Hugepagesize: %lu kB", &size ) == 1)
+            {
+                size *= 1024;
+                break;
+            }
+        fclose( f );
+    }
+#endif
+    if (size <= page_size || (size & (size - 1))) return 0;
+    return size;
+}
+
+
+/***********************************************************************
+ *           advise_large_pages
+ *
+ * Ask the kernel to back the range with huge pages where it can.
+ */
+static void advise_large_pages( void *base, size_t size )
+{
+#ifdef MADV_HUGEPAGE
+    if (madvise( base, size, MADV_HUGEPAGE ) == -1)
+        WARN( "no huge pages for %p-%p: %s\n", base, (char *)base + size, strerror(errno) );
+#endif
+}
+
+
 /***********************************************************************
  *           virtual_init
  */
@@ -1421,6 +1467,7 @@ void virtual_init(void)
     while ((1 << page_shift) != page_size) page_shift++;
     user_space_limit = working_set_limit = address_space_limit = (void *)~page_mask;
 #endif  /* page_mask */
+    large_page_size = get_large_page_size();
     if ((preload = getenv("WINEPRELOADRESERVE")))
     {
         unsigned long start, end;
@@ -1475,13 +1522,21 @@ void virtual_get_system_info( SYSTEM_BASIC_INFORMATION *info )
 }
 
 
+/***********************************************************************
+ *           virtual_get_large_page_size
+ */
+SIZE_T virtual_get_large_page_size(void)
+{
+    return large_page_size;
+}
+
+
 /***********************************************************************
  *           virtual_create_builtin_view
  */
 NTSTATUS virtual_create_builtin_view( void *module )
 {
     NTSTATUS status;
-    sigset_t sigset;
     IMAGE_NT_HEADERS *nt = RtlImageNtHeader( module );
     SIZE_T size = nt->OptionalHeader.SizeOfImage;
     IMAGE_SECTION_HEADER *sec;
@@ -1491,11 +1546,11 @@ NTSTATUS virtual_create_builtin_view( void *module )
 
     size = ROUND_SIZE( module, size );
     base = ROUND_ADDR( module, page_mask );
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    server_enter_uninterrupted_section( &csVirtual );
     status = create_view( &view, base, size, VPROT_SYSTEM | VPROT_IMAGE |
                           VPROT_COMMITTED | VPROT_READ | VPROT_WRITECOPY | VPROT_EXEC );
     if (!status) TRACE( "created %p-%p\n", base, (char *)base + size );
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    server_leave_uninterrupted_section( &csVirtual );
 
     if (status) return status;
 
@@ -1525,7 +1580,6 @@ NTSTATUS virtual_alloc_thread_stack( TEB *teb, SIZE_T reserve_size, SIZE_T commi
 {
     struct file_view *view;
     NTSTATUS status;
-    sigset_t sigset;
     SIZE_T size;
 
     if (!reserve_size || !commit_size)
@@ -1539,7 +1593,7 @@ NTSTATUS virtual_alloc_thread_stack( TEB *teb, SIZE_T reserve_size, SIZE_T commi
     if (size < 1024 * 1024) size = 1024 * 1024;  /* Xlib needs a large stack */
     size = (size + 0xffff) & ~0xffff;  /* round to 64K boundary */
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    server_enter_uninterrupted_section( &csVirtual );
 
     if ((status = map_view( &view, NULL, size, 0xffff, 0,
                             VPROT_READ | VPROT_WRITE | VPROT_COMMITTED | VPROT_VALLOC )) != STATUS_SUCCESS)
@@ -1559,7 +1613,7 @@ NTSTATUS virtual_alloc_thread_stack( TEB *teb, SIZE_T reserve_size, SIZE_T commi
     teb->Tib.StackBase     = (char *)view->base + view->size;
     teb->Tib.StackLimit    = (char *)view->base + 2 * page_size;
 done:
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    server_leave_uninterrupted_section( &csVirtual );
     return status;
 }
 
@@ -1586,9 +1640,8 @@ NTSTATUS virtual_handle_fault( LPCVOID addr, DWORD err )
 {
     struct file_view *view;
     NTSTATUS ret = STATUS_ACCESS_VIOLATION;
-    sigset_t sigset;
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    server_enter_uninterrupted_section( &csVirtual );
     if ((view = VIRTUAL_FindView( addr, 0 )))
     {
         void *page = ROUND_ADDR( addr, page_mask );
@@ -1609,7 +1662,7 @@ NTSTATUS virtual_handle_fault( LPCVOID addr, DWORD err )
             if (VIRTUAL_GetUnixProt( *vprot ) & PROT_WRITE) ret = STATUS_SUCCESS;
         }
     }
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    server_leave_uninterrupted_section( &csVirtual );
     return ret;
 }
 
@@ -1622,12 +1675,11 @@ BOOL virtual_is_valid_code_address( const void *addr, SIZE_T size )
 {
     struct file_view *view;
     BOOL ret = FALSE;
-    sigset_t sigset;
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    server_enter_uninterrupted_section( &csVirtual );
     if ((view = VIRTUAL_FindView( addr, size )))
         ret = !(view->protect & VPROT_SYSTEM);  /* system views are not visible to the app */
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    server_leave_uninterrupted_section( &csVirtual );
     return ret;
 }
 
@@ -1740,9 +1792,8 @@ BOOL virtual_check_buffer_for_write( void *ptr, SIZE_T size )
 void VIRTUAL_SetForceExec( BOOL enable )
 {
     struct file_view *view;
-    sigset_t sigset;
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    server_enter_uninterrupted_section( &csVirtual );
     if (!force_exec_prot != !enable)  /* change all existing views */
     {
         force_exec_prot = enable;
@@ -1784,7 +1835,7 @@ void VIRTUAL_SetForceExec( BOOL enable )
             }
         }
     }
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    server_leave_uninterrupted_section( &csVirtual );
 }
 
 struct free_range
@@ -1818,11 +1869,10 @@ static int free_reserved_memory( void *base, size_t size, void *arg )
 void virtual_release_address_space(void)
 {
     struct free_range range;
-    sigset_t sigset;
 
     if (is_win64) return;
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    server_enter_uninterrupted_section( &csVirtual );
 
     range.base  = (char *)0x82000000;
     range.limit = user_space_limit;
@@ -1840,7 +1890,7 @@ void virtual_release_address_space(void)
 #endif
     }
 
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    server_leave_uninterrupted_section( &csVirtual );
 }
 
 
@@ -1874,7 +1924,6 @@ NTSTATUS WINAPI NtAllocateVirtualMemory( HANDLE process, PVOID *ret, ULONG zero_
     SIZE_T mask = get_mask( zero_bits );
     NTSTATUS status = STATUS_SUCCESS;
     struct file_view *view;
-    sigset_t sigset;
 
     TRACE("%p %p %08lx %x %08x\n", process, *ret, size, type, protect );
 
@@ -1924,14 +1973,14 @@ NTSTATUS WINAPI NtAllocateVirtualMemory( HANDLE process, PVOID *ret, ULONG zero_
         /* address 1 is magic to mean DOS area */
         if (!base && *ret == (void *)1 && size == 0x110000)
         {
-            server_enter_uninterrupted_section( &csVirtual, &sigset );
+            server_enter_uninterrupted_section( &csVirtual );
             status = allocate_dos_memory( &view, vprot );
             if (status == STATUS_SUCCESS)
             {
                 *ret = view->base;
                 *size_ptr = view->size;
             }
-            server_leave_uninterrupted_section( &csVirtual, &sigset );
+            server_leave_uninterrupted_section( &csVirtual );
             return status;
         }
 
@@ -1950,21 +1999,33 @@ NTSTATUS WINAPI NtAllocateVirtualMemory( HANDLE process, PVOID *ret, ULONG zero_
     /* Compute the alloc type flags */
 
     if (!(type & (MEM_COMMIT | MEM_RESERVE | MEM_RESET)) ||
-        (type & ~(MEM_COMMIT | MEM_RESERVE | MEM_TOP_DOWN | MEM_WRITE_WATCH | MEM_RESET)))
+        (type & ~(MEM_COMMIT | MEM_RESERVE | MEM_TOP_DOWN | MEM_WRITE_WATCH | MEM_RESET | MEM_LARGE_PAGES)))
     {
         WARN("called with wrong alloc type flags (%08x) !\n", type);
         return STATUS_INVALID_PARAMETER;
     }
 
+    /* large pages must be reserved and committed at once, in whole large pages */
+
+    if (type & MEM_LARGE_PAGES)
+    {
+        if (!large_page_size) return STATUS_NOT_SUPPORTED;
+        if ((type & (MEM_COMMIT | MEM_RESERVE)) != (MEM_COMMIT | MEM_RESERVE) ||
+            (size & (large_page_size - 1)) || ((UINT_PTR)base & (large_page_size - 1)))
+            return STATUS_INVALID_PARAMETER;
+        mask |= large_page_size - 1;
+    }
+
     /* Reserve the memory */
 
-    if (use_locks) server_enter_uninterrupted_section( &csVirtual, &sigset );
+    if (use_locks) server_enter_uninterrupted_section( &csVirtual );
 
     if ((type & MEM_RESERVE) || !base)
     {
         if (type & MEM_WRITE_WATCH) vprot |= VPROT_WRITEWATCH;
         status = map_view( &view, base, size, mask, type & MEM_TOP_DOWN, vprot );
         if (status == STATUS_SUCCESS) base = view->base;
+        if (status == STATUS_SUCCESS && (type & MEM_LARGE_PAGES)) advise_large_pages( base, size );
     }
     else if (type & MEM_RESET)
     {
@@ -1989,7 +2050,7 @@ NTSTATUS WINAPI NtAllocateVirtualMemory( HANDLE process, PVOID *ret, ULONG zero_
         }
     }
 
-    if (use_locks) server_leave_uninterrupted_section( &csVirtual, &sigset );
+    if (use_locks) server_leave_uninterrupted_section( &csVirtual );
 
     if (status == STATUS_SUCCESS)
     {
@@ -2008,7 +2069,6 @@ NTSTATUS WINAPI NtFreeVirtualMemory( HANDLE process, PVOID *addr_ptr, SIZE_T *si
 {
     struct file_view *view;
     char *base;
-    sigset_t sigset;
     NTSTATUS status = STATUS_SUCCESS;
     LPVOID addr = *addr_ptr;
     SIZE_T size = *size_ptr;
@@ -2045,7 +2105,7 @@ NTSTATUS WINAPI NtFreeVirtualMemory( HANDLE process, PVOID *addr_ptr, SIZE_T *si
     /* avoid freeing the DOS area when a broken app passes a NULL pointer */
     if (!base) return STATUS_INVALID_PARAMETER;
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    server_enter_uninterrupted_section( &csVirtual );
 
     if (!(view = VIRTUAL_FindView( base, size )) || !(view->protect & VPROT_VALLOC))
     {
@@ -2078,7 +2138,7 @@ NTSTATUS WINAPI NtFreeVirtualMemory( HANDLE process, PVOID *addr_ptr, SIZE_T *si
         status = STATUS_INVALID_PARAMETER;
     }
 
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    server_leave_uninterrupted_section( &csVirtual );
     return status;
 }
 
@@ -2119,7 +2179,6 @@ NTSTATUS WINAPI NtProtectVirtualMemory( HANDLE process, PVOID *addr_ptr, SIZE_T
                                         ULONG new_prot, ULONG *old_prot )
 {
     struct file_view *view;
-    sigset_t sigset;
     NTSTATUS status = STATUS_SUCCESS;
     char *base;
     BYTE vprot;
@@ -2157,7 +2216,7 @@ NTSTATUS WINAPI NtProtectVirtualMemory( HANDLE process, PVOID *addr_ptr, SIZE_T
     size = ROUND_SIZE( addr, size );
     base = ROUND_ADDR( addr, page_mask );
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    server_enter_uninterrupted_section( &csVirtual );
 
     if ((view = VIRTUAL_FindView( base, size )))
     {
@@ -2184,7 +2243,7 @@ NTSTATUS WINAPI NtProtectVirtualMemory( HANDLE process, PVOID *addr_ptr, SIZE_T
     }
     else status = STATUS_INVALID_PARAMETER;
 
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    server_leave_uninterrupted_section( &csVirtual );
 
     if (status == STATUS_SUCCESS)
     {
@@ -2249,7 +2308,6 @@ NTSTATUS WINAPI NtQueryVirtualMemory( HANDLE process, LPCVOID addr,
     struct list *ptr;
     SIZE_T size = 0;
     MEMORY_BASIC_INFORMATION *info = buffer;
-    sigset_t sigset;
 
     if (info_class != MemoryBasicInformation)
     {
@@ -2301,7 +2359,7 @@ NTSTATUS WINAPI NtQueryVirtualMemory( HANDLE process, LPCVOID addr,
 
     /* Find the view containing the address */
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    server_enter_uninterrupted_section( &csVirtual );
     ptr = list_head( &views_list );
     for (;;)
     {
@@ -2374,7 +2432,7 @@ NTSTATUS WINAPI NtQueryVirtualMemory( HANDLE process, LPCVOID addr,
             if ((view->prot[size >> page_shift] ^ vprot) & ~VPROT_WRITEWATCH) break;
         info->RegionSize = size - (base - alloc_base);
     }
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    server_leave_uninterrupted_section( &csVirtual );
 
     if (res_len) *res_len = sizeof(*info);
     return STATUS_SUCCESS;
@@ -2487,6 +2545,7 @@ NTSTATUS WINAPI NtCreateSection( HANDLE *handle, ACCESS_MASK access, const OBJEC
     if (!(sec_flags & SEC_RESERVE)) vprot |= VPROT_COMMITTED;
     if (sec_flags & SEC_NOCACHE) vprot |= VPROT_NOCACHE;
     if (sec_flags & SEC_IMAGE) vprot |= VPROT_IMAGE;
+    if ((sec_flags & SEC_LARGE_PAGES) && !file) vprot |= VPROT_LARGE_PAGES;
 
     /* Create the server object */
 
@@ -2554,7 +2613,6 @@ NTSTATUS WINAPI NtMapViewOfSection( HANDLE handle, HANDLE process, PVOID *addr_p
     DWORD header_size;
     HANDLE dup_mapping, shared_file;
     LARGE_INTEGER offset;
-    sigset_t sigset;
 
     offset.QuadPart = offset_ptr ? offset_ptr->QuadPart : 0;
 
@@ -2681,14 +2739,15 @@ NTSTATUS WINAPI NtMapViewOfSection( HANDLE handle, HANDLE process, PVOID *addr_p
 
     /* Reserve a properly aligned area */
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    server_enter_uninterrupted_section( &csVirtual );
 
     get_vprot_flags( protect, &vprot, map_vprot & VPROT_IMAGE );
     vprot |= (map_vprot & VPROT_COMMITTED);
+    if ((map_vprot & VPROT_LARGE_PAGES) && large_page_size) mask |= large_page_size - 1;
     res = map_view( &view, *addr_ptr, size, mask, FALSE, vprot );
     if (res)
     {
-        server_leave_uninterrupted_section( &csVirtual, &sigset );
+        server_leave_uninterrupted_section( &csVirtual );
         goto done;
     }
 
@@ -2705,6 +2764,7 @@ NTSTATUS WINAPI NtMapViewOfSection( HANDLE handle, HANDLE process, PVOID *addr_p
         view->mapping = dup_mapping;
         view->map_protect = map_vprot;
         dup_mapping = 0;  /* don't close it */
+        if ((map_vprot & VPROT_LARGE_PAGES) && large_page_size) advise_large_pages( view->base, size );
     }
     else
     {
@@ -2713,7 +2773,7 @@ NTSTATUS WINAPI NtMapViewOfSection( HANDLE handle, HANDLE process, PVOID *addr_p
         delete_view( view );
     }
 
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    server_leave_uninterrupted_section( &csVirtual );
 
 done:
     if (dup_mapping) NtClose( dup_mapping );
@@ -2730,7 +2790,6 @@ NTSTATUS WINAPI NtUnmapViewOfSection( HANDLE process, PVOID addr )
 {
     struct file_view *view;
     NTSTATUS status = STATUS_NOT_MAPPED_VIEW;
-    sigset_t sigset;
     void *base = ROUND_ADDR( addr, page_mask );
 
     if (process != NtCurrentProcess())
@@ -2747,13 +2806,13 @@ NTSTATUS WINAPI NtUnmapViewOfSection( HANDLE process, PVOID addr )
         return status;
     }
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    server_enter_uninterrupted_section( &csVirtual );
     if ((view = VIRTUAL_FindView( base, 0 )) && (base == view->base) && !(view->protect & VPROT_VALLOC))
     {
         delete_view( view );
         status = STATUS_SUCCESS;
     }
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    server_leave_uninterrupted_section( &csVirtual );
     return status;
 }
 
@@ -2767,7 +2826,6 @@ NTSTATUS WINAPI NtFlushVirtualMemory( HANDLE process, LPCVOID *addr_ptr,
 {
     struct file_view *view;
     NTSTATUS status = STATUS_SUCCESS;
-    sigset_t sigset;
     void *addr = ROUND_ADDR( *addr_ptr, page_mask );
 
     if (process != NtCurrentProcess())
@@ -2791,7 +2849,7 @@ NTSTATUS WINAPI NtFlushVirtualMemory( HANDLE process, LPCVOID *addr_ptr,
         return result.virtual_flush.status;
     }
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    server_enter_uninterrupted_section( &csVirtual );
     if (!(view = VIRTUAL_FindView( addr, *size_ptr ))) status = STATUS_INVALID_PARAMETER;
     else
     {
@@ -2799,7 +2857,7 @@ NTSTATUS WINAPI NtFlushVirtualMemory( HANDLE process, LPCVOID *addr_ptr,
         *addr_ptr = addr;
         if (msync( addr, *size_ptr, MS_SYNC )) status = STATUS_NOT_MAPPED_DATA;
     }
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    server_leave_uninterrupted_section( &csVirtual );
     return status;
 }
 
@@ -2813,7 +2871,6 @@ NTSTATUS WINAPI NtGetWriteWatch( HANDLE process, ULONG flags, PVOID base, SIZE_T
 {
     struct file_view *view;
     NTSTATUS status = STATUS_SUCCESS;
-    sigset_t sigset;
 
     size = ROUND_SIZE( base, size );
     base = ROUND_ADDR( base, page_mask );
@@ -2827,7 +2884,7 @@ NTSTATUS WINAPI NtGetWriteWatch( HANDLE process, ULONG flags, PVOID base, SIZE_T
     TRACE( "%p %x %p-%p %p %lu\n", process, flags, base, (char *)base + size,
            addresses, *count );
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    server_enter_uninterrupted_section( &csVirtual );
 
     if ((view = VIRTUAL_FindView( base, size )) && (view->protect & VPROT_WRITEWATCH))
     {
@@ -2847,7 +2904,7 @@ NTSTATUS WINAPI NtGetWriteWatch( HANDLE process, ULONG flags, PVOID base, SIZE_T
     }
     else status = STATUS_INVALID_PARAMETER;
 
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    server_leave_uninterrupted_section( &csVirtual );
     return status;
 }
 
@@ -2860,7 +2917,6 @@ NTSTATUS WINAPI NtResetWriteWatch( HANDLE process, PVOID base, SIZE_T size )
 {
     struct file_view *view;
     NTSTATUS status = STATUS_SUCCESS;
-    sigset_t sigset;
 
     size = ROUND_SIZE( base, size );
     base = ROUND_ADDR( base, page_mask );
@@ -2869,14 +2925,14 @@ NTSTATUS WINAPI NtResetWriteWatch( HANDLE process, PVOID base, SIZE_T size )
 
     if (!size) return STATUS_INVALID_PARAMETER;
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    server_enter_uninterrupted_section( &csVirtual );
 
     if ((view = VIRTUAL_FindView( base, size )) && (view->protect & VPROT_WRITEWATCH))
         reset_write_watches( view, base, size );
     else
         status = STATUS_INVALID_PARAMETER;
 
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    server_leave_uninterrupted_section( &csVirtual );
     return status;
 }
 
@@ -2950,11 +3006,10 @@ NTSTATUS WINAPI NtAreMappedFilesTheSame(PVOID addr1, PVOID addr2)
     struct file_view *view1, *view2;
     struct stat st1, st2;
     NTSTATUS status;
-    sigset_t sigset;
 
     TRACE("%p %p\n", addr1, addr2);
 
-    server_enter_uninterrupted_section( &csVirtual, &sigset );
+    server_enter_uninterrupted_section( &csVirtual );
 
     view1 = VIRTUAL_FindView( addr1, 0 );
     view2 = VIRTUAL_FindView( addr2, 0 );
@@ -2973,6 +3028,6 @@ NTSTATUS WINAPI NtAreMappedFilesTheSame(PVOID addr1, PVOID addr2)
     else
         status = STATUS_NOT_SAME_DEVICE;
 
-    server_leave_uninterrupted_section( &csVirtual, &sigset );
+    server_leave_uninterrupted_section( &csVirtual );
     return status;
 }
@@ -1556,6 +1556,8 @@ DWORD get_pixmap_image( Pixmap pixmap, int width, int height, const XVisualInfo
 }
 
 
+#define MAX_DAMAGE_RECTS 8
+
 struct x11drv_window_surface
 {
     struct window_surface header;
@@ -1563,6 +1565,8 @@ struct x11drv_window_surface
     GC                    gc;
     XImage               *image;
     RECT                  bounds;
+    RECT                  damage[MAX_DAMAGE_RECTS];  /* areas that need to be flushed */
+    int                   damage_count;
     BOOL                  byteswap;
     BOOL                  is_argb;
     COLORREF              color_key;
@@ -1580,6 +1584,50 @@ static struct x11drv_window_surface *get_x11_surface( struct window_surface *sur
     return (struct x11drv_window_surface *)surface;
 }
 
+static inline int get_rect_area( const RECT *rect )
+{
+    return (rect->right - rect->left) * (rect->bottom - rect->top);
+}
+
+/***********************************************************************
+ *           add_surface_damage
+ *
+ * Move the current bounds to the list of damaged rectangles. Rectangles are
+ * merged when this doesn't add much area, or when the list is full.
+ */
+static void add_surface_damage( struct x11drv_window_surface *surface )
+{
+    RECT rect = surface->bounds, merged;
+    int i, best, best_growth, growth;
+
+    reset_bounds( &surface->bounds );
+    if (rect.left >= rect.right || rect.top >= rect.bottom) return;
+
+    for (;;)
+    {
+        best = -1;
+        best_growth = INT_MAX;
+        for (i = 0; i < surface->damage_count; i++)
+        {
+            UnionRect( &merged, &surface->damage[i], &rect );
+            growth = get_rect_area( &merged ) - get_rect_area( &surface->damage[i] ) - get_rect_area( &rect );
+            if (growth < best_growth)
+            {
+                best = i;
+                best_growth = growth;
+            }
+        }
+        /* merge if there is little waste, this also takes care of overlapping rects */
+        if (best == -1 || (best_growth > get_rect_area( &rect ) / 4 &&
+                           surface->damage_count < MAX_DAMAGE_RECTS))
+            break;
+
+        UnionRect( &rect, &surface->damage[best], &rect );
+        surface->damage[best] = surface->damage[--surface->damage_count];
+    }
+    surface->damage[surface->damage_count++] = rect;
+}
+
 static inline UINT get_color_component( UINT color, UINT mask )
 {
     int shift;
@@ -1827,6 +1875,8 @@ static void x11drv_surface_unlock( struct window_surface *window_surface )
 {
     struct x11drv_window_surface *surface = get_x11_surface( window_surface );
 
+    /* the bounds are updated while the surface is locked, keep each update separate */
+    add_surface_damage( surface );
     LeaveCriticalSection( &surface->crit );
 }
 
@@ -1890,21 +1940,24 @@ static void x11drv_surface_flush( struct window_surface *window_surface )
     struct x11drv_window_surface *surface = get_x11_surface( window_surface );
     unsigned char *src = surface->bits;
     unsigned char *dst = (unsigned char *)surface->image->data;
-    struct bitblt_coords coords;
+    int i, width, height;
+    RECT rect;
 
     window_surface->funcs->lock( window_surface );
-    coords.x = 0;
-    coords.y = 0;
-    coords.width  = surface->header.rect.right - surface->header.rect.left;
-    coords.height = surface->header.rect.bottom - surface->header.rect.top;
-    SetRect( &coords.visrect, 0, 0, coords.width, coords.height );
-    if (IntersectRect( &coords.visrect, &coords.visrect, &surface->bounds ))
+    add_surface_damage( surface );
+    width  = surface->header.rect.right - surface->header.rect.left;
+    height = surface->header.rect.bottom - surface->header.rect.top;
+
+    if (surface->damage_count && (surface->is_argb || surface->color_key != CLR_INVALID))
+        update_surface_region( surface );
+
+    for (i = 0; i < surface->damage_count; i++)
     {
-        TRACE( "flushing %p %dx%d bounds %s bits %p\n",
-               surface, coords.width, coords.height,
-               wine_dbgstr_rect( &surface->bounds ), surface->bits );
+        SetRect( &rect, 0, 0, width, height );
+        if (!IntersectRect( &rect, &rect, &surface->damage[i] )) continue;
 
-        if (surface->is_argb || surface->color_key != CLR_INVALID) update_surface_region( surface );
+        TRACE( "flushing %p %dx%d rect %s bits %p\n",
+               surface, width, height, wine_dbgstr_rect( &rect ), surface->bits );
 
         if (src != dst)
         {
@@ -1914,31 +1967,27 @@ static void x11drv_surface_flush( struct window_surface *window_surface )
             if (surface->image->bits_per_pixel == 4 || surface->image->bits_per_pixel == 8)
                 mapping = X11DRV_PALETTE_PaletteToXPixel;
 
-            src += coords.visrect.top * width_bytes;
-            dst += coords.visrect.top * width_bytes;
-            copy_image_byteswap( &surface->info, src, dst, width_bytes, width_bytes,
-                                 coords.visrect.bottom - coords.visrect.top,
-                                 surface->byteswap, mapping, ~0u );
+            copy_image_byteswap( &surface->info, src + rect.top * width_bytes,
+                                 dst + rect.top * width_bytes, width_bytes, width_bytes,
+                                 rect.bottom - rect.top, surface->byteswap, mapping, ~0u );
         }
 
 #ifdef HAVE_LIBXXSHM
         if (surface->shminfo.shmid != -1)
             XShmPutImage( gdi_display, surface->window, surface->gc, surface->image,
-                          coords.visrect.left, coords.visrect.top,
-                          surface->header.rect.left + coords.visrect.left,
-                          surface->header.rect.top + coords.visrect.top,
-                          coords.visrect.right - coords.visrect.left,
-                          coords.visrect.bottom - coords.visrect.top, False );
+                          rect.left, rect.top,
+                          surface->header.rect.left + rect.left,
+                          surface->header.rect.top + rect.top,
+                          rect.right - rect.left, rect.bottom - rect.top, False );
         else
 #endif
         XPutImage( gdi_display, surface->window, surface->gc, surface->image,
-                   coords.visrect.left, coords.visrect.top,
-                   surface->header.rect.left + coords.visrect.left,
-                   surface->header.rect.top + coords.visrect.top,
-                   coords.visrect.right - coords.visrect.left,
-                   coords.visrect.bottom - coords.visrect.top );
+                   rect.left, rect.top,
+                   surface->header.rect.left + rect.left,
+                   surface->header.rect.top + rect.top,
+                   rect.right - rect.left, rect.bottom - rect.top );
     }
-    reset_bounds( &surface->bounds );
+    surface->damage_count = 0;
     window_surface->funcs->unlock( window_surface );
 }
 
@@ -127,6 +127,9 @@
 #ifdef HAVE_SYS_TIME_H
 # include <sys/time.h>
 #endif
+#ifdef HAVE_SYS_SENDFILE_H
+# include <sys/sendfile.h>
+#endif
 
 #define NONAMELESSUNION
 #define NONAMELESSSTRUCT
@@ -321,6 +324,25 @@ typedef struct ws2_accept_async
     struct ws2_async    *read;
 } ws2_accept_async;
 
+typedef struct ws2_transmit_async
+{
+    SOCKET                    socket;
+    LPOVERLAPPED              user_overlapped;
+    ULONG_PTR                 cvalue;
+    DWORD                     flags;
+    DWORD                     chunk_size;  /* maximum bytes per send, 0 for no limit */
+    ULONGLONG                 sent;        /* total number of bytes sent */
+    DWORD                     current;     /* index of the element being sent */
+    ULONGLONG                 offset;      /* bytes of the current element already consumed */
+    BOOL                      file_done;   /* end of file reached for the current element */
+    BOOL                      no_sendfile; /* sendfile() isn't usable for the current file */
+    char                     *buffer;      /* bounce buffer used without sendfile() */
+    DWORD                     buf_pos;
+    DWORD                     buf_len;
+    DWORD                     count;
+    TRANSMIT_PACKETS_ELEMENT  elements[1];
+} ws2_transmit_async;
+
 /****************************************************************/
 
 /* ----------------------------------- internal data */
@@ -350,6 +372,8 @@ struct per_thread_data
     int he_len;
     int se_len;
     int pe_len;
+    struct pollfd *fd_cache;        /* pollfd array reused by select() and WSAPoll() */
+    unsigned int fd_cache_size;
 };
 
 /* internal: routing description information */
@@ -828,6 +852,25 @@ static NTSTATUS _is_blocking(SOCKET s, BOOL *ret)
     return status;
 }
 
+/* re-enable an event and retrieve the blocking state with a single server call */
+static NTSTATUS _reenable_event(SOCKET s, unsigned int event, BOOL *is_blocking)
+{
+    NTSTATUS status;
+    SERVER_START_REQ( enable_socket_event )
+    {
+        req->handle = wine_server_obj_handle( SOCKET2HANDLE(s) );
+        req->mask   = event;
+        req->sstate = 0;
+        req->cstate = 0;
+        status = wine_server_call( req );
+        *is_blocking = (reply->state & FD_WINE_NONBLOCKING) == 0;
+    }
+    SERVER_END_REQ;
+    /* enabling events needs write attributes access, which a duplicated handle may lack */
+    if (status == STATUS_ACCESS_DENIED) status = _is_blocking( s, is_blocking );
+    return status;
+}
+
 static unsigned int _get_sock_mask(SOCKET s)
 {
     unsigned int ret;
@@ -889,9 +932,11 @@ static void free_per_thread_data(void)
     HeapFree( GetProcessHeap(), 0, ptb->he_buffer );
     HeapFree( GetProcessHeap(), 0, ptb->se_buffer );
     HeapFree( GetProcessHeap(), 0, ptb->pe_buffer );
+    HeapFree( GetProcessHeap(), 0, ptb->fd_cache );
     ptb->he_buffer = NULL;
     ptb->se_buffer = NULL;
     ptb->pe_buffer = NULL;
+    ptb->fd_cache = NULL;
 
     HeapFree( GetProcessHeap(), 0, ptb );
     NtCurrentTeb()->WinSockData = NULL;
@@ -2125,6 +2170,355 @@ static void WINAPI WS2_GetAcceptExSockaddrs(PVOID buffer, DWORD data_size, DWORD
     *remote_addr = (struct WS_sockaddr *)(cbuf + sizeof(int));
 }
 
+#define TRANSMIT_BUFFER_SIZE  65536
+#define TRANSMIT_MAX_CHUNK    0x7ffff000
+
+/***********************************************************************
+ *              transmit_element                (INTERNAL)
+ *
+ * Send part of the current TransmitPackets element.
+ * Returns 1 if some progress was made, 0 once the element is done, -1 on error.
+ */
+static int transmit_element( struct ws2_transmit_async *wsa, int sock_fd )
+{
+    TRANSMIT_PACKETS_ELEMENT *elem = &wsa->elements[wsa->current];
+    ULONGLONG size, max_size = TRANSMIT_MAX_CHUNK;
+    ssize_t ret;
+    int file_fd;
+    off_t pos;
+
+    if (wsa->chunk_size) max_size = min( max_size, wsa->chunk_size );
+
+    if (elem->dwElFlags & TP_ELEMENT_MEMORY)
+    {
+        if (wsa->offset >= elem->cLength) return 0;
+        size = min( elem->cLength - wsa->offset, max_size );
+        ret = send( sock_fd, (char *)elem->u.pBuffer + wsa->offset, size, 0 );
+        if (ret == -1) return -1;
+        wsa->offset += ret;
+        wsa->sent += ret;
+        return 1;
+    }
+
+    if (wsa->buf_pos < wsa->buf_len)
+    {
+        size = min( wsa->buf_len - wsa->buf_pos, max_size );
+        ret = send( sock_fd, wsa->buffer + wsa->buf_pos, size, 0 );
+        if (ret == -1) return -1;
+        wsa->buf_pos += ret;
+        wsa->sent += ret;
+        return 1;
+    }
+
+    if (wsa->file_done) return 0;
+    size = max_size;
+    if (elem->cLength) size = min( size, elem->cLength - wsa->offset );
+    if (!size) return 0;
+
+    if (set_error( wine_server_handle_to_fd( elem->u.s.hFile, FILE_READ_DATA, &file_fd, NULL ) ))
+    {
+        errno = EBADF;
+        return -1;
+    }
+    pos = elem->u.s.nFileOffset.QuadPart + wsa->offset;
+
+#ifdef HAVE_SYS_SENDFILE_H
+    if (!wsa->no_sendfile)
+    {
+        if (elem->u.s.nFileOffset.QuadPart == -1)
+            ret = sendfile( sock_fd, file_fd, NULL, size );
+        else
+            ret = sendfile( sock_fd, file_fd, &pos, size );
+        if (ret >= 0 || (errno != EINVAL && errno != ENOSYS))
+        {
+            wine_server_release_fd( elem->u.s.hFile, file_fd );
+            if (ret == -1) return -1;
+            if (!ret) wsa->file_done = TRUE;
+            wsa->offset += ret;
+            wsa->sent += ret;
+            return 1;
+        }
+        TRACE( "sendfile not supported, using read/send\n" );
+        wsa->no_sendfile = TRUE;
+    }
+#endif
+
+    if (!wsa->buffer && !(wsa->buffer = HeapAlloc( GetProcessHeap(), 0, TRANSMIT_BUFFER_SIZE )))
+    {
+        wine_server_release_fd( elem->u.s.hFile, file_fd );
+        errno = ENOMEM;
+        return -1;
+    }
+    size = min( size, TRANSMIT_BUFFER_SIZE );
+    if (elem->u.s.nFileOffset.QuadPart == -1)
+        ret = read( file_fd, wsa->buffer, size );
+    else
+        ret = pread( file_fd, wsa->buffer, size, pos );
+    wine_server_release_fd( elem->u.s.hFile, file_fd );
+    if (ret == -1) return -1;
+    if (!ret) wsa->file_done = TRUE;
+    wsa->offset += ret;
+    wsa->buf_pos = 0;
+    wsa->buf_len = ret;
+    return 1;
+}
+
+/***********************************************************************
+ *              transmit_data                   (INTERNAL)
+ *
+ * Send the remaining TransmitPackets elements. If wait is not set,
+ * return STATUS_PENDING instead of blocking on the socket, otherwise
+ * wait for at most the socket send timeout.
+ */
+static NTSTATUS transmit_data( struct ws2_transmit_async *wsa, BOOL wait )
+{
+    NTSTATUS status = STATUS_SUCCESS;
+    DWORD timeout_start = GetTickCount();
+    struct pollfd pfd;
+    int fd, ret, timeout;
+
+    if ((fd = get_sock_fd( wsa->socket, FILE_WRITE_DATA, NULL )) == -1)
+        return STATUS_INVALID_HANDLE;
+
+    while (wsa->current < wsa->count)
+    {
+        if ((ret = transmit_element( wsa, fd )) > 0) continue;
+        if (!ret)
+        {
+            wsa->current++;
+            wsa->offset = 0;
+            wsa->file_done = FALSE;
+            wsa->no_sendfile = FALSE;
+            continue;
+        }
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN)
+        {
+            status = wsaErrStatus();
+            break;
+        }
+        if (!wait)
+        {
+            status = STATUS_PENDING;
+            break;
+        }
+        if ((timeout = GET_SNDTIMEO(fd)) != -1)
+        {
+            timeout -= GetTickCount() - timeout_start;
+            if (timeout < 0) timeout = 0;
+        }
+        pfd.fd = fd;
+        pfd.events = POLLOUT;
+        if (!timeout || !poll( &pfd, 1, timeout ))
+        {
+            status = STATUS_IO_TIMEOUT;
+            break;
+        }
+    }
+
+    if (status == STATUS_SUCCESS && (wsa->flags & (TF_DISCONNECT | TF_REUSE_SOCKET)))
+    {
+        if (wsa->flags & TF_REUSE_SOCKET) FIXME( "TF_REUSE_SOCKET not supported\n" );
+        shutdown( fd, SHUT_WR );
+    }
+    release_sock_fd( wsa->socket, fd );
+    return status;
+}
+
+static void transmit_complete( struct ws2_transmit_async *wsa, NTSTATUS status )
+{
+    IO_STATUS_BLOCK *iosb = (IO_STATUS_BLOCK *)wsa->user_overlapped;
+
+    iosb->u.Status = status;
+    iosb->Information = wsa->sent;
+    if (wsa->user_overlapped->hEvent) SetEvent( wsa->user_overlapped->hEvent );
+    /* completion packets only have room for a 32-bit count */
+    if (wsa->cvalue) WS_AddCompletion( wsa->socket, wsa->cvalue, status, min( wsa->sent, MAXDWORD ) );
+}
+
+static void free_transmit_async( struct ws2_transmit_async *wsa )
+{
+    HeapFree( GetProcessHeap(), 0, wsa->buffer );
+    HeapFree( GetProcessHeap(), 0, wsa );
+}
+
+static void WINAPI ws2_transmit_apc( void *arg, IO_STATUS_BLOCK *iosb, ULONG reserved )
+{
+    free_transmit_async( arg );
+}
+
+/***********************************************************************
+ *              WS2_async_transmit              (INTERNAL)
+ *
+ * Handler for overlapped TransmitFile/TransmitPackets operations.
+ */
+static NTSTATUS WS2_async_transmit( void *user, IO_STATUS_BLOCK *iosb, NTSTATUS status, void **apc )
+{
+    struct ws2_transmit_async *wsa = user;
+
+    if (status == STATUS_ALERTED) status = transmit_data( wsa, FALSE );
+    iosb->Information = wsa->sent;
+    if (status != STATUS_PENDING)
+    {
+        iosb->u.Status = status;
+        *apc = ws2_transmit_apc;
+    }
+    return status;
+}
+
+/***********************************************************************
+ *              transmit_packets                (INTERNAL)
+ *
+ * Common part of TransmitFile and TransmitPackets. Data is sent directly
+ * when the socket accepts it; overlapped requests that would block wait
+ * for the socket through a server async, like overlapped sends.
+ */
+static BOOL transmit_packets( SOCKET s, const TRANSMIT_PACKETS_ELEMENT *elements, DWORD count,
+                              DWORD chunk_size, LPOVERLAPPED overlapped, DWORD flags )
+{
+    struct ws2_transmit_async *wsa;
+    NTSTATUS status;
+    DWORD i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (!(elements[i].dwElFlags & (TP_ELEMENT_MEMORY | TP_ELEMENT_FILE)) ||
+            (elements[i].dwElFlags & (TP_ELEMENT_MEMORY | TP_ELEMENT_FILE)) == (TP_ELEMENT_MEMORY | TP_ELEMENT_FILE))
+        {
+            SetLastError( WSAEINVAL );
+            return FALSE;
+        }
+    }
+
+    if (!(wsa = HeapAlloc( GetProcessHeap(), 0,
+                           FIELD_OFFSET( struct ws2_transmit_async, elements[max( count, 1 )] ))))
+    {
+        SetLastError( WSAEFAULT );
+        return FALSE;
+    }
+    wsa->socket          = s;
+    wsa->user_overlapped = overlapped;
+    wsa->cvalue          = (overlapped && ((ULONG_PTR)overlapped->hEvent & 1) == 0) ? (ULONG_PTR)overlapped : 0;
+    wsa->flags           = flags;
+    wsa->chunk_size      = chunk_size;
+    wsa->sent            = 0;
+    wsa->current         = 0;
+    wsa->offset          = 0;
+    wsa->file_done       = FALSE;
+    wsa->no_sendfile     = FALSE;
+    wsa->buffer          = NULL;
+    wsa->buf_pos         = 0;
+    wsa->buf_len         = 0;
+    wsa->count           = count;
+    memcpy( wsa->elements, elements, count * sizeof(*elements) );
+
+    status = transmit_data( wsa, !overlapped );
+    if (overlapped)
+    {
+        if (status == STATUS_PENDING)
+        {
+            IO_STATUS_BLOCK *iosb = (IO_STATUS_BLOCK *)overlapped;
+
+            iosb->u.Status = STATUS_PENDING;
+            iosb->Information = wsa->sent;
+
+            SERVER_START_REQ( register_async )
+            {
+                req->type           = ASYNC_TYPE_WRITE;
+                req->async.handle   = wine_server_obj_handle( SOCKET2HANDLE(s) );
+                req->async.callback = wine_server_client_ptr( WS2_async_transmit );
+                req->async.iosb     = wine_server_client_ptr( iosb );
+                req->async.arg      = wine_server_client_ptr( wsa );
+                req->async.event    = wine_server_obj_handle( overlapped->hEvent );
+                req->async.cvalue   = wsa->cvalue;
+                status = wine_server_call( req );
+            }
+            SERVER_END_REQ;
+
+            /* the server delivers FD_WRITE to the async once it is queued */
+            _enable_event( SOCKET2HANDLE(s), FD_WRITE, 0, 0 );
+
+            if (status == STATUS_PENDING)
+            {
+                SetLastError( WSA_IO_PENDING );
+                return FALSE;
+            }
+            iosb->u.Status = status;
+            free_transmit_async( wsa );
+            SetLastError( NtStatusToWSAError(status) );
+            return FALSE;
+        }
+        transmit_complete( wsa, status );
+    }
+    free_transmit_async( wsa );
+
+    if (status)
+    {
+        SetLastError( NtStatusToWSAError(status) );
+        return FALSE;
+    }
+    SetLastError( ERROR_SUCCESS );
+    return TRUE;
+}
+
+/***********************************************************************
+ *     TransmitFile
+ */
+static BOOL WINAPI WS2_TransmitFile( SOCKET s, HANDLE file, DWORD total_len, DWORD chunk_len,
+                                     LPOVERLAPPED overlapped, LPTRANSMIT_FILE_BUFFERS buffers,
+                                     DWORD flags )
+{
+    TRANSMIT_PACKETS_ELEMENT elements[3];
+    DWORD count = 0;
+
+    TRACE("(%lx, %p, %d, %d, %p, %p, %x)\n", s, file, total_len, chunk_len, overlapped, buffers, flags);
+
+    if (buffers && buffers->HeadLength)
+    {
+        elements[count].dwElFlags = TP_ELEMENT_MEMORY;
+        elements[count].cLength   = buffers->HeadLength;
+        elements[count].u.pBuffer = buffers->Head;
+        count++;
+    }
+    if (file)
+    {
+        elements[count].dwElFlags = TP_ELEMENT_FILE;
+        elements[count].cLength   = total_len;
+        elements[count].u.s.hFile = file;
+        if (overlapped)
+        {
+            elements[count].u.s.nFileOffset.u.LowPart  = overlapped->u.s.Offset;
+            elements[count].u.s.nFileOffset.u.HighPart = overlapped->u.s.OffsetHigh;
+        }
+        else elements[count].u.s.nFileOffset.QuadPart = -1;  /* current file position */
+        count++;
+    }
+    if (buffers && buffers->TailLength)
+    {
+        elements[count].dwElFlags = TP_ELEMENT_MEMORY;
+        elements[count].cLength   = buffers->TailLength;
+        elements[count].u.pBuffer = buffers->Tail;
+        count++;
+    }
+    return transmit_packets( s, elements, count, chunk_len, overlapped, flags );
+}
+
+/***********************************************************************
+ *     TransmitPackets
+ */
+static BOOL WINAPI WS2_TransmitPackets( SOCKET s, LPTRANSMIT_PACKETS_ELEMENT elements, DWORD count,
+                                        DWORD send_size, LPOVERLAPPED overlapped, DWORD flags )
+{
+    TRACE("(%lx, %p, %d, %d, %p, %x)\n", s, elements, count, send_size, overlapped, flags);
+
+    if (count && !elements)
+    {
+        SetLastError( WSAEINVAL );
+        return FALSE;
+    }
+    return transmit_packets( s, elements, count, send_size, overlapped, flags );
+}
+
 /***********************************************************************
  *     WSARecvMsg
  *
@@ -3527,11 +3921,13 @@ INT WINAPI WSAIoctl(SOCKET s, DWORD code, LPVOID in_buff, DWORD in_size, LPVOID
         }
         else if ( IsEqualGUID(&transmitfile_guid, in_buff) )
         {
-            FIXME("SIO_GET_EXTENSION_FUNCTION_POINTER: unimplemented TransmitFile\n");
+            *(LPFN_TRANSMITFILE *)out_buff = WS2_TransmitFile;
+            break;
         }
         else if ( IsEqualGUID(&transmitpackets_guid, in_buff) )
         {
-            FIXME("SIO_GET_EXTENSION_FUNCTION_POINTER: unimplemented TransmitPackets\n");
+            *(LPFN_TRANSMITPACKETS *)out_buff = WS2_TransmitPackets;
+            break;
         }
         else if ( IsEqualGUID(&wsarecvmsg_guid, in_buff) )
         {
@@ -3762,7 +4158,29 @@ int WINAPI WS_recvfrom(SOCKET s, char *buf, INT len, int flags,
         return n;
 }
 
-/* allocate a poll array for the corresponding fd sets */
+/* get a poll array of at least count entries from the per-thread cache */
+static struct pollfd *get_poll_buffer( unsigned int count )
+{
+    struct per_thread_data *ptb = get_per_thread_data();
+    struct pollfd *fds;
+
+    if (count <= ptb->fd_cache_size) return ptb->fd_cache;
+
+    if (ptb->fd_cache)
+        fds = HeapReAlloc( GetProcessHeap(), 0, ptb->fd_cache, count * sizeof(fds[0]) );
+    else
+        fds = HeapAlloc( GetProcessHeap(), 0, count * sizeof(fds[0]) );
+    if (!fds)
+    {
+        SetLastError( ERROR_NOT_ENOUGH_MEMORY );
+        return NULL;
+    }
+    ptb->fd_cache = fds;
+    ptb->fd_cache_size = count;
+    return fds;
+}
+
+/* fill a poll array for the corresponding fd sets */
 static struct pollfd *fd_sets_to_poll( const WS_fd_set *readfds, const WS_fd_set *writefds,
                                        const WS_fd_set *exceptfds, int *count_ptr )
 {
@@ -3778,11 +4196,7 @@ static struct pollfd *fd_sets_to_poll( const WS_fd_set *readfds, const WS_fd_set
         SetLastError(WSAEINVAL);
         return NULL;
     }
-    if (!(fds = HeapAlloc( GetProcessHeap(), 0, count * sizeof(fds[0]))))
-    {
-        SetLastError( ERROR_NOT_ENOUGH_MEMORY );
-        return NULL;
-    }
+    if (!(fds = get_poll_buffer( count ))) return NULL;
     if (readfds)
         for (i = 0; i < readfds->fd_count; i++, j++)
         {
@@ -3821,7 +4235,6 @@ failed:
     if (exceptfds)
         for (i = 0; i < exceptfds->fd_count && j < count; i++, j++)
             release_sock_fd( exceptfds->fd_array[i], fds[j].fd );
-    HeapFree( GetProcessHeap(), 0, fds );
     return NULL;
 }
 
@@ -3886,6 +4299,26 @@ static int get_poll_results( WS_fd_set *readfds, WS_fd_set *writefds, WS_fd_set
 }
 
 
+/* poll the unix fds, restarting on signals until the timeout (in ms) expires */
+static int do_poll( struct pollfd *pollfds, int count, int timeout )
+{
+    DWORD start = GetTickCount();
+    int ret, torig = timeout;
+
+    while ((ret = poll( pollfds, count, timeout )) < 0)
+    {
+        if (errno != EINTR) break;
+        if (torig < 0) continue;
+        timeout = torig - (GetTickCount() - start);
+        if (timeout <= 0)
+        {
+            ret = 0;
+            break;
+        }
+    }
+    return ret;
+}
+
 /***********************************************************************
  *		select			(WS2_32.18)
  */
@@ -3894,8 +4327,6 @@ int WINAPI WS_select(int nfds, WS_fd_set *ws_readfds,
                      const struct WS_timeval* ws_timeout)
 {
     struct pollfd *pollfds;
-    struct timeval tv1, tv2;
-    int torig = 0;
     int count, ret, timeout = -1;
 
     TRACE("read %p, write %p, excp %p timeout %p\n",
@@ -3905,36 +4336,74 @@ int WINAPI WS_select(int nfds, WS_fd_set *ws_readfds,
         return SOCKET_ERROR;
 
     if (ws_timeout)
+        timeout = (ws_timeout->tv_sec * 1000) + (ws_timeout->tv_usec + 999) / 1000;
+
+    ret = do_poll( pollfds, count, timeout );
+    release_poll_fds( ws_readfds, ws_writefds, ws_exceptfds, pollfds );
+
+    if (ret == -1) SetLastError(wsaErrno());
+    else ret = get_poll_results( ws_readfds, ws_writefds, ws_exceptfds, pollfds );
+    return ret;
+}
+
+/***********************************************************************
+ *		WSAPoll			(WS2_32.@)
+ */
+int WINAPI WSAPoll(WSAPOLLFD *wfds, ULONG count, int timeout)
+{
+    struct pollfd *pollfds;
+    unsigned int i;
+    DWORD err = GetLastError();
+    int ret;
+
+    TRACE("fds %p, count %u, timeout %d\n", wfds, count, timeout);
+
+    if (!wfds || !count)
     {
-        torig = (ws_timeout->tv_sec * 1000) + (ws_timeout->tv_usec + 999) / 1000;
-        timeout = torig;
-        gettimeofday( &tv1, 0 );
+        SetLastError(WSAEINVAL);
+        return SOCKET_ERROR;
     }
+    if (!(pollfds = get_poll_buffer( count ))) return SOCKET_ERROR;
 
-    while ((ret = poll( pollfds, count, timeout )) < 0)
+    for (i = 0; i < count; i++)
     {
-        if (errno == EINTR)
+        pollfds[i].events = 0;
+        pollfds[i].revents = 0;
+        if (wfds[i].events & WS_POLLRDNORM) pollfds[i].events |= POLLIN;
+        if (wfds[i].events & WS_POLLRDBAND) pollfds[i].events |= POLLPRI;
+        if (wfds[i].events & WS_POLLWRNORM) pollfds[i].events |= POLLOUT;
+        wfds[i].revents = 0;
+        if ((INT_PTR)wfds[i].fd < 0)  /* negative entries are ignored */
+            pollfds[i].fd = -1;
+        else if ((pollfds[i].fd = get_sock_fd( wfds[i].fd, 0, NULL )) == -1)
         {
-            if (!ws_timeout) continue;
-            gettimeofday( &tv2, 0 );
+            wfds[i].revents = WS_POLLNVAL;
+            timeout = 0;  /* don't wait, we already have something to report */
+        }
+    }
 
-            tv2.tv_sec  -= tv1.tv_sec;
-            tv2.tv_usec -= tv1.tv_usec;
-            if (tv2.tv_usec < 0)
-            {
-                tv2.tv_usec += 1000000;
-                tv2.tv_sec  -= 1;
-            }
+    ret = do_poll( pollfds, count, timeout );
 
-            timeout = torig - (tv2.tv_sec * 1000) - (tv2.tv_usec + 999) / 1000;
-            if (timeout <= 0) break;
-        } else break;
+    for (i = 0; i < count; i++)
+    {
+        if (pollfds[i].fd == -1) continue;
+        release_sock_fd( wfds[i].fd, pollfds[i].fd );
+        if (pollfds[i].revents & POLLIN)   wfds[i].revents |= WS_POLLRDNORM;
+        if (pollfds[i].revents & POLLPRI)  wfds[i].revents |= WS_POLLRDBAND;
+        if (pollfds[i].revents & POLLOUT)  wfds[i].revents |= WS_POLLWRNORM;
+        if (pollfds[i].revents & POLLHUP)  wfds[i].revents |= WS_POLLHUP;
+        if (pollfds[i].revents & POLLERR)  wfds[i].revents |= WS_POLLERR;
+        if (pollfds[i].revents & POLLNVAL) wfds[i].revents |= WS_POLLNVAL;
+        wfds[i].revents &= wfds[i].events | WS_POLLHUP | WS_POLLERR | WS_POLLNVAL;
+    }
+    if (ret == -1)
+    {
+        SetLastError(wsaErrno());
+        return SOCKET_ERROR;
     }
-    release_poll_fds( ws_readfds, ws_writefds, ws_exceptfds, pollfds );
 
-    if (ret == -1) SetLastError(wsaErrno());
-    else ret = get_poll_results( ws_readfds, ws_writefds, ws_exceptfds, pollfds );
-    HeapFree( GetProcessHeap(), 0, pollfds );
+    for (i = ret = 0; i < count; i++) if (wfds[i].revents) ret++;
+    SetLastError( err );  /* invalid sockets are reported in revents only */
     return ret;
 }
 
@@ -4103,7 +4572,14 @@ static int WS2_sendto( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
         return 0;
     }
 
-    if ((err = _is_blocking( s, &is_blocking )))
+    if (n == totalLength)
+    {
+        /* everything went out, no need to ask the server whether we would block */
+        bytes_sent = n;
+        goto done;
+    }
+
+    if ((err = _reenable_event( s, FD_WRITE, &is_blocking )))
     {
         err = NtStatusToWSAError( err );
         goto error;
@@ -4150,8 +4626,6 @@ static int WS2_sendto( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
     }
     else  /* non-blocking */
     {
-        if (n < totalLength)
-            _enable_event(SOCKET2HANDLE(s), FD_WRITE, 0, 0);
         if (n == -1)
         {
             err = WSAEWOULDBLOCK;
@@ -4160,6 +4634,7 @@ static int WS2_sendto( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
         bytes_sent = n;
     }
 
+done:
     TRACE(" -> %i bytes\n", bytes_sent);
 
     if (lpNumberOfBytesSent) *lpNumberOfBytesSent = bytes_sent;
@@ -6008,7 +6483,7 @@ static int WS2_recv_base( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
 
         if (n != -1) break;
 
-        if ((err = _is_blocking( s, &is_blocking )))
+        if ((err = _reenable_event( s, FD_READ, &is_blocking )))
         {
             err = NtStatusToWSAError( err );
             goto error;
@@ -6038,7 +6513,6 @@ static int WS2_recv_base( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
         }
         else
         {
-            _enable_event(SOCKET2HANDLE(s), FD_READ, 0, 0);
             err = WSAEWOULDBLOCK;
             goto error;
         }
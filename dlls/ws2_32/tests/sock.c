@@ -64,6 +64,7 @@ static int   (WINAPI *pgetaddrinfo)(LPCSTR,LPCSTR,const struct addrinfo *,struct
 static void  (WINAPI *pFreeAddrInfoW)(PADDRINFOW);
 static int   (WINAPI *pGetAddrInfoW)(LPCWSTR,LPCWSTR,const ADDRINFOW *,PADDRINFOW *);
 static PCSTR (WINAPI *pInetNtop)(INT,LPVOID,LPSTR,ULONG);
+static int   (WINAPI *pWSAPoll)(WSAPOLLFD *,ULONG,int);
 
 /**************** Structs and typedefs ***************/
 
@@ -1009,6 +1010,7 @@ static void Init (void)
     pFreeAddrInfoW = (void *)GetProcAddress(hws2_32, "FreeAddrInfoW");
     pGetAddrInfoW = (void *)GetProcAddress(hws2_32, "GetAddrInfoW");
     pInetNtop = (void *)GetProcAddress(hws2_32, "inet_ntop");
+    pWSAPoll = (void *)GetProcAddress(hws2_32, "WSAPoll");
 
     ok ( WSAStartup ( ver, &data ) == 0, "WSAStartup failed\n" );
     tls = TlsAlloc();
@@ -2723,6 +2725,201 @@ static int CALLBACK AlwaysDeferConditionFunc(LPWSABUF lpCallerId, LPWSABUF lpCal
     return CF_DEFER;
 }
 
+static void test_WSAPoll(void)
+{
+    SOCKET src, dst;
+    WSAPOLLFD fds[3];
+    char buffer;
+    int ret;
+
+    if (!pWSAPoll)
+    {
+        win_skip("WSAPoll is not available\n");
+        return;
+    }
+
+    SetLastError(0xdeadbeef);
+    ret = pWSAPoll(NULL, 0, 0);
+    ok(ret == SOCKET_ERROR, "expected SOCKET_ERROR, got %d\n", ret);
+    ok(WSAGetLastError() == WSAEINVAL, "expected WSAEINVAL, got %d\n", WSAGetLastError());
+
+    ok(!tcp_socketpair(&src, &dst), "creating socket pair failed\n");
+
+    fds[0].fd = src;
+    fds[0].events = POLLRDNORM | POLLWRNORM;
+    fds[0].revents = 0xdead;
+    fds[1].fd = dst;
+    fds[1].events = POLLRDNORM;
+    fds[1].revents = 0xdead;
+    ret = pWSAPoll(fds, 2, 0);
+    ok(ret == 1, "expected 1, got %d\n", ret);
+    ok(fds[0].revents == POLLWRNORM, "got %x\n", fds[0].revents);
+    ok(fds[1].revents == 0, "got %x\n", fds[1].revents);
+
+    ret = send(src, "x", 1, 0);
+    ok(ret == 1, "send failed %d\n", WSAGetLastError());
+    ret = pWSAPoll(fds + 1, 1, 1000);
+    ok(ret == 1, "expected 1, got %d\n", ret);
+    ok(fds[1].revents == POLLRDNORM, "got %x\n", fds[1].revents);
+    ret = recv(dst, &buffer, 1, 0);
+    ok(ret == 1, "recv failed %d\n", WSAGetLastError());
+
+    ret = pWSAPoll(fds + 1, 1, 50);
+    ok(ret == 0, "expected 0, got %d\n", ret);
+    ok(fds[1].revents == 0, "got %x\n", fds[1].revents);
+
+    /* entries with a negative descriptor are ignored */
+    fds[0].fd = INVALID_SOCKET;
+    fds[0].events = POLLRDNORM | POLLWRNORM;
+    fds[0].revents = 0xdead;
+    ret = pWSAPoll(fds, 2, 50);
+    ok(ret == 0, "expected 0, got %d\n", ret);
+    ok(fds[0].revents == 0, "got %x\n", fds[0].revents);
+    ok(fds[1].revents == 0, "got %x\n", fds[1].revents);
+
+    fds[1].events = POLLRDNORM | POLLWRNORM;
+    ret = pWSAPoll(fds, 2, 1000);
+    ok(ret == 1, "expected 1, got %d\n", ret);
+    ok(fds[0].revents == 0, "got %x\n", fds[0].revents);
+    ok(fds[1].revents == POLLWRNORM, "got %x\n", fds[1].revents);
+    fds[1].events = POLLRDNORM;
+
+    closesocket(src);
+    fds[2].fd = src;
+    fds[2].events = POLLRDNORM;
+    ret = pWSAPoll(fds + 1, 2, 1000);
+    ok(ret == 2, "expected 2, got %d\n", ret);
+    ok(fds[1].revents & (POLLHUP | POLLRDNORM), "got %x\n", fds[1].revents);
+    ok(fds[2].revents == POLLNVAL, "got %x\n", fds[2].revents);
+
+    closesocket(dst);
+}
+
+static void recv_all(SOCKET s, char *buffer, int size)
+{
+    int ret, total = 0;
+
+    set_blocking(s, TRUE);
+    while (total < size)
+    {
+        ret = recv(s, buffer + total, size - total, 0);
+        ok(ret > 0, "recv failed, ret %d, error %d\n", ret, WSAGetLastError());
+        if (ret <= 0) break;
+        total += ret;
+    }
+}
+
+static void test_TransmitFile(void)
+{
+    GUID transmitFileGuid = WSAID_TRANSMITFILE;
+    LPFN_TRANSMITFILE pTransmitFile = NULL;
+    char temp_path[MAX_PATH], temp_file[MAX_PATH];
+    char data[4096], buffer[sizeof(data) + 8];
+    TRANSMIT_FILE_BUFFERS buffers;
+    OVERLAPPED ov;
+    SOCKET src, dst;
+    HANDLE file;
+    char *big;
+    DWORD size, i;
+    BOOL bret;
+    int iret;
+
+    ok(!tcp_socketpair(&src, &dst), "creating socket pair failed\n");
+    iret = WSAIoctl(src, SIO_GET_EXTENSION_FUNCTION_POINTER, &transmitFileGuid, sizeof(transmitFileGuid),
+                    &pTransmitFile, sizeof(pTransmitFile), &size, NULL, NULL);
+    if (iret)
+    {
+        win_skip("TransmitFile not supported\n");
+        closesocket(src);
+        closesocket(dst);
+        return;
+    }
+
+    for (i = 0; i < sizeof(data); i++) data[i] = i * 13;
+    GetTempPathA(MAX_PATH, temp_path);
+    GetTempFileNameA(temp_path, "tf", 0, temp_file);
+    file = CreateFileA(temp_file, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                       FILE_FLAG_DELETE_ON_CLOSE, NULL);
+    ok(file != INVALID_HANDLE_VALUE, "CreateFile failed, error %d\n", GetLastError());
+    bret = WriteFile(file, data, sizeof(data), &size, NULL);
+    ok(bret && size == sizeof(data), "WriteFile failed, error %d\n", GetLastError());
+    SetFilePointer(file, 0, NULL, FILE_BEGIN);
+
+    /* whole file with head and tail buffers */
+    buffers.Head = (void *)"head";
+    buffers.HeadLength = 4;
+    buffers.Tail = (void *)"tail";
+    buffers.TailLength = 4;
+    bret = pTransmitFile(src, file, 0, 0, NULL, &buffers, 0);
+    ok(bret, "TransmitFile failed, error %d\n", WSAGetLastError());
+    memset(buffer, 0, sizeof(buffer));
+    recv_all(dst, buffer, sizeof(buffer));
+    ok(!memcmp(buffer, "head", 4), "wrong head data\n");
+    ok(!memcmp(buffer + 4, data, sizeof(data)), "wrong file data\n");
+    ok(!memcmp(buffer + 4 + sizeof(data), "tail", 4), "wrong tail data\n");
+
+    /* part of the file at the overlapped offset */
+    memset(&ov, 0, sizeof(ov));
+    ov.Offset = 1000;
+    ov.hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+    bret = pTransmitFile(src, file, 100, 0, &ov, NULL, 0);
+    ok(bret || WSAGetLastError() == ERROR_IO_PENDING, "TransmitFile failed, error %d\n", WSAGetLastError());
+    bret = GetOverlappedResult((HANDLE)src, &ov, &size, TRUE);
+    ok(bret, "GetOverlappedResult failed, error %d\n", GetLastError());
+    ok(size == 100, "expected 100 bytes, got %d\n", size);
+    memset(buffer, 0, sizeof(buffer));
+    recv_all(dst, buffer, 100);
+    ok(!memcmp(buffer, data + 1000, 100), "wrong file data\n");
+
+    /* data sent in small chunks */
+    ov.Offset = 100;
+    ResetEvent(ov.hEvent);
+    bret = pTransmitFile(src, file, 1000, 64, &ov, NULL, 0);
+    ok(bret || WSAGetLastError() == ERROR_IO_PENDING, "TransmitFile failed, error %d\n", WSAGetLastError());
+    bret = GetOverlappedResult((HANDLE)src, &ov, &size, TRUE);
+    ok(bret, "GetOverlappedResult failed, error %d\n", GetLastError());
+    ok(size == 1000, "expected 1000 bytes, got %d\n", size);
+    memset(buffer, 0, sizeof(buffer));
+    recv_all(dst, buffer, 1000);
+    ok(!memcmp(buffer, data + 100, 1000), "wrong file data\n");
+
+    /* a transfer larger than the socket buffers completes once the peer reads it */
+    size = 4096;
+    setsockopt(src, SOL_SOCKET, SO_SNDBUF, (char *)&size, sizeof(size));
+    setsockopt(dst, SOL_SOCKET, SO_RCVBUF, (char *)&size, sizeof(size));
+    SetFilePointer(file, 0, NULL, FILE_END);
+    for (i = 0; i < 255; i++) WriteFile(file, data, sizeof(data), &size, NULL);
+    big = HeapAlloc(GetProcessHeap(), 0, 256 * sizeof(data));
+
+    ov.Offset = 0;
+    bret = pTransmitFile(src, file, 0, 0, &ov, NULL, 0);
+    ok(!bret, "TransmitFile succeeded\n");
+    ok(WSAGetLastError() == ERROR_IO_PENDING, "TransmitFile failed, error %d\n", WSAGetLastError());
+    ok(WaitForSingleObject(ov.hEvent, 100) == WAIT_TIMEOUT, "TransmitFile completed too early\n");
+    recv_all(dst, big, 256 * sizeof(data));
+    bret = GetOverlappedResult((HANDLE)src, &ov, &size, TRUE);
+    ok(bret, "GetOverlappedResult failed, error %d\n", GetLastError());
+    ok(size == 256 * sizeof(data), "expected %u bytes, got %d\n", (DWORD)(256 * sizeof(data)), size);
+    ok(!memcmp(big + 255 * sizeof(data), data, sizeof(data)), "wrong file data\n");
+
+    /* a pending transfer can be cancelled */
+    bret = pTransmitFile(src, file, 0, 0, &ov, NULL, 0);
+    ok(!bret, "TransmitFile succeeded\n");
+    ok(WSAGetLastError() == ERROR_IO_PENDING, "TransmitFile failed, error %d\n", WSAGetLastError());
+    bret = CancelIo((HANDLE)src);
+    ok(bret, "CancelIo failed, error %d\n", GetLastError());
+    ok(WaitForSingleObject(ov.hEvent, 1000) == WAIT_OBJECT_0, "TransmitFile wasn't cancelled\n");
+    bret = GetOverlappedResult((HANDLE)src, &ov, &size, FALSE);
+    ok(!bret, "GetOverlappedResult succeeded\n");
+    ok(GetLastError() == ERROR_OPERATION_ABORTED, "got error %d\n", GetLastError());
+
+    HeapFree(GetProcessHeap(), 0, big);
+    CloseHandle(ov.hEvent);
+    CloseHandle(file);
+    closesocket(src);
+    closesocket(dst);
+}
+
 static void test_accept(void)
 {
     int ret;
@@ -6339,6 +6536,8 @@ START_TEST( sock )
     test_errors();
     test_listen();
     test_select();
+    test_WSAPoll();
+    test_TransmitFile();
     test_accept();
     test_getpeername();
     test_getsockname();
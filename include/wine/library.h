@@ -46,6 +46,8 @@ extern const char *wine_get_version(void);
 extern const char *wine_get_build_id(void);
 extern void wine_init_argv0_path( const char *argv0 );
 extern void wine_exec_wine_binary( const char *name, char **argv, const char *env_var );
+extern char **wine_get_wine_binary_paths( const char *name, const char *env_var );
+extern void wine_free_wine_binary_paths( char **paths );
 
 /* dll loading */
 
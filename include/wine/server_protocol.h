@@ -271,6 +271,15 @@ typedef struct
 } async_data_t;
 
 
+typedef struct
+{
+    apc_param_t     ckey;
+    apc_param_t     cvalue;
+    unsigned int    information;
+    unsigned int    status;
+} completion_packet_t;
+
+
 
 struct hardware_msg_data
 {
@@ -1466,6 +1475,8 @@ struct enable_socket_event_request
 struct enable_socket_event_reply
 {
     struct reply_header __header;
+    unsigned int state;
+    char __pad_12[4];
 };
 
 struct set_socket_deferred_request
@@ -1974,6 +1985,7 @@ struct create_mapping_reply
 #define VPROT_SYSTEM     0x0200
 #define VPROT_VALLOC     0x0400
 #define VPROT_NOEXEC     0x0800
+#define VPROT_LARGE_PAGES 0x1000
 
 
 
@@ -4779,6 +4791,19 @@ struct remove_completion_reply
 
 
 
+struct remove_completions_request
+{
+    struct request_header __header;
+    obj_handle_t handle;
+};
+struct remove_completions_reply
+{
+    struct reply_header __header;
+    /* VARARG(packets,completion_packets); */
+};
+
+
+
 struct query_completion_request
 {
     struct request_header __header;
@@ -5192,6 +5217,7 @@ enum request
     REQ_open_completion,
     REQ_add_completion,
     REQ_remove_completion,
+    REQ_remove_completions,
     REQ_query_completion,
     REQ_set_completion_info,
     REQ_add_fd_completion,
@@ -5448,6 +5474,7 @@ union generic_request
     struct open_completion_request open_completion_request;
     struct add_completion_request add_completion_request;
     struct remove_completion_request remove_completion_request;
+    struct remove_completions_request remove_completions_request;
     struct query_completion_request query_completion_request;
     struct set_completion_info_request set_completion_info_request;
     struct add_fd_completion_request add_fd_completion_request;
@@ -5702,6 +5729,7 @@ union generic_reply
     struct open_completion_reply open_completion_reply;
     struct add_completion_reply add_completion_reply;
     struct remove_completion_reply remove_completion_reply;
+    struct remove_completions_reply remove_completions_reply;
     struct query_completion_reply query_completion_reply;
     struct set_completion_info_reply set_completion_info_reply;
     struct add_fd_completion_reply add_fd_completion_reply;
@@ -5715,6 +5743,6 @@ union generic_reply
     struct set_suspend_context_reply set_suspend_context_reply;
 };
 
-#define SERVER_PROTOCOL_VERSION 440
+#define SERVER_PROTOCOL_VERSION 443
 
 #endif /* __WINE_WINE_SERVER_PROTOCOL_H */
@@ -460,43 +460,52 @@ const char *wine_get_build_id(void)
     return wine_build;
 }
 
-/* exec a binary using the preloader if requested; helper for wine_exec_wine_binary */
-static void preloader_exec( char **argv, int use_preloader )
+/* add a candidate binary to the path list, along with the preloader to start it with */
+static void add_binary_path( char ***paths, int *count, int *size, char *path, int use_preloader )
 {
+    char *preloader = xstrdup( "" );
+
     if (use_preloader)
     {
-        static const char preloader[] = "wine-preloader";
+        static const char preloader32[] = "wine-preloader";
         static const char preloader64[] = "wine64-preloader";
-        char *p, *full_name;
-        char **last_arg = argv, **new_argv;
+        char *p;
 
-        if (!(p = strrchr( argv[0], '/' ))) p = argv[0];
+        if (!(p = strrchr( path, '/' ))) p = path;
         else p++;
 
-        full_name = xmalloc( p - argv[0] + sizeof(preloader64) );
-        memcpy( full_name, argv[0], p - argv[0] );
+        free( preloader );
+        preloader = xmalloc( p - path + sizeof(preloader64) );
+        memcpy( preloader, path, p - path );
         if (strendswith( p, "64" ))
-            memcpy( full_name + (p - argv[0]), preloader64, sizeof(preloader64) );
+            memcpy( preloader + (p - path), preloader64, sizeof(preloader64) );
         else
-            memcpy( full_name + (p - argv[0]), preloader, sizeof(preloader) );
-
-        /* make a copy of argv */
-        while (*last_arg) last_arg++;
-        new_argv = xmalloc( (last_arg - argv + 2) * sizeof(*argv) );
-        memcpy( new_argv + 1, argv, (last_arg - argv + 1) * sizeof(*argv) );
-        new_argv[0] = full_name;
-        execv( full_name, new_argv );
-        free( new_argv );
-        free( full_name );
+            memcpy( preloader + (p - path), preloader32, sizeof(preloader32) );
     }
-    execv( argv[0], argv );
+
+    if (*count + 3 > *size)
+    {
+        char **new_paths;
+
+        *size = *size ? *size * 2 : 16;
+        new_paths = xmalloc( *size * sizeof(*new_paths) );
+        if (*count) memcpy( new_paths, *paths, *count * sizeof(*new_paths) );
+        free( *paths );
+        *paths = new_paths;
+    }
+    (*paths)[(*count)++] = preloader;
+    (*paths)[(*count)++] = path;
+    (*paths)[*count] = NULL;
 }
 
-/* exec a wine internal binary (either the wine loader or the wine server) */
-void wine_exec_wine_binary( const char *name, char **argv, const char *env_var )
+/* return the list of binaries that wine_exec_wine_binary tries, in order; each
+ * candidate takes two entries, the preloader to start it with (an empty string
+ * if none) and the binary itself; the list must be freed with wine_free_wine_binary_paths */
+char **wine_get_wine_binary_paths( const char *name, const char *env_var )
 {
     const char *path, *pos, *ptr;
-    int use_preloader;
+    char **paths = NULL, *buffer;
+    int use_preloader, count = 0, size = 0;
 
     if (!name) name = argv0_name;  /* no name means default loader */
 
@@ -509,51 +518,70 @@ void wine_exec_wine_binary( const char *name, char **argv, const char *env_var )
     if ((ptr = strrchr( name, '/' )))
     {
         /* if we are in build dir and name contains a path, try that */
-        if (build_dir)
-        {
-            argv[0] = build_path( build_dir, name );
-            preloader_exec( argv, use_preloader );
-            free( argv[0] );
-        }
+        if (build_dir) add_binary_path( &paths, &count, &size, build_path( build_dir, name ), use_preloader );
         name = ptr + 1;  /* get rid of path */
     }
 
     /* first, bin directory from the current libdir or argv0 */
-    if (bindir)
-    {
-        argv[0] = build_path( bindir, name );
-        preloader_exec( argv, use_preloader );
-        free( argv[0] );
-    }
+    if (bindir) add_binary_path( &paths, &count, &size, build_path( bindir, name ), use_preloader );
 
     /* then specified environment variable */
-    if (env_var)
-    {
-        argv[0] = (char *)env_var;
-        preloader_exec( argv, use_preloader );
-    }
+    if (env_var) add_binary_path( &paths, &count, &size, xstrdup( env_var ), use_preloader );
 
     /* now search in the Unix path */
     if ((path = getenv( "PATH" )))
     {
-        argv[0] = xmalloc( strlen(path) + strlen(name) + 2 );
         pos = path;
         for (;;)
         {
             while (*pos == ':') pos++;
             if (!*pos) break;
             if (!(ptr = strchr( pos, ':' ))) ptr = pos + strlen(pos);
-            memcpy( argv[0], pos, ptr - pos );
-            strcpy( argv[0] + (ptr - pos), "/" );
-            strcat( argv[0] + (ptr - pos), name );
-            preloader_exec( argv, use_preloader );
+            buffer = xmalloc( ptr - pos + strlen(name) + 2 );
+            memcpy( buffer, pos, ptr - pos );
+            strcpy( buffer + (ptr - pos), "/" );
+            strcat( buffer + (ptr - pos), name );
+            add_binary_path( &paths, &count, &size, buffer, use_preloader );
             pos = ptr;
         }
-        free( argv[0] );
     }
 
     /* and finally try BINDIR */
-    argv[0] = build_path( BINDIR, name );
-    preloader_exec( argv, use_preloader );
-    free( argv[0] );
+    add_binary_path( &paths, &count, &size, build_path( BINDIR, name ), use_preloader );
+    return paths;
+}
+
+/* free a list returned by wine_get_wine_binary_paths */
+void wine_free_wine_binary_paths( char **paths )
+{
+    char **p;
+
+    for (p = paths; *p; p++) free( *p );
+    free( paths );
+}
+
+/* exec a wine internal binary (either the wine loader or the wine server) */
+void wine_exec_wine_binary( const char *name, char **argv, const char *env_var )
+{
+    char **paths = wine_get_wine_binary_paths( name, env_var );
+    char **new_argv, **last_arg = argv;
+    int i;
+
+    /* make a copy of argv with room for the preloader */
+    while (*last_arg) last_arg++;
+    new_argv = xmalloc( (last_arg - argv + 2) * sizeof(*argv) );
+    memcpy( new_argv + 2, argv + 1, (last_arg - argv) * sizeof(*argv) );
+
+    for (i = 0; paths[i]; i += 2)
+    {
+        new_argv[1] = paths[i + 1];
+        if (paths[i][0])
+        {
+            new_argv[0] = paths[i];
+            execv( new_argv[0], new_argv );
+        }
+        execv( new_argv[1], new_argv + 1 );
+    }
+    free( new_argv );
+    wine_free_wine_binary_paths( paths );
 }
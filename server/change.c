@@ -91,6 +91,7 @@ struct inotify_event {
 #define IN_DELETE        0x00000200
 #define IN_DELETE_SELF   0x00000400
 
+#define IN_Q_OVERFLOW    0x00004000
 #define IN_ISDIR         0x40000000
 
 static inline int inotify_init( void )
@@ -124,6 +125,9 @@ struct change_record {
     struct filesystem_event event;
 };
 
+/* limit on the size of the changes queued on a directory nobody reads */
+#define MAX_CHANGE_RECORDS_SIZE 0x10000
+
 struct dir
 {
     struct object  obj;      /* object header */
@@ -136,6 +140,8 @@ struct dir
     int            want_data; /* return change data */
     int            subtree;  /* do we want to watch subdirectories? */
     struct list    change_records;   /* data for the change */
+    data_size_t    records_size; /* size of the queued change records */
+    int            overflow; /* change records were dropped */
     struct list    in_entry; /* entry in the inode dirs list */
     struct inode  *inode;    /* inode of the associated directory */
 };
@@ -362,12 +368,23 @@ static int dir_set_sd( struct object *obj, const struct security_descriptor *sd,
     return 1;
 }
 
+/* size of a change record in the read_change reply */
+static inline data_size_t get_change_record_size( const struct change_record *record )
+{
+    return (offsetof(struct filesystem_event, name[record->event.len])
+            + sizeof(int)-1) / sizeof(int) * sizeof(int);
+}
+
 static struct change_record *get_first_change_record( struct dir *dir )
 {
     struct list *ptr = list_head( &dir->change_records );
+    struct change_record *record;
+
     if (!ptr) return NULL;
     list_remove( ptr );
-    return LIST_ENTRY( ptr, struct change_record, entry );
+    record = LIST_ENTRY( ptr, struct change_record, entry );
+    dir->records_size -= get_change_record_size( record );
+    return record;
 }
 
 static void dir_destroy( struct object *obj )
@@ -602,16 +619,37 @@ static int inotify_get_poll_events( struct fd *fd )
     return POLLIN;
 }
 
+/* drop all the queued changes, the client will have to rescan the directory */
+static void dir_overflow( struct dir *dir )
+{
+    struct change_record *record;
+
+    while ((record = get_first_change_record( dir ))) free( record );
+    if (dir->want_data) dir->overflow = 1;
+    fd_async_wake_up( dir->fd, ASYNC_TYPE_WAIT, STATUS_ALERTED );
+}
+
 static void inotify_do_change_notify( struct dir *dir, unsigned int action,
                                       unsigned int cookie, const char *relpath )
 {
     struct change_record *record;
+    struct list *tail;
 
     assert( dir->obj.ops == &dir_ops );
 
-    if (dir->want_data)
+    if (dir->want_data && !dir->overflow)
     {
         size_t len = strlen(relpath);
+
+        /* merge repeated modifications of the same file */
+        if (action == FILE_ACTION_MODIFIED && (tail = list_tail( &dir->change_records )))
+        {
+            record = LIST_ENTRY( tail, struct change_record, entry );
+            if (record->event.action == action && record->event.len == len &&
+                !memcmp( record->event.name, relpath, len ))
+                return;
+        }
+
         record = malloc( offsetof(struct change_record, event.name[len]) );
         if (!record)
             return;
@@ -621,7 +659,14 @@ static void inotify_do_change_notify( struct dir *dir, unsigned int action,
         memcpy( record->event.name, relpath, len );
         record->event.len = len;
 
+        if (dir->records_size + get_change_record_size( record ) > MAX_CHANGE_RECORDS_SIZE)
+        {
+            free( record );
+            dir_overflow( dir );
+            return;
+        }
         list_add_tail( &dir->change_records, &record->entry );
+        dir->records_size += get_change_record_size( record );
     }
 
     fd_async_wake_up( dir->fd, ASYNC_TYPE_WAIT, STATUS_ALERTED );
@@ -827,8 +872,9 @@ static void inotify_notify_all( struct inotify_event *ie )
 static void inotify_poll_event( struct fd *fd, int event )
 {
     int r, ofs, unix_fd;
-    char buffer[0x1000];
+    static char buffer[0x10000];
     struct inotify_event *ie;
+    struct dir *dir;
 
     unix_fd = get_unix_fd( fd );
     r = read( unix_fd, buffer, sizeof buffer );
@@ -841,11 +887,15 @@ static void inotify_poll_event( struct fd *fd, int event )
     for( ofs = 0; ofs < r - offsetof(struct inotify_event, name); )
     {
         ie = (struct inotify_event*) &buffer[ofs];
-        if (!ie->len)
-            break;
         ofs += offsetof( struct inotify_event, name[ie->len] );
         if (ofs > r) break;
-        inotify_notify_all( ie );
+        if (ie->mask & IN_Q_OVERFLOW)
+        {
+            /* the kernel dropped events, we can't tell which directories changed */
+            LIST_FOR_EACH_ENTRY( dir, &change_list, struct dir, entry )
+                dir_overflow( dir );
+        }
+        else if (ie->len) inotify_notify_all( ie );
     }
 }
 
@@ -1081,6 +1131,8 @@ struct object *create_dir_obj( struct fd *fd, unsigned int access, mode_t mode )
         return NULL;
 
     list_init( &dir->change_records );
+    dir->records_size = 0;
+    dir->overflow = 0;
     dir->filter = 0;
     dir->notified = 0;
     dir->want_data = 0;
@@ -1126,7 +1178,7 @@ DECL_HANDLER(read_directory_changes)
     }
 
     /* if there's already a change in the queue, send it */
-    if (!list_empty( &dir->change_records ))
+    if (!list_empty( &dir->change_records ) || dir->overflow)
         fd_async_wake_up( dir->fd, ASYNC_TYPE_WAIT, STATUS_ALERTED );
 
     /* setup the real notification */
@@ -1144,33 +1196,58 @@ DECL_HANDLER(read_change)
 {
     struct change_record *record, *next;
     struct dir *dir;
-    struct list events;
+    struct list events, *ptr;
     char *data, *event;
-    int size = 0;
+    data_size_t size = 0, record_size;
 
     dir = get_dir_obj( current->process, req->handle, 0 );
     if (!dir)
         return;
 
-    list_init( &events );
-    list_move_tail( &events, &dir->change_records );
-    release_object( dir );
-
-    if (list_empty( &events ))
+    if (dir->overflow)
     {
-        set_error( STATUS_NO_DATA_DETECTED );
+        dir->overflow = 0;
+        release_object( dir );
+        set_error( STATUS_NOTIFY_ENUM_DIR );
         return;
     }
 
-    LIST_FOR_EACH_ENTRY( record, &events, struct change_record, entry )
+    /* return as many changes as fit in the reply, the rest is left for the next read */
+    list_init( &events );
+    while ((ptr = list_head( &dir->change_records )))
     {
-        size += (offsetof(struct filesystem_event, name[record->event.len])
-                + sizeof(int)-1) / sizeof(int) * sizeof(int);
+        record = LIST_ENTRY( ptr, struct change_record, entry );
+        record_size = get_change_record_size( record );
+        next = NULL;
+        if (record->event.action == FILE_ACTION_RENAMED_OLD_NAME &&
+            (ptr = list_next( &dir->change_records, &record->entry )))
+        {
+            /* keep both halves of a rename together */
+            next = LIST_ENTRY( ptr, struct change_record, entry );
+            if (next->cookie == record->cookie) record_size += get_change_record_size( next );
+            else next = NULL;
+        }
+        if (size + record_size > get_reply_max_size()) break;
+        size += record_size;
+        list_add_tail( &events, &get_first_change_record( dir )->entry );
+        if (next) list_add_tail( &events, &get_first_change_record( dir )->entry );
     }
 
-    if (size > get_reply_max_size())
-        set_error( STATUS_BUFFER_TOO_SMALL );
-    else if ((data = mem_alloc( size )) != NULL)
+    if (list_empty( &events ))
+    {
+        if (list_empty( &dir->change_records )) set_error( STATUS_NO_DATA_DETECTED );
+        else
+        {
+            /* not even a single change fits, drop them */
+            while ((record = get_first_change_record( dir ))) free( record );
+            set_error( STATUS_BUFFER_TOO_SMALL );
+        }
+        release_object( dir );
+        return;
+    }
+    release_object( dir );
+
+    if ((data = mem_alloc( size )) != NULL)
     {
         event = data;
         LIST_FOR_EACH_ENTRY( record, &events, struct change_record, entry )
@@ -253,6 +253,44 @@ DECL_HANDLER(remove_completion)
     release_object( completion );
 }
 
+/* get several completions from completion port */
+DECL_HANDLER(remove_completions)
+{
+    struct completion* completion = get_completion_obj( current->process, req->handle, IO_COMPLETION_MODIFY_STATE );
+    struct list *entry;
+    struct comp_msg *msg;
+    completion_packet_t *packet;
+    data_size_t count = get_reply_max_size() / sizeof(*packet);
+
+    if (!completion) return;
+
+    if (list_empty( &completion->queue ))
+        set_error( STATUS_PENDING );
+    else if (count)
+    {
+        if (count > completion->depth) count = completion->depth;
+        if ((packet = set_reply_data_size( count * sizeof(*packet) )))
+        {
+            while (count--)
+            {
+                entry = list_head( &completion->queue );
+                list_remove( entry );
+                completion->depth--;
+                msg = LIST_ENTRY( entry, struct comp_msg, queue_entry );
+                packet->ckey = msg->ckey;
+                packet->cvalue = msg->cvalue;
+                packet->status = msg->status;
+                packet->information = msg->information;
+                packet++;
+                free( msg );
+            }
+        }
+    }
+    else set_error( STATUS_INVALID_PARAMETER );
+
+    release_object( completion );
+}
+
 /* get queue depth for completion port */
 DECL_HANDLER(query_completion)
 {
@@ -22,6 +22,7 @@
 #include "wine/port.h"
 
 #include <assert.h>
+#include <errno.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -29,6 +30,9 @@
 #ifdef HAVE_SYS_MMAN_H
 # include <sys/mman.h>
 #endif
+#ifdef HAVE_SYS_SYSCALL_H
+# include <sys/syscall.h>
+#endif
 #include <unistd.h>
 
 #include "ntstatus.h"
@@ -154,6 +158,56 @@ static int check_current_dir_for_exec(void)
     return (ret != MAP_FAILED);
 }
 
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001
+#endif
+#ifndef MFD_EXEC
+#define MFD_EXEC    0x0010
+#endif
+
+/* create an in-memory file for anonymous mappings, to keep them off the file system */
+static int create_memfd( file_pos_t size )
+{
+#if defined(__linux__) && defined(__NR_memfd_create)
+    static int memfd_supported = -1;  /* not checked yet */
+    static unsigned int memfd_flags = MFD_CLOEXEC | MFD_EXEC;
+    void *ptr;
+    int fd;
+
+    if (!memfd_supported) return -1;
+    /* kernels older than 6.3 don't know about MFD_EXEC */
+    while ((fd = syscall( __NR_memfd_create, "anonmap", memfd_flags )) == -1 && (memfd_flags & MFD_EXEC) &&
+           (errno == EINVAL || errno == EACCES))
+        memfd_flags &= ~MFD_EXEC;
+    if (fd == -1)
+    {
+        if (errno == ENOSYS) memfd_supported = 0;
+        return -1;
+    }
+    if (ftruncate( fd, size ) == -1)
+    {
+        close( fd );
+        return -1;
+    }
+    if (memfd_supported == -1)
+    {
+        /* sections may be mapped executable, which vm.memfd_noexec can forbid */
+        ptr = mmap( NULL, get_page_size(), PROT_READ | PROT_EXEC, MAP_PRIVATE, fd, 0 );
+        if (ptr == MAP_FAILED)
+        {
+            memfd_supported = 0;
+            close( fd );
+            return -1;
+        }
+        munmap( ptr, get_page_size() );
+        memfd_supported = 1;
+    }
+    return fd;
+#else
+    return -1;
+#endif
+}
+
 /* create a temp file for anonymous mappings */
 static int create_temp_file( file_pos_t size )
 {
@@ -161,6 +215,8 @@ static int create_temp_file( file_pos_t size )
     char tmpfn[] = "anonmap.XXXXXX";
     int fd;
 
+    if ((fd = create_memfd( size )) != -1) return fd;
+
     if (temp_dir_fd == -1)
     {
         temp_dir_fd = server_dir_fd;
@@ -65,6 +65,14 @@ enum pipe_state
 
 struct named_pipe;
 
+/* pending flush, waiting for the other end to read all the data */
+struct pipe_flush
+{
+    struct timeout_user *timeout;    /* timeout for the next check */
+    struct event        *event;      /* event signaled once the data has been read */
+    timeout_t            interval;   /* current check interval */
+};
+
 struct pipe_server
 {
     struct object        obj;        /* object header */
@@ -74,8 +82,7 @@ struct pipe_server
     enum pipe_state      state;      /* server state */
     struct pipe_client  *client;     /* client that this server is connected to */
     struct named_pipe   *pipe;
-    struct timeout_user *flush_poll;
-    struct event        *event;
+    struct pipe_flush    flush;      /* pending flush of the server end */
     unsigned int         options;    /* pipe options */
 };
 
@@ -84,6 +91,7 @@ struct pipe_client
     struct object        obj;        /* object header */
     struct fd           *fd;         /* pipe file descriptor */
     struct pipe_server  *server;     /* server that this client is connected to */
+    struct pipe_flush    flush;      /* pending flush of the client end */
     unsigned int         flags;      /* file flags */
 };
 
@@ -347,17 +355,21 @@ static struct fd *pipe_server_get_fd( struct object *obj )
 }
 
 
+/* wake up the threads waiting for a flush to complete */
+static void end_flush( struct pipe_flush *flush )
+{
+    if (!flush->event) return;
+    if (flush->timeout) remove_timeout_user( flush->timeout );
+    flush->timeout = NULL;
+    set_event( flush->event );
+    release_object( flush->event );
+    flush->event = NULL;
+}
+
 static void notify_empty( struct pipe_server *server )
 {
-    if (!server->flush_poll)
-        return;
-    assert( server->state == ps_connected_server );
-    assert( server->event );
-    remove_timeout_user( server->flush_poll );
-    server->flush_poll = NULL;
-    set_event( server->event );
-    release_object( server->event );
-    server->event = NULL;
+    end_flush( &server->flush );
+    if (server->client) end_flush( &server->client->flush );
 }
 
 static void do_disconnect( struct pipe_server *server )
@@ -382,11 +394,8 @@ static void pipe_server_destroy( struct object *obj)
 
     assert( obj->ops == &pipe_server_ops );
 
-    if (server->fd)
-    {
-        notify_empty( server );
-        do_disconnect( server );
-    }
+    notify_empty( server );
+    if (server->fd) do_disconnect( server );
 
     if (server->client)
     {
@@ -409,6 +418,8 @@ static void pipe_client_destroy( struct object *obj)
 
     assert( obj->ops == &pipe_client_ops );
 
+    end_flush( &client->flush );
+
     if (server)
     {
         notify_empty( server );
@@ -507,43 +518,66 @@ void create_named_pipe_device( struct directory *root, const struct unicode_str
     if (dev) make_object_static( &dev->obj );
 }
 
-static int pipe_data_remaining( struct pipe_server *server )
+/* check whether the reading end still has data waiting */
+static int pipe_data_remaining( struct fd *reader )
 {
     struct pollfd pfd;
-    int fd;
-
-    assert( server->client );
 
-    fd = get_unix_fd( server->client->fd );
-    if (fd < 0)
+    if (!reader || (pfd.fd = get_unix_fd( reader )) < 0)
         return 0;
-    pfd.fd = fd;
     pfd.events = POLLIN;
     pfd.revents = 0;
 
     if (0 > poll( &pfd, 1, 0 ))
         return 0;
- 
+
     return pfd.revents&POLLIN;
 }
 
-static void check_flushed( void *arg )
+/* there's no unix way to be alerted when a socket has been read, so we poll,
+ * starting with a short interval so that quick readers don't have to wait long */
+#define FLUSH_CHECK_FIRST (-TICKS_PER_SEC / 1000)
+#define FLUSH_CHECK_MAX   (-TICKS_PER_SEC / 10)
+
+static void schedule_flush_check( struct pipe_flush *flush, timeout_callback callback, void *arg )
 {
-    struct pipe_server *server = (struct pipe_server*) arg;
+    flush->timeout = add_timeout_user( flush->interval, callback, arg );
+    flush->interval = max( flush->interval * 2, FLUSH_CHECK_MAX );
+}
 
-    assert( server->event );
-    if (pipe_data_remaining( server ))
+static void start_flush( struct pipe_flush *flush, struct event **event,
+                         timeout_callback callback, void *arg )
+{
+    if (!flush->event)
     {
-        server->flush_poll = add_timeout_user( -TICKS_PER_SEC / 10, check_flushed, server );
+        if (!(flush->event = create_event( NULL, NULL, 0, 0, 0, NULL ))) return;
+        flush->interval = FLUSH_CHECK_FIRST;
+        schedule_flush_check( flush, callback, arg );
     }
+    /* concurrent flushes all wait for the same event */
+    *event = flush->event;
+}
+
+static void check_server_flushed( void *arg )
+{
+    struct pipe_server *server = arg;
+
+    server->flush.timeout = NULL;
+    if (server->client && pipe_data_remaining( server->client->fd ))
+        schedule_flush_check( &server->flush, check_server_flushed, server );
     else
-    {
-        /* notify_empty( server ); */
-        server->flush_poll = NULL;
-        set_event( server->event );
-        release_object( server->event );
-        server->event = NULL;
-    }
+        end_flush( &server->flush );
+}
+
+static void check_client_flushed( void *arg )
+{
+    struct pipe_client *client = arg;
+
+    client->flush.timeout = NULL;
+    if (client->server && pipe_data_remaining( client->server->fd ))
+        schedule_flush_check( &client->flush, check_client_flushed, client );
+    else
+        end_flush( &client->flush );
 }
 
 static void pipe_server_flush( struct fd *fd, struct event **event )
@@ -552,24 +586,18 @@ static void pipe_server_flush( struct fd *fd, struct event **event )
 
     if (!server || server->state != ps_connected_server) return;
 
-    /* FIXME: if multiple threads flush the same pipe,
-              maybe should create a list of processes to notify */
-    if (server->flush_poll) return;
-
-    if (pipe_data_remaining( server ))
-    {
-        /* this kind of sux -
-           there's no unix way to be alerted when a pipe becomes empty */
-        server->event = create_event( NULL, NULL, 0, 0, 0, NULL );
-        if (!server->event) return;
-        server->flush_poll = add_timeout_user( -TICKS_PER_SEC / 10, check_flushed, server );
-        *event = server->event;
-    }
+    if (pipe_data_remaining( server->client->fd ))
+        start_flush( &server->flush, event, check_server_flushed, server );
 }
 
 static void pipe_client_flush( struct fd *fd, struct event **event )
 {
-    /* FIXME: what do we have to do for this? */
+    struct pipe_client *client = get_fd_user( fd );
+
+    if (!client || !client->server || client->server->state != ps_connected_server) return;
+
+    if (pipe_data_remaining( client->server->fd ))
+        start_flush( &client->flush, event, check_client_flushed, client );
 }
 
 static inline int is_overlapped( unsigned int options )
@@ -748,7 +776,8 @@ static struct pipe_server *create_pipe_server( struct named_pipe *pipe, unsigned
     server->fd = NULL;
     server->pipe = pipe;
     server->client = NULL;
-    server->flush_poll = NULL;
+    server->flush.timeout = NULL;
+    server->flush.event = NULL;
     server->options = options;
 
     list_add_head( &pipe->servers, &server->entry );
@@ -772,6 +801,8 @@ static struct pipe_client *create_pipe_client( unsigned int flags )
 
     client->fd = NULL;
     client->server = NULL;
+    client->flush.timeout = NULL;
+    client->flush.event = NULL;
     client->flags = flags;
 
     return client;
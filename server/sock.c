@@ -1050,6 +1050,7 @@ DECL_HANDLER(enable_socket_event)
 
     sock_reselect( sock );
 
+    reply->state = sock->state;
     release_object( &sock->obj );
 }
 